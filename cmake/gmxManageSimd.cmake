@@ -283,7 +283,8 @@ elseif(GMX_SIMD_ACTIVE STREQUAL "IBM_VSX")
 
 elseif(GMX_SIMD_ACTIVE STREQUAL "SPARC64_HPC_ACE")
 
-    # Note that GMX_RELAXED_DOUBLE_PRECISION is enabled by default in the top-level CMakeLists.txt
+    # HPC-ACE only has double precision SIMD. Consider GMX_RELAXED_DOUBLE_PRECISION, which
+    # is off by default, for single-accuracy math in the non-bonded kernels.
 
     set(GMX_SIMD_${GMX_SIMD_ACTIVE} 1)
     set(SIMD_STATUS_MESSAGE "Enabling Sparc64 HPC-ACE SIMD instructions without special flags.")
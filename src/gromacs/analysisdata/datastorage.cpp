@@ -55,6 +55,7 @@
 #include "gromacs/analysisdata/paralleloptions.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/mutex.h"
 
 namespace gmx
 {
@@ -262,6 +263,13 @@ public:
      * frame (see \a frames_).
      */
     int nextIndex_;
+    /*! \brief
+     * Guards the frame bookkeeping when frames are constructed concurrently.
+     *
+     * Only the frame builders are accessed without the lock, and each of
+     * those is used only by the thread that started the frame.
+     */
+    Mutex mutex_;
 };
 
 /********************************************************************
@@ -478,16 +486,21 @@ AnalysisDataFrameBuilderPointer AnalysisDataStorageImpl::getFrameBuilder()
 
 void AnalysisDataStorageImpl::finishFrame(int index)
 {
-    const int storageIndex = computeStorageLocation(index);
-    GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
+    {
+        lock_guard<Mutex> lock(mutex_);
+        const int         storageIndex = computeStorageLocation(index);
+        GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
 
-    AnalysisDataStorageFrameData& storedFrame = *frames_[storageIndex];
-    GMX_RELEASE_ASSERT(storedFrame.isStarted(),
-                       "finishFrame() called for frame before startFrame()");
-    GMX_RELEASE_ASSERT(!storedFrame.isFinished(), "finishFrame() called twice for the same frame");
-    GMX_RELEASE_ASSERT(storedFrame.frameIndex() == index, "Inconsistent internal frame indexing");
-    builders_.push_back(storedFrame.finishFrame(isMultipoint()));
-    modules_->notifyParallelFrameFinish(storedFrame.header());
+        AnalysisDataStorageFrameData& storedFrame = *frames_[storageIndex];
+        GMX_RELEASE_ASSERT(storedFrame.isStarted(),
+                           "finishFrame() called for frame before startFrame()");
+        GMX_RELEASE_ASSERT(!storedFrame.isFinished(),
+                           "finishFrame() called twice for the same frame");
+        GMX_RELEASE_ASSERT(storedFrame.frameIndex() == index,
+                           "Inconsistent internal frame indexing");
+        builders_.push_back(storedFrame.finishFrame(isMultipoint()));
+        modules_->notifyParallelFrameFinish(storedFrame.header());
+    }
     if (pendingLimit_ == 1)
     {
         finishFrameSerial(index);
@@ -809,6 +822,7 @@ void AnalysisDataStorage::startParallelDataStorage(AbstractAnalysisData*
 AnalysisDataStorageFrame& AnalysisDataStorage::startFrame(const AnalysisDataFrameHeader& header)
 {
     GMX_ASSERT(header.isValid(), "Invalid header");
+    lock_guard<Mutex> lock(impl_->mutex_);
     internal::AnalysisDataStorageFrameData* storedFrame;
     if (impl_->storeAll())
     {
@@ -849,6 +863,7 @@ AnalysisDataStorageFrame& AnalysisDataStorage::startFrame(int index, real x, rea
 
 AnalysisDataStorageFrame& AnalysisDataStorage::currentFrame(int index)
 {
+    lock_guard<Mutex> lock(impl_->mutex_);
     const int storageIndex = impl_->computeStorageLocation(index);
     GMX_RELEASE_ASSERT(storageIndex >= 0, "Out of bounds frame index");
 
@@ -871,6 +886,7 @@ void AnalysisDataStorage::finishFrameSerial(int index)
 {
     if (impl_->pendingLimit_ > 1)
     {
+        lock_guard<Mutex> lock(impl_->mutex_);
         impl_->finishFrameSerial(index);
     }
 }
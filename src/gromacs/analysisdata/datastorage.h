@@ -252,8 +252,9 @@ private:
  * AnalysisDataStorageFrame::finishPointSet()) take the responsibility of
  * calling all the notification methods in AnalysisDataModuleManager,
  *
- * \todo
- * Proper multi-threaded implementation.
+ * If startParallelDataStorage() is used, different frames can be started and
+ * finished concurrently from multiple threads.  finishFrameSerial() still
+ * needs to be called in frame order.
  *
  * \inlibraryapi
  * \ingroup module_analysisdata
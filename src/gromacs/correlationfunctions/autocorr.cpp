@@ -50,6 +50,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/correlationfunctions/expfit.h"
 #include "gromacs/correlationfunctions/integrate.h"
@@ -59,8 +60,11 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/utility/arraysize.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/real.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/strconvert.h"
@@ -68,6 +72,9 @@
 /*! \brief Shortcut macro to select modes. */
 #define MODE(x) ((mode & (x)) == (x))
 
+/*! \brief Number of items per thread correlated together with FFTs. */
+static const int c_fourItemsPerThread = 16;
+
 typedef struct
 {
     unsigned long mode;
@@ -82,50 +89,6 @@ static gmx_bool bACFinit = FALSE;
 /*! \brief Data structure for storing command line variables. */
 static t_acf acf;
 
-enum
-{
-    enNorm,
-    enCos,
-    enSin
-};
-
-/*! \brief Routine to compute ACF using FFT. */
-static void low_do_four_core(int nframes, real c1[], real cfour[], int nCos)
-{
-    int                            i = 0;
-    std::vector<std::vector<real>> data;
-    data.resize(1);
-    data[0].resize(nframes, 0);
-    switch (nCos)
-    {
-        case enNorm:
-            for (i = 0; (i < nframes); i++)
-            {
-                data[0][i] = c1[i];
-            }
-            break;
-        case enCos:
-            for (i = 0; (i < nframes); i++)
-            {
-                data[0][i] = cos(c1[i]);
-            }
-            break;
-        case enSin:
-            for (i = 0; (i < nframes); i++)
-            {
-                data[0][i] = sin(c1[i]);
-            }
-            break;
-        default: gmx_fatal(FARGS, "nCos = %d, %s %d", nCos, __FILE__, __LINE__);
-    }
-
-    many_auto_correl(&data);
-    for (i = 0; (i < nframes); i++)
-    {
-        cfour[i] = data[0][i];
-    }
-}
-
 /*! \brief Routine to comput ACF without FFT. */
 static void do_ac_core(int nframes, int nout, real corr[], real c1[], int nrestart, unsigned long mode)
 {
@@ -133,11 +96,7 @@ static void do_ac_core(int nframes, int nout, real corr[], real c1[], int nresta
     real ccc, cth;
     rvec xj, xk;
 
-    if (nrestart < 1)
-    {
-        printf("WARNING: setting number of restarts to 1\n");
-        nrestart = 1;
-    }
+    GMX_ASSERT(nrestart >= 1, "The caller should ensure at least one restart");
     if (debug)
     {
         fprintf(debug, "Starting do_ac_core: nframes=%d, nout=%d, nrestart=%d,mode=%lu\n", nframes,
@@ -321,209 +280,173 @@ static void norm_and_scale_vectors(int nframes, real c1[], real scale)
     }
 }
 
-/*! \brief Debugging */
-static void dump_tmp(char* s, int n, real c[])
-{
-    FILE* fp;
-    int   i;
-
-    fp = gmx_ffopen(s, "w");
-    for (i = 0; (i < n); i++)
-    {
-        fprintf(fp, "%10d  %10g\n", i, c[i]);
-    }
-    gmx_ffclose(fp);
-}
-
-/*! \brief High level ACF routine. */
-static void do_four_core(unsigned long mode, int nframes, real c1[], real csum[], real ctmp[])
+/*! \brief Number of FFT series per item for an ACF mode. */
+static int four_series_per_item(unsigned long mode)
 {
-    real* cfour;
-    char  buf[32];
-    real  fac;
-    int   j, m, m1;
-
-    snew(cfour, nframes);
-
     if (MODE(eacNormal))
     {
-        /********************************************
-         *  N O R M A L
-         ********************************************/
-        low_do_four_core(nframes, c1, csum, enNorm);
+        return 1;
     }
     else if (MODE(eacCos))
     {
-        /***************************************************
-         * C O S I N E
-         ***************************************************/
-        /* Copy the data to temp array. Since we need it twice
-         * we can't overwrite original.
-         */
-        for (j = 0; (j < nframes); j++)
-        {
-            ctmp[j] = c1[j];
-        }
-
-        /* Cosine term of AC function */
-        low_do_four_core(nframes, ctmp, cfour, enCos);
-        for (j = 0; (j < nframes); j++)
-        {
-            c1[j] = cfour[j];
-        }
-
-        /* Sine term of AC function */
-        low_do_four_core(nframes, ctmp, cfour, enSin);
-        for (j = 0; (j < nframes); j++)
-        {
-            c1[j] += cfour[j];
-            csum[j] = c1[j];
-        }
+        return 2;
     }
     else if (MODE(eacP2))
     {
-        /***************************************************
-         * Legendre polynomials
-         ***************************************************/
-        /* First normalize the vectors */
-        norm_and_scale_vectors(nframes, c1, 1.0);
-
-        /* For P2 thingies we have to do six FFT based correls
-         * First for XX^2, then for YY^2, then for ZZ^2
-         * Then we have to do XY, YZ and XZ (counting these twice)
-         * After that we sum them and normalise
-         * P2(x) = (3 * cos^2 (x) - 1)/2
-         * for unit vectors u and v we compute the cosine as the inner product
-         * cos(u,v) = uX vX + uY vY + uZ vZ
-         *
-         *        oo
-         *        /
-         * C(t) = |  (3 cos^2(u(t'),u(t'+t)) - 1)/2 dt'
-         *        /
-         *        0
-         *
-         * For ACF we need:
-         * P2(u(0),u(t)) = [3 * (uX(0) uX(t) +
-         *                       uY(0) uY(t) +
-         *                       uZ(0) uZ(t))^2 - 1]/2
-         *               = [3 * ((uX(0) uX(t))^2 +
-         *                       (uY(0) uY(t))^2 +
-         *                       (uZ(0) uZ(t))^2 +
-         *                 2(uX(0) uY(0) uX(t) uY(t)) +
-         *                 2(uX(0) uZ(0) uX(t) uZ(t)) +
-         *                 2(uY(0) uZ(0) uY(t) uZ(t))) - 1]/2
-         *
-         *               = [(3/2) * (<uX^2> + <uY^2> + <uZ^2> +
-         *                         2<uXuY> + 2<uXuZ> + 2<uYuZ>) - 0.5]
-         *
-         */
+        return 2 * DIM;
+    }
+    else if (MODE(eacP1) || MODE(eacVector))
+    {
+        return DIM;
+    }
+    gmx_fatal(FARGS, "\nUnknown mode in do_autocorr (%lu)", mode);
+}
 
-        /* Because of normalization the number of -0.5 to subtract
-         * depends on the number of data points!
-         */
-        for (j = 0; (j < nframes); j++)
+/*! \brief High level ACF routine.
+ *
+ * Computes the ACFs of items \p i0 to \p i1 of \p c1 using FFTs. All time
+ * series needed for these items are correlated in a single call to
+ * many_auto_correl(), which distributes them over threads.
+ */
+static void do_four_core(unsigned long mode, int nframes, int i0, int i1, real** c1)
+{
+    const int                      nseries = four_series_per_item(mode);
+    std::vector<std::vector<real>> data(nseries * (i1 - i0));
+    std::vector<real>              csum(nframes);
+    int                            i, j, m, m1;
+
+    /* Fill the time series to correlate */
+    for (i = i0; (i < i1); i++)
+    {
+        std::vector<real>* series = &data[nseries * (i - i0)];
+        for (int s = 0; (s < nseries); s++)
         {
-            csum[j] = -0.5 * (nframes - j);
+            series[s].resize(nframes);
         }
-
-        /***** DIAGONAL ELEMENTS ************/
-        for (m = 0; (m < DIM); m++)
+        if (MODE(eacNormal))
+        {
+            std::copy(c1[i], c1[i] + nframes, series[0].begin());
+        }
+        else if (MODE(eacCos))
         {
-            /* Copy the vector data in a linear array */
+            /* Cosine and sine terms of AC function */
             for (j = 0; (j < nframes); j++)
             {
-                ctmp[j] = gmx::square(c1[DIM * j + m]);
+                series[0][j] = std::cos(c1[i][j]);
+                series[1][j] = std::sin(c1[i][j]);
             }
-            if (debug)
+        }
+        else if (MODE(eacP2))
+        {
+            /* First normalize the vectors */
+            norm_and_scale_vectors(nframes, c1[i], 1.0);
+
+            /* For P2 thingies we have to do six FFT based correls
+             * First for XX^2, then for YY^2, then for ZZ^2
+             * Then we have to do XY, YZ and XZ (counting these twice)
+             * After that we sum them and normalise, see below.
+             */
+            for (m = 0; (m < DIM); m++)
             {
-                sprintf(buf, "c1diag%d.xvg", m);
-                dump_tmp(buf, nframes, ctmp);
+                m1 = (m + 1) % DIM;
+                for (j = 0; (j < nframes); j++)
+                {
+                    series[m][j]       = gmx::square(c1[i][DIM * j + m]);
+                    series[DIM + m][j] = c1[i][DIM * j + m] * c1[i][DIM * j + m1];
+                }
             }
-
-            low_do_four_core(nframes, ctmp, cfour, enNorm);
-
-            if (debug)
+        }
+        else
+        {
+            if (MODE(eacP1))
             {
-                sprintf(buf, "c1dfout%d.xvg", m);
-                dump_tmp(buf, nframes, cfour);
+                /* First normalize the vectors */
+                norm_and_scale_vectors(nframes, c1[i], 1.0);
             }
-            fac = 1.5;
-            for (j = 0; (j < nframes); j++)
+            /* For vector thingies we have to do three FFT based correls
+             * First for XX, then for YY, then for ZZ
+             * After that we sum them and normalise
+             */
+            for (m = 0; (m < DIM); m++)
             {
-                csum[j] += fac * (cfour[j]);
+                for (j = 0; (j < nframes); j++)
+                {
+                    series[m][j] = c1[i][DIM * j + m];
+                }
             }
         }
-        /******* OFF-DIAGONAL ELEMENTS **********/
-        for (m = 0; (m < DIM); m++)
+    }
+
+    many_auto_correl(&data);
+
+    /* Combine the correlations of each item */
+    for (i = i0; (i < i1); i++)
+    {
+        const std::vector<real>* cfour = &data[nseries * (i - i0)];
+        if (MODE(eacP2))
         {
-            /* Copy the vector data in a linear array */
-            m1 = (m + 1) % DIM;
+            /* P2(x) = (3 * cos^2 (x) - 1)/2
+             * for unit vectors u and v we compute the cosine as the inner product
+             * cos(u,v) = uX vX + uY vY + uZ vZ
+             *
+             *        oo
+             *        /
+             * C(t) = |  (3 cos^2(u(t'),u(t'+t)) - 1)/2 dt'
+             *        /
+             *        0
+             *
+             * For ACF we need:
+             * P2(u(0),u(t)) = [3 * (uX(0) uX(t) +
+             *                       uY(0) uY(t) +
+             *                       uZ(0) uZ(t))^2 - 1]/2
+             *               = [3 * ((uX(0) uX(t))^2 +
+             *                       (uY(0) uY(t))^2 +
+             *                       (uZ(0) uZ(t))^2 +
+             *                 2(uX(0) uY(0) uX(t) uY(t)) +
+             *                 2(uX(0) uZ(0) uX(t) uZ(t)) +
+             *                 2(uY(0) uZ(0) uY(t) uZ(t))) - 1]/2
+             *
+             *               = [(3/2) * (<uX^2> + <uY^2> + <uZ^2> +
+             *                         2<uXuY> + 2<uXuZ> + 2<uYuZ>) - 0.5]
+             *
+             * Because of normalization the number of -0.5 to subtract
+             * depends on the number of data points!
+             */
             for (j = 0; (j < nframes); j++)
             {
-                ctmp[j] = c1[DIM * j + m] * c1[DIM * j + m1];
+                csum[j] = -0.5 * (nframes - j);
             }
-
-            if (debug)
+            for (m = 0; (m < DIM); m++)
             {
-                sprintf(buf, "c1off%d.xvg", m);
-                dump_tmp(buf, nframes, ctmp);
+                for (j = 0; (j < nframes); j++)
+                {
+                    csum[j] += 1.5 * cfour[m][j];
+                }
             }
-            low_do_four_core(nframes, ctmp, cfour, enNorm);
-            if (debug)
+            for (m = 0; (m < DIM); m++)
             {
-                sprintf(buf, "c1ofout%d.xvg", m);
-                dump_tmp(buf, nframes, cfour);
+                for (j = 0; (j < nframes); j++)
+                {
+                    csum[j] += 3.0 * cfour[DIM + m][j];
+                }
             }
-            fac = 3.0;
+        }
+        else
+        {
             for (j = 0; (j < nframes); j++)
             {
-                csum[j] += fac * cfour[j];
+                csum[j] = 0;
+                for (int s = 0; (s < nseries); s++)
+                {
+                    csum[j] += cfour[s][j];
+                }
             }
         }
-    }
-    else if (MODE(eacP1) || MODE(eacVector))
-    {
-        /***************************************************
-         * V E C T O R & P1
-         ***************************************************/
-        if (MODE(eacP1))
-        {
-            /* First normalize the vectors */
-            norm_and_scale_vectors(nframes, c1, 1.0);
-        }
-
-        /* For vector thingies we have to do three FFT based correls
-         * First for XX, then for YY, then for ZZ
-         * After that we sum them and normalise
-         */
         for (j = 0; (j < nframes); j++)
         {
-            csum[j] = 0.0;
-        }
-        for (m = 0; (m < DIM); m++)
-        {
-            /* Copy the vector data in a linear array */
-            for (j = 0; (j < nframes); j++)
-            {
-                ctmp[j] = c1[DIM * j + m];
-            }
-            low_do_four_core(nframes, ctmp, cfour, enNorm);
-            for (j = 0; (j < nframes); j++)
-            {
-                csum[j] += cfour[j];
-            }
+            c1[i][j] = csum[j] / static_cast<real>(nframes - j);
         }
     }
-    else
-    {
-        gmx_fatal(FARGS, "\nUnknown mode in do_autocorr (%lu)", mode);
-    }
-
-    sfree(cfour);
-    for (j = 0; (j < nframes); j++)
-    {
-        c1[j] = csum[j] / static_cast<real>(nframes - j);
-    }
 }
 
 void low_do_autocorr(const char*             fn,
@@ -545,8 +468,7 @@ void low_do_autocorr(const char*             fn,
 {
     FILE *   fp, *gp = nullptr;
     int      i;
-    real*    csum;
-    real *   ctmp, *fit;
+    real*    fit;
     real     sum, Ct2av, Ctav;
     gmx_bool bFour = acf.bFour;
 
@@ -587,37 +509,53 @@ void low_do_autocorr(const char*             fn,
                gmx::boolToString(bFour), gmx::boolToString(bNormalize));
         printf("mode = %lu, dt = %g, nrestart = %d\n", mode, dt, nrestart);
     }
-    /* Allocate temp arrays */
-    snew(csum, nframes);
-    snew(ctmp, nframes);
-
     /* Loop over items (e.g. molecules or dihedrals)
      * In this loop the actual correlation functions are computed, but without
      * normalizing them.
      */
-    for (int i = 0; i < nitem; i++)
+    if (bFour)
     {
-        if (bVerbose && (((i % 100) == 0) || (i == nitem - 1)))
+        /* Correlate the items in batches, so the FFTs of many items are
+         * distributed over the threads while the memory stays bounded.
+         */
+        const int batchSize = c_fourItemsPerThread * gmx_omp_get_max_threads();
+        for (int i0 = 0; i0 < nitem; i0 += batchSize)
         {
-            fprintf(stderr, "\rThingie %d", i + 1);
-            fflush(stderr);
+            const int i1 = std::min(nitem, i0 + batchSize);
+            if (bVerbose)
+            {
+                fprintf(stderr, "\rThingie %d", i1);
+                fflush(stderr);
+            }
+            do_four_core(mode, nframes, i0, i1, c1);
         }
-
-        if (bFour)
+    }
+    else
+    {
+        if (nrestart < 1)
         {
-            do_four_core(mode, nframes, c1[i], csum, ctmp);
+            printf("WARNING: setting number of restarts to 1\n");
+            nrestart = 1;
         }
-        else
+        const int nthreads = std::max(1, std::min(nitem, gmx_omp_get_max_threads()));
+#pragma omp parallel num_threads(nthreads)
         {
-            do_ac_core(nframes, nout, ctmp, c1[i], nrestart, mode);
+            try
+            {
+                std::vector<real> ctmp(nframes);
+#pragma omp for schedule(dynamic)
+                for (int i = 0; i < nitem; i++)
+                {
+                    do_ac_core(nframes, nout, ctmp.data(), c1[i], nrestart, mode);
+                }
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
         }
     }
     if (bVerbose)
     {
         fprintf(stderr, "\n");
     }
-    sfree(ctmp);
-    sfree(csum);
 
     if (fn)
     {
@@ -73,48 +73,47 @@ int many_auto_correl(std::vector<std::vector<real>>* c)
         }
     }
 #endif
-    // Add buffer size to the arrays.
+    // Add buffer size to the arrays. The real transforms need an even length.
     size_t nfft = (3 * ndata / 2) + 1;
+    nfft += nfft % 2;
     // Pad arrays with zeros
     for (auto& i : *c)
     {
         i.resize(nfft, 0);
     }
-#pragma omp parallel
+    // Do not start threads that would not get any functions to correlate
+    const int nthreads = static_cast<int>(std::min<size_t>(nfunc, gmx_omp_get_max_threads()));
+#pragma omp parallel num_threads(nthreads)
     {
         try
         {
             gmx_fft_t         fft1;
             std::vector<real> in, out;
 
-            int nthreads  = gmx_omp_get_max_threads();
             int thread_id = gmx_omp_get_thread_num();
             int i0        = (thread_id * nfunc) / nthreads;
             int i1        = std::min(nfunc, ((thread_id + 1) * nfunc) / nthreads);
 
-            gmx_fft_init_1d(&fft1, nfft, GMX_FFT_FLAG_CONSERVATIVE);
-            /* Allocate temporary arrays */
-            in.resize(2 * nfft, 0);
-            out.resize(2 * nfft, 0);
+            /* One plan per thread, reused for all functions of this thread */
+            gmx_fft_init_1d_real(&fft1, nfft, GMX_FFT_FLAG_CONSERVATIVE);
+            /* Allocate temporary arrays, the complex data has nfft/2+1 elements */
+            in.resize(nfft + 2, 0);
+            out.resize(nfft + 2, 0);
             for (int i = i0; (i < i1); i++)
             {
-                for (size_t j = 0; j < ndata; j++)
+                std::copy((*c)[i].begin(), (*c)[i].end(), in.begin());
+                gmx_fft_1d_real(fft1, GMX_FFT_REAL_TO_COMPLEX, in.data(), out.data());
+                /* The power spectrum is real, so the transform back only needs
+                 * half of it thanks to the Hermitian symmetry.
+                 */
+                for (size_t j = 0; j <= nfft / 2; j++)
                 {
-                    in[2 * j + 0] = (*c)[i][j];
-                    in[2 * j + 1] = 0;
-                }
-                gmx_fft_1d(fft1, GMX_FFT_BACKWARD, in.data(), out.data());
-                for (size_t j = 0; j < nfft; j++)
-                {
-                    in[2 * j + 0] =
+                    out[2 * j + 0] =
                             (out[2 * j + 0] * out[2 * j + 0] + out[2 * j + 1] * out[2 * j + 1]) / nfft;
-                    in[2 * j + 1] = 0;
-                }
-                gmx_fft_1d(fft1, GMX_FFT_FORWARD, in.data(), out.data());
-                for (size_t j = 0; (j < nfft); j++)
-                {
-                    (*c)[i][j] = out[2 * j + 0];
+                    out[2 * j + 1] = 0;
                 }
+                gmx_fft_1d_real(fft1, GMX_FFT_COMPLEX_TO_REAL, out.data(), in.data());
+                std::copy(in.begin(), in.begin() + nfft, (*c)[i].begin());
             }
             /* Free the memory */
             gmx_fft_destroy(fft1);
@@ -62,7 +62,10 @@
  * The c arrays will be extend and filled with zero beyond ndata before
  * computing the correlation.
  *
- * The functions uses OpenMP parallellization.
+ * The functions uses OpenMP parallellization over the vectors, with one
+ * real-to-complex FFT setup per thread that is reused for all vectors
+ * handled by that thread. Pass as many vectors as possible in a single call
+ * for efficiency.
  *
  * \param[inout] c Data array
  * \return fft error code, or zero if everything went fine (see fft/fft.h)
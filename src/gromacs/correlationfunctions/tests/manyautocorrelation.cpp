@@ -81,6 +81,38 @@ TEST_F(ManyAutocorrelationTest, DifferentLength)
 }
 #endif
 
+TEST_F(ManyAutocorrelationTest, MatchesDirectSumForManyFunctions)
+{
+    const int                      nfunc = 7;
+    const int                      ndata = 41;
+    std::vector<std::vector<real>> c(nfunc, std::vector<real>(ndata));
+    for (int i = 0; i < nfunc; i++)
+    {
+        for (int j = 0; j < ndata; j++)
+        {
+            c[i][j] = std::cos(0.3 * (i + 1) * j) + 0.1 * i;
+        }
+    }
+    std::vector<std::vector<real>> ref = c;
+
+    EXPECT_EQ(0, many_auto_correl(&c));
+
+    // The zero padding makes the correlation exact for the first half
+    for (int i = 0; i < nfunc; i++)
+    {
+        ASSERT_EQ(ndata, static_cast<int>(c[i].size()));
+        for (int t = 0; t < ndata / 2; t++)
+        {
+            real sum = 0;
+            for (int j = 0; j + t < ndata; j++)
+            {
+                sum += ref[i][j] * ref[i][j + t];
+            }
+            EXPECT_REAL_EQ_TOL(sum, c[i][t], test::relativeToleranceAsFloatingPoint(ndata, 1e-4));
+        }
+    }
+}
+
 } // namespace
 
 } // namespace gmx
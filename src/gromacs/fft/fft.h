@@ -354,6 +354,31 @@ void gmx_many_fft_destroy(gmx_fft_t setup);
  */
 int gmx_fft_transpose_2d(t_complex* in_data, t_complex* out_data, int nx, int ny);
 
+/*! \brief Import previously stored FFT planning data
+ *
+ *  With FFTW, when the environment variable GMX_FFTW_WISDOM_FILE is set,
+ *  the wisdom stored in that file is imported, once per process. This
+ *  makes planning with measurements fast for transform sizes that have
+ *  been planned before on the same hardware. The wisdom is only imported
+ *  when the first line of the file matches the CPU, SIMD level, FFTW
+ *  version and precision of this build; otherwise, as with a missing or
+ *  unreadable file, we plan from scratch. Does nothing with other FFT
+ *  libraries.
+ */
+void gmx_fft_import_wisdom();
+
+/*! \brief Store the FFT planning data for use by later runs
+ *
+ *  With FFTW, when the environment variable GMX_FFTW_WISDOM_FILE is set,
+ *  the accumulated wisdom is written to that file, but only when it
+ *  changed since the last export, preceded by a line identifying the
+ *  CPU, SIMD level, FFTW version and precision. Should be called by a
+ *  single rank of the FFT decomposition. The file is replaced atomically,
+ *  so readers never see a partial file. Does nothing with other FFT
+ *  libraries.
+ */
+void gmx_fft_export_wisdom();
+
 /*! \brief Cleanup global data of FFT
  *
  *  Any plans are invalid after this function. Should be called
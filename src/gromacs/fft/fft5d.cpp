@@ -84,25 +84,8 @@ FILE* debug = 0;
 #endif
 
 #if GMX_FFT_FFTW3
-
-#    include "gromacs/utility/exceptions.h"
-#    include "gromacs/utility/mutex.h"
-/* none of the fftw3 calls, except execute(), are thread-safe, so
-   we need to serialize them with this mutex. */
-static gmx::Mutex big_fftw_mutex;
-#    define FFTW_LOCK              \
-        try                        \
-        {                          \
-            big_fftw_mutex.lock(); \
-        }                          \
-        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-#    define FFTW_UNLOCK              \
-        try                          \
-        {                            \
-            big_fftw_mutex.unlock(); \
-        }                            \
-        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-#endif /* GMX_FFT_FFTW3 */
+#    include "gromacs/fft/fftw_lock.h"
+#endif
 
 #if GMX_MPI
 /* largest factor smaller than sqrt */
@@ -478,6 +461,9 @@ fft5d_plan fft5d_plan_3d(int                NG,
         fprintf(debug, "Running on %d threads\n", nthreads);
     }
 
+    /* Reuse plans measured in earlier runs, when available */
+    gmx_fft_import_wisdom();
+
 #if GMX_FFT_FFTW3
     /* Don't add more stuff here! We have already had at least one bug because we are reimplementing
      * the low-level FFT interface instead of using the Gromacs FFT module. If we need more
@@ -730,6 +716,13 @@ fft5d_plan fft5d_plan_3d(int                NG,
     *rlout              = lout;
     *rlout2             = lout2;
     *rlout3             = lout3;
+
+    /* All ranks learn the same wisdom, so only the master rank stores it */
+    if (bMaster && !(flags & FFT5D_NOMEASURE))
+    {
+        gmx_fft_export_wisdom();
+    }
+
     return plan;
 }
 
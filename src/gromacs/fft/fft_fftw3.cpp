@@ -38,14 +38,23 @@
 #include "config.h"
 
 #include <cerrno>
+#include <cstdio>
 #include <cstdlib>
 
+#include <string>
+
 #include <fftw3.h>
 
 #include "gromacs/fft/fft.h"
+#include "gromacs/fft/fftw_lock.h"
+#include "gromacs/hardware/cpuinfo.h"
+#include "gromacs/simd/support.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
-#include "gromacs/utility/mutex.h"
+#include "gromacs/utility/futil.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/sysinfo.h"
+#include "gromacs/utility/textreader.h"
 
 #if GMX_DOUBLE
 #    define FFTWPREFIX(name) fftw_##name
@@ -53,21 +62,17 @@
 #    define FFTWPREFIX(name) fftwf_##name
 #endif
 
-/* none of the fftw3 calls, except execute(), are thread-safe, so
-   we need to serialize them with this mutex. */
-static gmx::Mutex big_fftw_mutex;
-#define FFTW_LOCK              \
-    try                        \
-    {                          \
-        big_fftw_mutex.lock(); \
-    }                          \
-    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-#define FFTW_UNLOCK              \
-    try                          \
-    {                            \
-        big_fftw_mutex.unlock(); \
-    }                            \
-    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+namespace gmx
+{
+
+Mutex& fftwMutex()
+{
+    /* Constructed on first use, so it is valid during static initialization */
+    static Mutex mutex;
+    return mutex;
+}
+
+} // namespace gmx
 
 /* We assume here that aligned memory starts at multiple of 16 bytes and unaligned memory starts at multiple of 8 bytes. The later is guranteed for all malloc implementation.
    Consequesences:
@@ -587,6 +592,107 @@ void gmx_many_fft_destroy(gmx_fft_t fft)
     gmx_fft_destroy(fft);
 }
 
+/*! \brief Returns the first line of wisdom files, which identifies what the wisdom is valid for
+ *
+ * Wisdom measured on other hardware, with another FFTW version or
+ * in another precision gives slow or invalid plans, so it is only
+ * used when this line matches.
+ */
+static const std::string& wisdomHeader()
+{
+    static const std::string header = gmx::formatString(
+            "GROMACS FFTW wisdom for CPU: %s; SIMD: %s; FFTW: %s; precision: %s\n",
+            gmx::CpuInfo::detect().brandString().c_str(),
+            gmx::simdString(gmx::simdCompiled()).c_str(), FFTWPREFIX(version),
+            GMX_DOUBLE ? "double" : "single");
+    return header;
+}
+
+void gmx_fft_import_wisdom()
+{
+    static bool haveImportedWisdom = false;
+
+    const char* wisdomFile = getenv("GMX_FFTW_WISDOM_FILE");
+    if (wisdomFile == nullptr)
+    {
+        return;
+    }
+
+    FFTW_LOCK
+    if (!haveImportedWisdom)
+    {
+        haveImportedWisdom = true;
+        /* A missing or unreadable file, or one for other hardware or FFTW,
+         * is not an error, we then plan from scratch */
+        const std::string& header = wisdomHeader();
+        std::string        contents;
+        try
+        {
+            if (gmx_fexist(wisdomFile))
+            {
+                contents = gmx::TextReader::readFileToString(wisdomFile);
+            }
+        }
+        catch (const gmx::FileIOError&)
+        {
+            contents.clear();
+        }
+        if (gmx::startsWith(contents, header))
+        {
+            FFTWPREFIX(import_wisdom_from_string)(contents.c_str() + header.size());
+        }
+        else if (debug && !contents.empty())
+        {
+            fprintf(debug, "Not using FFTW wisdom from %s, it was not stored for %s", wisdomFile,
+                    header.c_str());
+        }
+    }
+    FFTW_UNLOCK
+}
+
+void gmx_fft_export_wisdom()
+{
+    /* The wisdom we last wrote, to avoid rewriting the file when nothing was learned */
+    static std::string exportedWisdom;
+
+    const char* wisdomFile = getenv("GMX_FFTW_WISDOM_FILE");
+    if (wisdomFile == nullptr)
+    {
+        return;
+    }
+
+    FFTW_LOCK
+    char*       wisdomString = FFTWPREFIX(export_wisdom_to_string)();
+    std::string wisdom       = (wisdomString != nullptr ? wisdomString : "");
+    free(wisdomString);
+    bool haveNewWisdom = (!wisdom.empty() && wisdom != exportedWisdom);
+    if (haveNewWisdom)
+    {
+        exportedWisdom = wisdom;
+    }
+    FFTW_UNLOCK
+    if (!haveNewWisdom)
+    {
+        return;
+    }
+
+    /* Write to a temporary file and rename it, so other processes, e.g.
+     * other simulations sharing the file, never read a partially written file.
+     */
+    std::string tmpFile = gmx::formatString("%s.%d", wisdomFile, gmx_getpid());
+    FILE*       fp      = std::fopen(tmpFile.c_str(), "w");
+    bool        written = (fp != nullptr && std::fputs(wisdomHeader().c_str(), fp) >= 0
+                    && std::fputs(wisdom.c_str(), fp) >= 0);
+    if (fp != nullptr)
+    {
+        written = (std::fclose(fp) == 0) && written;
+    }
+    if (!written || std::rename(tmpFile.c_str(), wisdomFile) != 0)
+    {
+        std::remove(tmpFile.c_str());
+    }
+}
+
 void gmx_fft_cleanup()
 {
     FFTWPREFIX(cleanup)();
@@ -0,0 +1,74 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares the lock that serializes FFTW calls within the FFT module.
+ *
+ * None of the FFTW3 calls, except execute(), are thread-safe. Both the
+ * gmx_fft wrappers and fft5d call FFTW directly, so they must share a
+ * single lock.
+ *
+ * \ingroup module_fft
+ */
+#ifndef GMX_FFT_FFTW_LOCK_H
+#define GMX_FFT_FFTW_LOCK_H
+
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/mutex.h"
+
+namespace gmx
+{
+
+//! Returns the mutex that serializes all non-execute FFTW calls in this process
+Mutex& fftwMutex();
+
+} // namespace gmx
+
+//! Acquires the FFTW lock, exits with a fatal error on failure
+#define FFTW_LOCK                \
+    try                          \
+    {                            \
+        gmx::fftwMutex().lock(); \
+    }                            \
+    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+//! Releases the FFTW lock, exits with a fatal error on failure
+#define FFTW_UNLOCK                \
+    try                            \
+    {                              \
+        gmx::fftwMutex().unlock(); \
+    }                              \
+    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+
+#endif
@@ -49,6 +49,9 @@
 
 #include <array>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "buildinfo.h"
 #include "gromacs/fileio/filetypes.h"
@@ -77,6 +80,7 @@
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/baseversion.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
@@ -87,6 +91,7 @@
 #include "gromacs/utility/mdmodulenotification.h"
 #include "gromacs/utility/programcontext.h"
 #include "gromacs/utility/smalloc.h"
+#include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/sysinfo.h"
 #include "gromacs/utility/txtdump.h"
 
@@ -2190,29 +2195,235 @@ static void mpiBarrierBeforeRename(const bool applyMpiBarrierBeforeRename, MPI_C
     }
 }
 
-void write_checkpoint(const char*                   fn,
-                      gmx_bool                      bNumberAndKeep,
-                      FILE*                         fplog,
-                      const t_commrec*              cr,
-                      ivec                          domdecCells,
-                      int                           nppnodes,
-                      int                           eIntegrator,
-                      int                           simulation_part,
-                      gmx_bool                      bExpanded,
-                      int                           elamstats,
-                      int64_t                       step,
-                      double                        t,
-                      t_state*                      state,
-                      ObservablesHistory*           observablesHistory,
-                      const gmx::MdModulesNotifier& mdModulesNotifier,
-                      bool                          applyMpiBarrierBeforeRename,
-                      MPI_Comm                      mpiBarrierCommunicator)
+/*! \brief Physically writes \p fio, or all output files when \p fio is nullptr, to disk
+ *
+ * Returns an error message, or an empty string on success or when fsync
+ * failures are ignored. \p syncFailed is set when any fsync failed.
+ * Does not call gmx_fatal, so that it can run in a background thread.
+ */
+static std::string syncToDisk(t_fileio* fio, bool* syncFailed)
+{
+    t_fileio* ret = nullptr;
+    if (fio == nullptr)
+    {
+        ret = gmx_fio_all_output_fsync();
+    }
+    else if (gmx_fio_fsync(fio) != 0)
+    {
+        ret = fio;
+    }
+    *syncFailed = (ret != nullptr);
+
+    if (ret)
+    {
+        std::string message = gmx::formatString(
+                "Cannot fsync '%s'; maybe you are out of disk space?", gmx_fio_getname(ret));
+
+        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
+        {
+            return message;
+        }
+        else
+        {
+            gmx_warning("%s", message.c_str());
+        }
+    }
+    return std::string();
+}
+
+/*! \brief Closes the checkpoint file \p fp and moves it to \p fn
+ *
+ * \p fp was opened as \p tempName. It is not moved when \p syncFailed
+ * is set. Returns an error message, or an empty string on success.
+ * Does not call gmx_fatal, so that it can run in a background thread.
+ */
+static std::string completeCheckpointFile(t_fileio*          fp,
+                                          const std::string& tempName,
+                                          const std::string& fn,
+                                          bool               bNumberAndKeep,
+                                          bool               syncFailed,
+                                          bool               applyMpiBarrierBeforeRename,
+                                          MPI_Comm           mpiBarrierCommunicator)
+{
+    if (gmx_fio_close(fp) != 0)
+    {
+        return "Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?";
+    }
+
+    /* we don't move the checkpoint if the user specified they didn't want it,
+       or if the fsyncs failed */
+#if !GMX_NO_RENAME
+    if (!bNumberAndKeep && !syncFailed)
+    {
+        if (gmx_fexist(fn))
+        {
+            /* Rename the previous checkpoint file */
+            mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+
+            const size_t extensionStart = fn.size() - std::strlen(ftp2ext(fn2ftp(fn.c_str()))) - 1;
+            const std::string prevName =
+                    fn.substr(0, extensionStart) + "_prev" + fn.substr(extensionStart);
+            if (!GMX_FAHCORE)
+            {
+                /* we copy here so that if something goes wrong between now and
+                 * the rename below, there's always a state.cpt.
+                 * If renames are atomic (such as in POSIX systems),
+                 * this copying should be unneccesary.
+                 */
+                gmx_file_copy(fn.c_str(), prevName.c_str(), FALSE);
+                /* We don't really care if this fails:
+                 * there's already a new checkpoint.
+                 */
+            }
+            else
+            {
+                gmx_file_rename(fn.c_str(), prevName.c_str());
+            }
+        }
+
+        /* Rename the checkpoint file from the temporary to the final name */
+        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
+
+        if (gmx_file_rename(tempName.c_str(), fn.c_str()) != 0)
+        {
+            return "Cannot rename checkpoint file; maybe you are out of disk space?";
+        }
+    }
+#else
+    GMX_UNUSED_VALUE(tempName);
+    GMX_UNUSED_VALUE(fn);
+    GMX_UNUSED_VALUE(bNumberAndKeep);
+    GMX_UNUSED_VALUE(syncFailed);
+    GMX_UNUSED_VALUE(applyMpiBarrierBeforeRename);
+    GMX_UNUSED_VALUE(mpiBarrierCommunicator);
+#endif /* GMX_NO_RENAME */
+
+    return std::string();
+}
+
+/*! \brief Returns the size of the file buffer for a checkpoint of \p state
+ *
+ * Only the per-atom vectors scale with the system size, a fixed margin
+ * covers the rest. When the checkpoint does not fit, part of it is
+ * written out by the calling thread, which is slower, but still correct.
+ */
+static size_t checkpointBufferSize(const t_state& state)
+{
+    const size_t c_margin   = 16 * 1024 * 1024;
+    size_t       numVectors = 0;
+    for (int part : { estX, estV, estCGP })
+    {
+        if (state.flags & (1 << part))
+        {
+            numVectors++;
+        }
+    }
+    return numVectors * state.natoms * DIM * sizeof(real) + c_margin;
+}
+
+namespace gmx
+{
+
+/********************************************************************
+ * BackgroundCheckpointWriter::Impl
+ */
+
+class BackgroundCheckpointWriter::Impl
+{
+public:
+    //! File buffer for serializing checkpoints.
+    std::vector<char> buffer_;
+    //! Thread completing the checkpoint in progress.
+    std::thread thread_;
+    //! Error message from completing the last checkpoint, empty on success.
+    std::string error_;
+};
+
+/********************************************************************
+ * BackgroundCheckpointWriter
+ */
+
+BackgroundCheckpointWriter::BackgroundCheckpointWriter() : impl_(new Impl) {}
+
+BackgroundCheckpointWriter::~BackgroundCheckpointWriter()
+{
+    if (impl_->thread_.joinable())
+    {
+        impl_->thread_.join();
+    }
+}
+
+void BackgroundCheckpointWriter::waitForCompletion()
+{
+    if (impl_->thread_.joinable())
+    {
+        impl_->thread_.join();
+    }
+    if (!impl_->error_.empty())
+    {
+        const std::string error = impl_->error_;
+        impl_->error_.clear();
+        gmx_file(error);
+    }
+}
+
+char* BackgroundCheckpointWriter::reserveBuffer(size_t size)
+{
+    waitForCompletion();
+    if (impl_->buffer_.size() < size)
+    {
+        impl_->buffer_.resize(size);
+    }
+    return impl_->buffer_.data();
+}
+
+void BackgroundCheckpointWriter::runInBackground(std::function<std::string()> task)
+{
+    waitForCompletion();
+    impl_->thread_ = std::thread([this, task]() {
+        try
+        {
+            impl_->error_ = task();
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    });
+}
+
+} // namespace gmx
+
+void write_checkpoint(const char*                      fn,
+                      gmx_bool                         bNumberAndKeep,
+                      FILE*                            fplog,
+                      const t_commrec*                 cr,
+                      ivec                             domdecCells,
+                      int                              nppnodes,
+                      int                              eIntegrator,
+                      int                              simulation_part,
+                      gmx_bool                         bExpanded,
+                      int                              elamstats,
+                      int64_t                          step,
+                      double                           t,
+                      t_state*                         state,
+                      ObservablesHistory*              observablesHistory,
+                      const gmx::MdModulesNotifier&    mdModulesNotifier,
+                      bool                             applyMpiBarrierBeforeRename,
+                      MPI_Comm                         mpiBarrierCommunicator,
+                      gmx::BackgroundCheckpointWriter* backgroundWriter)
 {
     t_fileio* fp;
     char*     fntemp; /* the temporary checkpoint file name */
     int       npmenodes;
     char      buf[1024], suffix[5 + STEPSTRSIZE], sbuf[STEPSTRSIZE];
-    t_fileio* ret;
+
+    /* A barrier can only be applied from the master thread */
+    const bool useBackgroundWriter =
+            (backgroundWriter != nullptr && !applyMpiBarrierBeforeRename && !GMX_FAHCORE);
+    if (backgroundWriter != nullptr)
+    {
+        /* The previous checkpoint has to be complete before we record
+         * the output file positions and possibly reuse its buffer */
+        backgroundWriter->waitForCompletion();
+    }
 
     if (DOMAINDECOMP(cr))
     {
@@ -2248,7 +2459,27 @@ void write_checkpoint(const char*                   fn,
     /* Get offsets for open files */
     auto outputfiles = gmx_fio_get_output_file_positions();
 
+    bool outputSyncFailed = false;
+    if (useBackgroundWriter)
+    {
+        /* The output files are synced here, before the checkpoint file is
+         * opened, so the background thread only accesses the checkpoint file.
+         * The caller has written out the frames queued by writer threads.
+         */
+        const std::string error = syncToDisk(nullptr, &outputSyncFailed);
+        if (!error.empty())
+        {
+            gmx_file(error);
+        }
+    }
+
     fp = gmx_fio_open(fntemp, "w");
+    if (useBackgroundWriter)
+    {
+        /* Serialize into a buffer that is written out in the background */
+        const size_t bufferSize = checkpointBufferSize(*state);
+        setvbuf(gmx_fio_getfp(fp), backgroundWriter->reserveBuffer(bufferSize), _IOFBF, bufferSize);
+    }
 
     int flags_eks;
     if (state->ekinstate.bUpToDate)
@@ -2399,75 +2630,40 @@ void write_checkpoint(const char*                   fn,
 
     do_cpt_footer(gmx_fio_getxdr(fp), headerContents.file_version);
 
+    std::string tempName = fntemp;
+    sfree(fntemp);
     /* we really, REALLY, want to make sure to physically write the checkpoint,
        and all the files it depends on, out to disk. Because we've
        opened the checkpoint with gmx_fio_open(), it's in our list
-       of open files.  */
-    ret = gmx_fio_all_output_fsync();
-
-    if (ret)
-    {
-        char buf[STRLEN];
-        sprintf(buf, "Cannot fsync '%s'; maybe you are out of disk space?", gmx_fio_getname(ret));
-
-        if (getenv(GMX_IGNORE_FSYNC_FAILURE_ENV) == nullptr)
-        {
-            gmx_file(buf);
-        }
-        else
-        {
-            gmx_warning("%s", buf);
-        }
+       of open files. With the background writer, the other files
+       have been synced already. */
+    t_fileio* fileToSync = useBackgroundWriter ? fp : nullptr;
+    auto completeCheckpoint = [fp, fileToSync, tempName, fn = std::string(fn), bNumberAndKeep,
+                               outputSyncFailed, applyMpiBarrierBeforeRename,
+                               mpiBarrierCommunicator]() {
+        bool              syncFailed;
+        const std::string error = syncToDisk(fileToSync, &syncFailed);
+        if (!error.empty())
+        {
+            gmx_fio_close(fp);
+            return error;
+        }
+        return completeCheckpointFile(fp, tempName, fn, bNumberAndKeep,
+                                      syncFailed || outputSyncFailed, applyMpiBarrierBeforeRename,
+                                      mpiBarrierCommunicator);
+    };
+    if (useBackgroundWriter)
+    {
+        backgroundWriter->runInBackground(completeCheckpoint);
     }
-
-    if (gmx_fio_close(fp) != 0)
-    {
-        gmx_file("Cannot read/write checkpoint; corrupt file, or maybe you are out of disk space?");
-    }
-
-    /* we don't move the checkpoint if the user specified they didn't want it,
-       or if the fsyncs failed */
-#if !GMX_NO_RENAME
-    if (!bNumberAndKeep && !ret)
+    else
     {
-        if (gmx_fexist(fn))
+        const std::string error = completeCheckpoint();
+        if (!error.empty())
         {
-            /* Rename the previous checkpoint file */
-            mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
-
-            std::strcpy(buf, fn);
-            buf[std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1] = '\0';
-            std::strcat(buf, "_prev");
-            std::strcat(buf, fn + std::strlen(fn) - std::strlen(ftp2ext(fn2ftp(fn))) - 1);
-            if (!GMX_FAHCORE)
-            {
-                /* we copy here so that if something goes wrong between now and
-                 * the rename below, there's always a state.cpt.
-                 * If renames are atomic (such as in POSIX systems),
-                 * this copying should be unneccesary.
-                 */
-                gmx_file_copy(fn, buf, FALSE);
-                /* We don't really care if this fails:
-                 * there's already a new checkpoint.
-                 */
-            }
-            else
-            {
-                gmx_file_rename(fn, buf);
-            }
-        }
-
-        /* Rename the checkpoint file from the temporary to the final name */
-        mpiBarrierBeforeRename(applyMpiBarrierBeforeRename, mpiBarrierCommunicator);
-
-        if (gmx_file_rename(fntemp, fn) != 0)
-        {
-            gmx_file("Cannot rename checkpoint file; maybe you are out of disk space?");
+            gmx_file(error);
         }
     }
-#endif /* GMX_NO_RENAME */
-
-    sfree(fntemp);
 
 #if GMX_FAHCORE
     /*code for alternate checkpointing scheme.  moved from top of loop over
@@ -41,10 +41,13 @@
 
 #include <cstdio>
 
+#include <functional>
+#include <string>
 #include <vector>
 
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/gmxmpi.h"
 #include "gromacs/utility/keyvaluetreebuilder.h"
 
@@ -177,27 +180,83 @@ struct CheckpointHeaderContents
     int eSwapCoords;
 };
 
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Completes checkpoint files in a background thread.
+ *
+ * When passed to write_checkpoint(), the checkpoint is serialized into a
+ * file buffer that is large enough to hold the whole checkpoint, so the
+ * caller does not wait for the file system. Writing out the buffer,
+ * syncing the checkpoint file to disk and renaming the checkpoint files
+ * happen in a background thread, while the simulation continues.
+ * The other output files are synced by the calling thread before, so
+ * the background thread only accesses the checkpoint file.
+ * At most one checkpoint is in progress; write_checkpoint() waits for
+ * the previous one before starting the next.
+ */
+class BackgroundCheckpointWriter
+{
+public:
+    BackgroundCheckpointWriter();
+    //! Waits for the checkpoint in progress.
+    ~BackgroundCheckpointWriter();
+
+    /*! \brief
+     * Waits for the checkpoint in progress, if any, to be complete
+     *
+     * Generates a fatal error when completing the checkpoint failed.
+     */
+    void waitForCompletion();
+
+    /*! \brief
+     * Returns a buffer of at least \p size bytes for serializing a checkpoint
+     *
+     * The buffer is reused for later checkpoints. Waits for the checkpoint
+     * in progress first, as that might still use the buffer.
+     */
+    char* reserveBuffer(size_t size);
+
+    /*! \brief
+     * Runs \p task in a background thread
+     *
+     * \p task returns an error message, or an empty string on success.
+     */
+    void runInBackground(std::function<std::string()> task);
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
 /* Write a checkpoint to <fn>.cpt
  * Appends the _step<step>.cpt with bNumberAndKeep,
  * otherwise moves the previous <fn>.cpt to <fn>_prev.cpt
+ * With backgroundWriter != nullptr, the file is written out and renamed
+ * in a background thread, unless an MPI barrier is required before renaming.
  */
-void write_checkpoint(const char*                   fn,
-                      gmx_bool                      bNumberAndKeep,
-                      FILE*                         fplog,
-                      const t_commrec*              cr,
-                      ivec                          domdecCells,
-                      int                           nppnodes,
-                      int                           eIntegrator,
-                      int                           simulation_part,
-                      gmx_bool                      bExpanded,
-                      int                           elamstats,
-                      int64_t                       step,
-                      double                        t,
-                      t_state*                      state,
-                      ObservablesHistory*           observablesHistory,
-                      const gmx::MdModulesNotifier& notifier,
-                      bool                          applyMpiBarrierBeforeRename,
-                      MPI_Comm                      mpiBarrierCommunicator);
+void write_checkpoint(const char*                      fn,
+                      gmx_bool                         bNumberAndKeep,
+                      FILE*                            fplog,
+                      const t_commrec*                 cr,
+                      ivec                             domdecCells,
+                      int                              nppnodes,
+                      int                              eIntegrator,
+                      int                              simulation_part,
+                      gmx_bool                         bExpanded,
+                      int                              elamstats,
+                      int64_t                          step,
+                      double                           t,
+                      t_state*                         state,
+                      ObservablesHistory*              observablesHistory,
+                      const gmx::MdModulesNotifier&    notifier,
+                      bool                             applyMpiBarrierBeforeRename,
+                      MPI_Comm                         mpiBarrierCommunicator,
+                      gmx::BackgroundCheckpointWriter* backgroundWriter);
 
 /* Loads a checkpoint from fn for run continuation.
  * Generates a fatal error on system size mismatch.
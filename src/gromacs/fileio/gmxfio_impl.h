@@ -69,6 +69,8 @@ struct t_fileio
     enum xdr_op xdrmode; /* the xdr mode */
     int         iFTP;    /* the file type identifier */
 
+    XtcCompressedCoords xtcCoords; /* buffer for reading compressed xtc coordinates */
+
     t_fileio *next, *prev; /* next and previous file pointers in the
                               linked list */
     tMPI_Lock_t mtx;       /* content locking mutex. This is a fast lock
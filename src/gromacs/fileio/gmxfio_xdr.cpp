@@ -104,6 +104,11 @@ XDR* gmx_fio_getxdr(t_fileio* fio)
     return ret;
 }
 
+XtcCompressedCoords* gmx_fio_getxtccoords(t_fileio* fio)
+{
+    return &fio->xtcCoords;
+}
+
 /* check the number of items given against the type */
 static void gmx_fio_check_nitem(int eio, std::size_t nitem, const char* file, int line)
 {
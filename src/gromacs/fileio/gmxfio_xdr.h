@@ -57,6 +57,10 @@ bool gmx_fio_is_double(struct t_fileio* fio);
 XDR* gmx_fio_getxdr(struct t_fileio* fio);
 /* Return the file pointer itself */
 
+XtcCompressedCoords* gmx_fio_getxtccoords(struct t_fileio* fio);
+/* Return the buffer for reading compressed xtc coordinates of this file,
+ * which keeps its memory between frames */
+
 gmx_bool gmx_fio_writee_string(struct t_fileio* fio, const char* item, const char* desc, const char* srcfile, int line);
 
 /* reading or writing, depending on the file's opening mode string */
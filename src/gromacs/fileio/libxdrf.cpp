@@ -43,6 +43,8 @@
 #include <cstring>
 
 #include <algorithm>
+#include <array>
+#include <vector>
 
 #include "gromacs/fileio/xdr_datatype.h"
 #include "gromacs/fileio/xdrf.h"
@@ -156,7 +158,7 @@ static int sizeofint(const int size)
  |
  | given the number of small unsigned integers and the maximum value
  | return the number of bits needed to read or write them with the
- | routines receiveints and sendints. You need this parameter when
+ | routines readInts and sendints. You need this parameter when
  | calling these routines. Note that for many calls I can use
  | the variable 'smallidx' which is exactly the number of bits, and
  | So I don't need to call 'sizeofints for those calls.
@@ -273,86 +275,170 @@ static void sendints(int          buf[],
 }
 
 
-/*___________________________________________________________________________
+/*____________________________________________________________________________
  |
- | receivebits - decode number from buf using specified number of bits
+ | XtcBitReader - decode numbers written by sendbits() and sendints()
  |
- | extract the number of bits from the array buf and construct an integer
- | from it. Return that value.
+ | The reader keeps up to 64 bits of the compressed stream in a word buffer,
+ | so each byte of the input is loaded once instead of once per extracted
+ | bit field. Reads past the end of the data return zero bits.
  |
  */
 
-static int receivebits(int buf[], int num_of_bits)
+namespace
 {
 
-    int            cnt, num, lastbits;
-    unsigned int   lastbyte;
-    unsigned char* cbuf;
-    int            mask = (1 << num_of_bits) - 1;
+class XtcBitReader
+{
+public:
+    XtcBitReader(const unsigned char* data, size_t size) :
+        data_(data),
+        size_(size),
+        pos_(0),
+        buffer_(0),
+        bitsInBuffer_(0)
+    {
+    }
 
-    cbuf     = reinterpret_cast<unsigned char*>(buf) + 3 * sizeof(*buf);
-    cnt      = buf[0];
-    lastbits = static_cast<unsigned int>(buf[1]);
-    lastbyte = static_cast<unsigned int>(buf[2]);
+    //! Return the next \p numBits (at most 32) bits as an unsigned integer.
+    unsigned int readBits(int numBits)
+    {
+        if (bitsInBuffer_ < numBits)
+        {
+            refill();
+        }
+        bitsInBuffer_ -= numBits;
+        return static_cast<unsigned int>((buffer_ >> bitsInBuffer_) & ((uint64_t(1) << numBits) - 1));
+    }
 
-    num = 0;
-    while (num_of_bits >= 8)
+    /*! \brief Return the next \p numBits (at most 64) bits stored as
+     * little-endian bytes, as sent by sendints() */
+    uint64_t readLittleEndianBytes(int numBits)
     {
-        lastbyte = (lastbyte << 8) | cbuf[cnt++];
-        num |= (lastbyte >> lastbits) << (num_of_bits - 8);
-        num_of_bits -= 8;
+        uint64_t value = 0;
+        int      shift = 0;
+        while (numBits > 8)
+        {
+            value |= static_cast<uint64_t>(readBits(8)) << shift;
+            shift += 8;
+            numBits -= 8;
+        }
+        if (numBits > 0)
+        {
+            value |= static_cast<uint64_t>(readBits(numBits)) << shift;
+        }
+        return value;
     }
-    if (num_of_bits > 0)
+
+private:
+    void refill()
     {
-        if (lastbits < num_of_bits)
+        while (bitsInBuffer_ <= 56)
         {
-            lastbits += 8;
-            lastbyte = (lastbyte << 8) | cbuf[cnt++];
+            buffer_ = (buffer_ << 8) | (pos_ < size_ ? data_[pos_] : 0U);
+            pos_++;
+            bitsInBuffer_ += 8;
         }
-        lastbits -= num_of_bits;
-        num |= (lastbyte >> lastbits) & ((1 << num_of_bits) - 1);
     }
-    num &= mask;
-    buf[0] = cnt;
-    buf[1] = lastbits;
-    buf[2] = lastbyte;
-    return num;
-}
 
-/*____________________________________________________________________________
- |
- | receiveints - decode 'small' integers from the buf array
- |
- | this routine is the inverse from sendints() and decodes the small integers
- | written to buf by calculating the remainder and doing divisions with
- | the given sizes[]. You need to specify the total number of bits to be
- | used from buf in num_of_bits.
- |
+    const unsigned char* data_;
+    size_t               size_;
+    size_t               pos_;
+    uint64_t             buffer_;
+    int                  bitsInBuffer_;
+};
+
+/*! \brief Largest small-integer index decoded through a lookup table
+ *
+ * The table for index \c i has 2^i entries, so the tables up to index 12
+ * take 7680 entries in total.
  */
+constexpr int c_lastTableIdx = 12;
+
+/*! \brief Lookup tables for decoding three small integers
+ *
+ * For each index up to c_lastTableIdx, entry \c v holds the three
+ * integers that sendints() packed into the bit pattern \c v.
+ */
+class SmallIntDecodeTable
+{
+public:
+    SmallIntDecodeTable() : offset_(c_lastTableIdx + 1, 0)
+    {
+        size_t total = 0;
+        for (int idx = FIRSTIDX; idx <= c_lastTableIdx; idx++)
+        {
+            offset_[idx] = total;
+            total += size_t(1) << idx;
+        }
+        entries_.resize(total);
+        for (int idx = FIRSTIDX; idx <= c_lastTableIdx; idx++)
+        {
+            const unsigned int size = magicints[idx];
+            for (unsigned int v = 0; v < (1U << idx); v++)
+            {
+                std::array<unsigned char, 4>& entry = entries_[offset_[idx] + v];
+                entry[2]                            = v % size;
+                entry[1]                            = (v / size) % size;
+                entry[0]                            = v / (size * size);
+                entry[3]                            = 0;
+            }
+        }
+    }
+
+    //! Return the table for index \p idx, FIRSTIDX <= idx <= c_lastTableIdx.
+    const std::array<unsigned char, 4>* table(int idx) const { return &entries_[offset_[idx]]; }
+
+private:
+    std::vector<size_t>                       offset_;
+    std::vector<std::array<unsigned char, 4>> entries_;
+};
 
-static void receiveints(int buf[], const int num_of_ints, int num_of_bits, const unsigned int sizes[], int nums[])
+const SmallIntDecodeTable& smallIntDecodeTable()
+{
+    static const SmallIntDecodeTable table;
+    return table;
+}
+
+/*! \brief Decode three integers packed by sendints() with \p num_of_bits bits
+ *
+ * This is the inverse of sendints(). When all bits fit in a 64-bit word
+ * the integers are extracted with two word divisions instead of byte-wise
+ * long division.
+ */
+void readInts(XtcBitReader* reader, int num_of_bits, const unsigned int sizes[], int nums[])
 {
+    if (num_of_bits <= 64)
+    {
+        uint64_t value = reader->readLittleEndianBytes(num_of_bits);
+        nums[2]        = static_cast<int>(value % sizes[2]);
+        value /= sizes[2];
+        nums[1] = static_cast<int>(value % sizes[1]);
+        value /= sizes[1];
+        nums[0] = static_cast<int>(static_cast<unsigned int>(value));
+        return;
+    }
+
     int bytes[32];
-    int i, j, num_of_bytes, p, num;
+    int num_of_bytes = 0;
 
     bytes[0] = bytes[1] = bytes[2] = bytes[3] = 0;
-    num_of_bytes                              = 0;
     while (num_of_bits > 8)
     {
-        bytes[num_of_bytes++] = receivebits(buf, 8);
+        bytes[num_of_bytes++] = reader->readBits(8);
         num_of_bits -= 8;
     }
     if (num_of_bits > 0)
     {
-        bytes[num_of_bytes++] = receivebits(buf, num_of_bits);
+        bytes[num_of_bytes++] = reader->readBits(num_of_bits);
     }
-    for (i = num_of_ints - 1; i > 0; i--)
+    for (int i = 2; i > 0; i--)
     {
-        num = 0;
-        for (j = num_of_bytes - 1; j >= 0; j--)
+        int num = 0;
+        for (int j = num_of_bytes - 1; j >= 0; j--)
         {
             num      = (num << 8) | bytes[j];
-            p        = num / sizes[i];
+            int p    = num / sizes[i];
             bytes[j] = p;
             num      = num - p * sizes[i];
         }
@@ -361,6 +447,226 @@ static void receiveints(int buf[], const int num_of_ints, int num_of_bits, const
     nums[0] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24);
 }
 
+//! Decode three small integers of \p smallidx bits, using a lookup table when possible.
+void readSmallInts(XtcBitReader* reader, int smallidx, const unsigned int sizesmall[], int nums[])
+{
+    if (smallidx <= c_lastTableIdx)
+    {
+        const std::array<unsigned char, 4>& entry =
+                smallIntDecodeTable().table(smallidx)[reader->readLittleEndianBytes(smallidx)];
+        nums[0] = entry[0];
+        nums[1] = entry[1];
+        nums[2] = entry[2];
+    }
+    else
+    {
+        readInts(reader, smallidx, sizesmall, nums);
+    }
+}
+
+} // namespace
+
+int xdr3dfcoord_read_compressed(XDR* xdrs, XtcCompressedCoords* coords, int* size)
+{
+    int lsize;
+    int byteCount;
+
+    if (xdr_int(xdrs, &lsize) == 0)
+    {
+        return 0;
+    }
+    if (*size != 0 && lsize != *size)
+    {
+        fprintf(stderr,
+                "wrong number of coordinates in xdr3dfcoord; "
+                "%d arg vs %d in file",
+                *size, lsize);
+    }
+    *size          = lsize;
+    coords->natoms = lsize;
+    if (lsize <= 9)
+    {
+        coords->precision = -1;
+        coords->uncompressed.resize(std::max(3 * lsize, 0));
+        return (xdr_vector(xdrs, reinterpret_cast<char*>(coords->uncompressed.data()),
+                           static_cast<unsigned int>(coords->uncompressed.size()),
+                           static_cast<unsigned int>(sizeof(float)),
+                           reinterpret_cast<xdrproc_t>(xdr_float)));
+    }
+    if (xdr_float(xdrs, &coords->precision) == 0)
+    {
+        return 0;
+    }
+    if ((xdr_int(xdrs, &(coords->minint[0])) == 0) || (xdr_int(xdrs, &(coords->minint[1])) == 0)
+        || (xdr_int(xdrs, &(coords->minint[2])) == 0) || (xdr_int(xdrs, &(coords->maxint[0])) == 0)
+        || (xdr_int(xdrs, &(coords->maxint[1])) == 0) || (xdr_int(xdrs, &(coords->maxint[2])) == 0))
+    {
+        return 0;
+    }
+    if (xdr_int(xdrs, &coords->smallidx) == 0)
+    {
+        return 0;
+    }
+    /* the length of the bit stream in bytes */
+    if (xdr_int(xdrs, &byteCount) == 0 || byteCount < 0)
+    {
+        return 0;
+    }
+    coords->bytes.resize(byteCount);
+
+    return xdr_opaque(xdrs, reinterpret_cast<char*>(coords->bytes.data()),
+                      static_cast<unsigned int>(byteCount));
+}
+
+int xdr3dfcoord_decompress(const XtcCompressedCoords& coords, float* fp)
+{
+    const int lsize = coords.natoms;
+
+    if (lsize <= 9)
+    {
+        std::copy(coords.uncompressed.begin(), coords.uncompressed.end(), fp);
+        return 1;
+    }
+
+    int smallidx = coords.smallidx;
+    if (smallidx < FIRSTIDX || smallidx >= LASTIDX)
+    {
+        return 0;
+    }
+
+    unsigned int sizeint[3], sizesmall[3], bitsizeint[3];
+    unsigned int bitsize;
+
+    sizeint[0] = coords.maxint[0] - coords.minint[0] + 1;
+    sizeint[1] = coords.maxint[1] - coords.minint[1] + 1;
+    sizeint[2] = coords.maxint[2] - coords.minint[2] + 1;
+
+    /* check if one of the sizes is to big to be multiplied */
+    if ((sizeint[0] | sizeint[1] | sizeint[2]) > 0xffffff)
+    {
+        bitsizeint[0] = sizeofint(sizeint[0]);
+        bitsizeint[1] = sizeofint(sizeint[1]);
+        bitsizeint[2] = sizeofint(sizeint[2]);
+        bitsize       = 0; /* flag the use of large sizes */
+    }
+    else
+    {
+        bitsizeint[0] = bitsizeint[1] = bitsizeint[2] = 0;
+        bitsize                                       = sizeofints(3, sizeint);
+    }
+
+    int smaller  = magicints[std::max(FIRSTIDX, smallidx - 1)] / 2;
+    int smallnum = magicints[smallidx] / 2;
+    sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
+
+    XtcBitReader reader(coords.bytes.data(), coords.bytes.size());
+
+    const float inv_precision = 1.0 / coords.precision;
+    float*      lfp           = fp;
+    int         run           = 0;
+    int         i             = 0;
+    int         thiscoord[3], prevcoord[3];
+    while (i < lsize)
+    {
+        if (bitsize == 0)
+        {
+            thiscoord[0] = reader.readBits(bitsizeint[0]);
+            thiscoord[1] = reader.readBits(bitsizeint[1]);
+            thiscoord[2] = reader.readBits(bitsizeint[2]);
+        }
+        else
+        {
+            readInts(&reader, bitsize, sizeint, thiscoord);
+        }
+
+        i++;
+        thiscoord[0] += coords.minint[0];
+        thiscoord[1] += coords.minint[1];
+        thiscoord[2] += coords.minint[2];
+
+        prevcoord[0] = thiscoord[0];
+        prevcoord[1] = thiscoord[1];
+        prevcoord[2] = thiscoord[2];
+
+        int is_smaller = 0;
+        if (reader.readBits(1) == 1)
+        {
+            run        = reader.readBits(5);
+            is_smaller = run % 3;
+            run -= is_smaller;
+            is_smaller--;
+        }
+        if (run > 0)
+        {
+            if (i + run / 3 > lsize)
+            {
+                /* corrupted frame, do not write past the end of fp */
+                return 0;
+            }
+            for (int k = 0; k < run; k += 3)
+            {
+                readSmallInts(&reader, smallidx, sizesmall, thiscoord);
+                i++;
+                thiscoord[0] += prevcoord[0] - smallnum;
+                thiscoord[1] += prevcoord[1] - smallnum;
+                thiscoord[2] += prevcoord[2] - smallnum;
+                if (k == 0)
+                {
+                    /* interchange first with second atom for better
+                     * compression of water molecules
+                     */
+                    std::swap(thiscoord[0], prevcoord[0]);
+                    std::swap(thiscoord[1], prevcoord[1]);
+                    std::swap(thiscoord[2], prevcoord[2]);
+                    *lfp++ = prevcoord[0] * inv_precision;
+                    *lfp++ = prevcoord[1] * inv_precision;
+                    *lfp++ = prevcoord[2] * inv_precision;
+                }
+                else
+                {
+                    prevcoord[0] = thiscoord[0];
+                    prevcoord[1] = thiscoord[1];
+                    prevcoord[2] = thiscoord[2];
+                }
+                *lfp++ = thiscoord[0] * inv_precision;
+                *lfp++ = thiscoord[1] * inv_precision;
+                *lfp++ = thiscoord[2] * inv_precision;
+            }
+        }
+        else
+        {
+            *lfp++ = thiscoord[0] * inv_precision;
+            *lfp++ = thiscoord[1] * inv_precision;
+            *lfp++ = thiscoord[2] * inv_precision;
+        }
+        smallidx += is_smaller;
+        if (smallidx < FIRSTIDX || smallidx >= LASTIDX)
+        {
+            /* corrupted frame */
+            return 0;
+        }
+        if (is_smaller < 0)
+        {
+            smallnum = smaller;
+            if (smallidx > FIRSTIDX)
+            {
+                smaller = magicints[smallidx - 1] / 2;
+            }
+            else
+            {
+                smaller = 0;
+            }
+        }
+        else if (is_smaller > 0)
+        {
+            smaller  = smallnum;
+            smallnum = magicints[smallidx] / 2;
+        }
+        sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
+    }
+    return 1;
+}
+
 /*____________________________________________________________________________
  |
  | xdr3dfcoord - read or write compressed 3d coordinates to xdr file.
@@ -389,6 +695,13 @@ static void receiveints(int buf[], const int num_of_ints, int num_of_bits, const
  */
 
 int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
+{
+    XtcCompressedCoords coords;
+
+    return xdr3dfcoord(xdrs, fp, size, precision, &coords);
+}
+
+int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision, XtcCompressedCoords* buffer)
 {
     int*     ip  = nullptr;
     int*     buf = nullptr;
@@ -404,15 +717,14 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
     int          lint1, lint2, lint3, oldlint1, oldlint2, oldlint3, smallidx;
     int          minidx, maxidx;
     unsigned     sizeint[3], sizesmall[3], bitsizeint[3], size3, *luip;
-    int          flag, k;
+    int          k;
     int          smallnum, smaller, larger, i, is_small, is_smaller, run, prevrun;
     float *      lfp, lf;
     int          tmp, *thiscoord, prevcoord[3];
     unsigned int tmpcoord[30];
 
-    int          bufsize, lsize;
+    int          bufsize;
     unsigned int bitsize;
-    float        inv_precision;
     int          errval = 1;
     int          rc;
 
@@ -768,236 +1080,15 @@ int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision)
         }
         return rc;
     }
-    else
-    {
-
-        /* xdrs is open for reading */
-
-        if (xdr_int(xdrs, &lsize) == 0)
-        {
-            return 0;
-        }
-        if (*size != 0 && lsize != *size)
-        {
-            fprintf(stderr,
-                    "wrong number of coordinates in xdr3dfcoord; "
-                    "%d arg vs %d in file",
-                    *size, lsize);
-        }
-        *size = lsize;
-        size3 = *size * 3;
-        if (*size <= 9)
-        {
-            *precision = -1;
-            return (xdr_vector(xdrs, reinterpret_cast<char*>(fp), static_cast<unsigned int>(size3),
-                               static_cast<unsigned int>(sizeof(*fp)),
-                               reinterpret_cast<xdrproc_t>(xdr_float)));
-        }
-        if (xdr_float(xdrs, precision) == 0)
-        {
-            return 0;
-        }
-
-        if (size3 <= prealloc_size)
-        {
-            ip  = prealloc_ip;
-            buf = prealloc_buf;
-        }
-        else
-        {
-            we_should_free = 1;
-            bufsize        = static_cast<int>(size3 * 1.2);
-            ip             = reinterpret_cast<int*>(malloc(size3 * sizeof(*ip)));
-            buf            = reinterpret_cast<int*>(malloc(bufsize * sizeof(*buf)));
-            if (ip == nullptr || buf == nullptr)
-            {
-                fprintf(stderr, "malloc failed\n");
-                exit(1);
-            }
-        }
-
-        buf[0] = buf[1] = buf[2] = 0;
-
-        if ((xdr_int(xdrs, &(minint[0])) == 0) || (xdr_int(xdrs, &(minint[1])) == 0)
-            || (xdr_int(xdrs, &(minint[2])) == 0) || (xdr_int(xdrs, &(maxint[0])) == 0)
-            || (xdr_int(xdrs, &(maxint[1])) == 0) || (xdr_int(xdrs, &(maxint[2])) == 0))
-        {
-            if (we_should_free)
-            {
-                free(ip);
-                free(buf);
-            }
-            return 0;
-        }
 
-        sizeint[0] = maxint[0] - minint[0] + 1;
-        sizeint[1] = maxint[1] - minint[1] + 1;
-        sizeint[2] = maxint[2] - minint[2] + 1;
-
-        /* check if one of the sizes is to big to be multiplied */
-        if ((sizeint[0] | sizeint[1] | sizeint[2]) > 0xffffff)
-        {
-            bitsizeint[0] = sizeofint(sizeint[0]);
-            bitsizeint[1] = sizeofint(sizeint[1]);
-            bitsizeint[2] = sizeofint(sizeint[2]);
-            bitsize       = 0; /* flag the use of large sizes */
-        }
-        else
-        {
-            bitsize = sizeofints(3, sizeint);
-        }
-
-        if (xdr_int(xdrs, &smallidx) == 0)
-        {
-            if (we_should_free)
-            {
-                free(ip);
-                free(buf);
-            }
-            return 0;
-        }
-
-        smaller      = magicints[std::max(FIRSTIDX, smallidx - 1)] / 2;
-        smallnum     = magicints[smallidx] / 2;
-        sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
-
-        /* buf[0] holds the length in bytes */
-
-        if (xdr_int(xdrs, &(buf[0])) == 0)
-        {
-            if (we_should_free)
-            {
-                free(ip);
-                free(buf);
-            }
-            return 0;
-        }
-
-
-        if (xdr_opaque(xdrs, reinterpret_cast<char*>(&(buf[3])), static_cast<unsigned int>(buf[0])) == 0)
-        {
-            if (we_should_free)
-            {
-                free(ip);
-                free(buf);
-            }
-            return 0;
-        }
-
-
-        buf[0] = buf[1] = buf[2] = 0;
-
-        lfp           = fp;
-        inv_precision = 1.0 / *precision;
-        run           = 0;
-        i             = 0;
-        lip           = ip;
-        while (i < lsize)
-        {
-            thiscoord = reinterpret_cast<int*>(lip) + i * 3;
-
-            if (bitsize == 0)
-            {
-                thiscoord[0] = receivebits(buf, bitsizeint[0]);
-                thiscoord[1] = receivebits(buf, bitsizeint[1]);
-                thiscoord[2] = receivebits(buf, bitsizeint[2]);
-            }
-            else
-            {
-                receiveints(buf, 3, bitsize, sizeint, thiscoord);
-            }
-
-            i++;
-            thiscoord[0] += minint[0];
-            thiscoord[1] += minint[1];
-            thiscoord[2] += minint[2];
-
-            prevcoord[0] = thiscoord[0];
-            prevcoord[1] = thiscoord[1];
-            prevcoord[2] = thiscoord[2];
-
-
-            flag       = receivebits(buf, 1);
-            is_smaller = 0;
-            if (flag == 1)
-            {
-                run        = receivebits(buf, 5);
-                is_smaller = run % 3;
-                run -= is_smaller;
-                is_smaller--;
-            }
-            if (run > 0)
-            {
-                thiscoord += 3;
-                for (k = 0; k < run; k += 3)
-                {
-                    receiveints(buf, 3, smallidx, sizesmall, thiscoord);
-                    i++;
-                    thiscoord[0] += prevcoord[0] - smallnum;
-                    thiscoord[1] += prevcoord[1] - smallnum;
-                    thiscoord[2] += prevcoord[2] - smallnum;
-                    if (k == 0)
-                    {
-                        /* interchange first with second atom for better
-                         * compression of water molecules
-                         */
-                        tmp          = thiscoord[0];
-                        thiscoord[0] = prevcoord[0];
-                        prevcoord[0] = tmp;
-                        tmp          = thiscoord[1];
-                        thiscoord[1] = prevcoord[1];
-                        prevcoord[1] = tmp;
-                        tmp          = thiscoord[2];
-                        thiscoord[2] = prevcoord[2];
-                        prevcoord[2] = tmp;
-                        *lfp++       = prevcoord[0] * inv_precision;
-                        *lfp++       = prevcoord[1] * inv_precision;
-                        *lfp++       = prevcoord[2] * inv_precision;
-                    }
-                    else
-                    {
-                        prevcoord[0] = thiscoord[0];
-                        prevcoord[1] = thiscoord[1];
-                        prevcoord[2] = thiscoord[2];
-                    }
-                    *lfp++ = thiscoord[0] * inv_precision;
-                    *lfp++ = thiscoord[1] * inv_precision;
-                    *lfp++ = thiscoord[2] * inv_precision;
-                }
-            }
-            else
-            {
-                *lfp++ = thiscoord[0] * inv_precision;
-                *lfp++ = thiscoord[1] * inv_precision;
-                *lfp++ = thiscoord[2] * inv_precision;
-            }
-            smallidx += is_smaller;
-            if (is_smaller < 0)
-            {
-                smallnum = smaller;
-                if (smallidx > FIRSTIDX)
-                {
-                    smaller = magicints[smallidx - 1] / 2;
-                }
-                else
-                {
-                    smaller = 0;
-                }
-            }
-            else if (is_smaller > 0)
-            {
-                smaller  = smallnum;
-                smallnum = magicints[smallidx] / 2;
-            }
-            sizesmall[0] = sizesmall[1] = sizesmall[2] = magicints[smallidx];
-        }
-    }
-    if (we_should_free)
+    /* xdrs is open for reading */
+    if (xdr3dfcoord_read_compressed(xdrs, buffer, size) == 0)
     {
-        free(ip);
-        free(buf);
+        return 0;
     }
-    return 1;
+    *precision = buffer->precision;
+
+    return xdr3dfcoord_decompress(*buffer, fp);
 }
 
 
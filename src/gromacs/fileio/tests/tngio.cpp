@@ -43,10 +43,16 @@
 
 #include "gromacs/fileio/tngio.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/path.h"
 
 #include "testutils/simulationdatabase.h"
@@ -75,4 +81,221 @@ TEST_F(TngTest, CloseBeforeOpenIsNotFatal)
     gmx_tng_close(&tng);
 }
 
+//! Returns the path to a TNG trajectory that, unlike the one in this directory, contains frames.
+std::string trajectoryWithFrames()
+{
+    return gmx::Path::join(gmx::test::TestFileManager::getTestSimulationDatabaseDirectory(),
+                           "spc2-traj.tng");
+}
+
+//! Reads all frames of \p input after \p first into \p frames, using a prefetcher when requested.
+void readRemainingFrames(gmx_tng_trajectory_t     input,
+                         const t_trxframe&        first,
+                         bool                     usePrefetcher,
+                         std::vector<t_trxframe>* frames)
+{
+    std::unique_ptr<gmx::TngFramePrefetcher> prefetcher;
+    if (usePrefetcher)
+    {
+        prefetcher = std::make_unique<gmx::TngFramePrefetcher>(input, first.step);
+    }
+    t_trxframe frame = first;
+    frame.x          = nullptr;
+    frame.v          = nullptr;
+    frame.f          = nullptr;
+    while (prefetcher ? prefetcher->readNextFrame(&frame)
+                      : gmx_read_next_tng_frame(input, &frame, nullptr, 0))
+    {
+        frames->push_back(frame);
+        frame.x = nullptr;
+        frame.v = nullptr;
+        frame.f = nullptr;
+    }
+    done_frame(&frame);
+}
+
+//! Compares the contents of two lists of frames.
+void compareFrames(const std::vector<t_trxframe>& reference, const std::vector<t_trxframe>& frames)
+{
+    ASSERT_EQ(reference.size(), frames.size());
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        EXPECT_EQ(reference[i].step, frames[i].step);
+        EXPECT_EQ(reference[i].time, frames[i].time);
+        ASSERT_EQ(reference[i].bX, frames[i].bX);
+        ASSERT_EQ(reference[i].natoms, frames[i].natoms);
+        for (int a = 0; reference[i].bX && a < reference[i].natoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(reference[i].x[a][d], frames[i].x[a][d]);
+            }
+        }
+    }
+}
+
+//! Frees the frames in \p frames.
+void freeFrames(std::vector<t_trxframe>* frames)
+{
+    for (t_trxframe& frame : *frames)
+    {
+        done_frame(&frame);
+    }
+}
+
+TEST_F(TngTest, PrefetcherReadsSameFramesAsDirectReading)
+{
+    std::vector<t_trxframe> reference, prefetched;
+    for (bool usePrefetcher : { false, true })
+    {
+        gmx_tng_trajectory_t tng;
+        gmx_tng_open(trajectoryWithFrames().c_str(), 'r', &tng);
+        t_trxframe first;
+        clear_trxframe(&first, TRUE);
+        first.step = -1;
+        ASSERT_TRUE(gmx_read_next_tng_frame(tng, &first, nullptr, 0));
+        readRemainingFrames(tng, first, usePrefetcher, usePrefetcher ? &prefetched : &reference);
+        done_frame(&first);
+        gmx_tng_close(&tng);
+    }
+    EXPECT_FALSE(reference.empty());
+    compareFrames(reference, prefetched);
+    freeFrames(&reference);
+    freeFrames(&prefetched);
+}
+
+TEST_F(TngTest, BackgroundWritingWritesSameFrames)
+{
+    std::vector<t_trxframe> frames[2];
+    for (bool useBackgroundWriting : { false, true })
+    {
+        const std::string filename = fileManager_.getTemporaryFilePath(
+                useBackgroundWriting ? "background.tng" : "direct.tng");
+
+        gmx_tng_trajectory_t input;
+        gmx_tng_open(trajectoryWithFrames().c_str(), 'r', &input);
+        t_trxframe frame;
+        clear_trxframe(&frame, TRUE);
+        frame.step = -1;
+        ASSERT_TRUE(gmx_read_next_tng_frame(input, &frame, nullptr, 0));
+
+        gmx_tng_trajectory_t output;
+        gmx_prepare_tng_writing(filename.c_str(), 'w', &input, &output, frame.natoms, nullptr, {},
+                                nullptr);
+        if (useBackgroundWriting)
+        {
+            gmx_tng_start_background_writing(output);
+        }
+        do
+        {
+            gmx_tng_set_compression_precision(output, 1000);
+            gmx_write_tng_from_trxframe(output, &frame, -1);
+        } while (gmx_read_next_tng_frame(input, &frame, nullptr, 0));
+        done_frame(&frame);
+        gmx_tng_close(&output);
+        gmx_tng_close(&input);
+
+        gmx_tng_open(filename.c_str(), 'r', &input);
+        clear_trxframe(&frame, TRUE);
+        frame.step = -1;
+        ASSERT_TRUE(gmx_read_next_tng_frame(input, &frame, nullptr, 0));
+        frames[useBackgroundWriting].push_back(frame);
+        readRemainingFrames(input, frame, false, &frames[useBackgroundWriting]);
+        gmx_tng_close(&input);
+    }
+    EXPECT_FALSE(frames[0].empty());
+    compareFrames(frames[0], frames[1]);
+    freeFrames(&frames[0]);
+    freeFrames(&frames[1]);
+}
+
+TEST_F(TngTest, AddsImplicitParticlesToThoseCopiedFromInput)
+{
+    /* Without a topology, all particles written to this file are implicit */
+    const std::string implicitFilename = fileManager_.getTemporaryFilePath("implicit.tng");
+    const std::string doubledFilename  = fileManager_.getTemporaryFilePath("doubled.tng");
+
+    gmx_tng_trajectory_t input;
+    gmx_tng_open(trajectoryWithFrames().c_str(), 'r', &input);
+    t_trxframe frame;
+    clear_trxframe(&frame, TRUE);
+    frame.step = -1;
+    ASSERT_TRUE(gmx_read_next_tng_frame(input, &frame, nullptr, 0));
+    const int            natoms = frame.natoms;
+    gmx_tng_trajectory_t output;
+    gmx_prepare_tng_writing(implicitFilename.c_str(), 'w', nullptr, &output, natoms, nullptr, {},
+                            nullptr);
+    do
+    {
+        gmx_tng_set_compression_precision(output, 1000);
+        gmx_write_tng_from_trxframe(output, &frame, -1);
+    } while (gmx_read_next_tng_frame(input, &frame, nullptr, 0));
+    done_frame(&frame);
+    gmx_tng_close(&output);
+    gmx_tng_close(&input);
+
+    /* Write each frame twice over into a file with twice as many atoms,
+     * which needs implicit particles beyond those copied from the input */
+    std::vector<t_trxframe> reference;
+    gmx_tng_open(implicitFilename.c_str(), 'r', &input);
+    clear_trxframe(&frame, TRUE);
+    frame.step = -1;
+    ASSERT_TRUE(gmx_read_next_tng_frame(input, &frame, nullptr, 0));
+    reference.push_back(frame);
+    readRemainingFrames(input, frame, false, &reference);
+    gmx_prepare_tng_writing(doubledFilename.c_str(), 'w', &input, &output, 2 * natoms, nullptr, {},
+                            nullptr);
+    for (const t_trxframe& referenceFrame : reference)
+    {
+        std::vector<gmx::RVec> x(2 * natoms), v(2 * natoms), f(2 * natoms);
+        for (int a = 0; a < 2 * natoms; a++)
+        {
+            copy_rvec(referenceFrame.x[a % natoms], x[a]);
+            if (referenceFrame.bV)
+            {
+                copy_rvec(referenceFrame.v[a % natoms], v[a]);
+            }
+            if (referenceFrame.bF)
+            {
+                copy_rvec(referenceFrame.f[a % natoms], f[a]);
+            }
+        }
+        t_trxframe doubledFrame = referenceFrame;
+        doubledFrame.natoms     = 2 * natoms;
+        doubledFrame.x          = as_rvec_array(x.data());
+        doubledFrame.v          = referenceFrame.bV ? as_rvec_array(v.data()) : nullptr;
+        doubledFrame.f          = referenceFrame.bF ? as_rvec_array(f.data()) : nullptr;
+        gmx_tng_set_compression_precision(output, 1000);
+        gmx_write_tng_from_trxframe(output, &doubledFrame, -1);
+    }
+    gmx_tng_close(&output);
+    gmx_tng_close(&input);
+
+    std::vector<t_trxframe> doubled;
+    gmx_tng_open(doubledFilename.c_str(), 'r', &input);
+    clear_trxframe(&frame, TRUE);
+    frame.step = -1;
+    ASSERT_TRUE(gmx_read_next_tng_frame(input, &frame, nullptr, 0));
+    doubled.push_back(frame);
+    readRemainingFrames(input, frame, false, &doubled);
+    gmx_tng_close(&input);
+
+    ASSERT_EQ(reference.size(), doubled.size());
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        EXPECT_EQ(reference[i].step, doubled[i].step);
+        ASSERT_TRUE(doubled[i].bX);
+        ASSERT_EQ(2 * natoms, doubled[i].natoms);
+        for (int a = 0; a < 2 * natoms; a++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(reference[i].x[a % natoms][d], doubled[i].x[a][d]);
+            }
+        }
+    }
+    freeFrames(&reference);
+    freeFrames(&doubled);
+}
+
 } // namespace
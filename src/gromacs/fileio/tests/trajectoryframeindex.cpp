@@ -0,0 +1,227 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the frame index of xtc and trr files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/trajectoryframeindex.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/oenv.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/trxio.h"
+#include "gromacs/fileio/xtcio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/trajectory/trajectoryframe.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/path.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace
+{
+
+class TrajectoryFrameIndexTest : public ::testing::Test
+{
+public:
+    TrajectoryFrameIndexTest() : x_(c_natoms)
+    {
+        clear_mat(box_);
+        box_[XX][XX] = box_[YY][YY] = box_[ZZ][ZZ] = 3;
+        for (int i = 0; i < c_natoms; i++)
+        {
+            x_[i] = { 0.1F * i, 0.2F * (i % 7), 0.3F * (i % 5) };
+        }
+    }
+
+    //! Writes \p nframes frames, with step 10*f and time 0.5*f, to \p filename.
+    void writeXtc(const std::string& filename, int nframes, const char* mode = "w")
+    {
+        t_fileio* fio = open_xtc(filename.c_str(), mode);
+        for (int f = 0; f < nframes; f++)
+        {
+            write_xtc(fio, c_natoms, 10 * f, 0.5 * f, box_, as_rvec_array(x_.data()), 1000);
+        }
+        close_xtc(fio);
+    }
+
+    //! Writes \p nframes frames, with step 10*f and time 0.5*f, to \p filename.
+    void writeTrr(const std::string& filename, int nframes)
+    {
+        t_fileio* fio = gmx_trr_open(filename.c_str(), "w");
+        for (int f = 0; f < nframes; f++)
+        {
+            gmx_trr_write_frame(fio, 10 * f, 0.5 * f, 0, box_, c_natoms, as_rvec_array(x_.data()),
+                                (f % 2 == 0) ? as_rvec_array(x_.data()) : nullptr, nullptr);
+        }
+        gmx_trr_close(fio);
+    }
+
+    //! Checks that \p index describes frames written by writeXtc() or writeTrr().
+    void checkIndex(const gmx::TrajectoryFrameIndex& index, int nframes)
+    {
+        ASSERT_EQ(nframes, index.frameCount());
+        EXPECT_EQ(0, index.frames()[0].offset);
+        for (int f = 0; f < nframes; f++)
+        {
+            EXPECT_EQ(10 * f, index.frames()[f].step);
+            EXPECT_FLOAT_EQ(0.5 * f, index.frames()[f].time);
+            if (f > 0)
+            {
+                EXPECT_GT(index.frames()[f].offset, index.frames()[f - 1].offset);
+            }
+        }
+    }
+
+    static const int           c_natoms = 50;
+    std::vector<gmx::RVec>     x_;
+    matrix                     box_;
+    gmx::test::TestFileManager fileManager_;
+};
+
+TEST_F(TrajectoryFrameIndexTest, IndexesXtcFrames)
+{
+    std::string filename = fileManager_.getTemporaryFilePath("frames.xtc");
+    writeXtc(filename, 7);
+    gmx::TrajectoryFrameIndex index = gmx::buildTrajectoryFrameIndex(filename);
+    checkIndex(index, 7);
+    EXPECT_EQ(3, index.firstFrameAtOrAfter(1.2));
+    EXPECT_EQ(7, index.firstFrameAtOrAfter(100));
+}
+
+TEST_F(TrajectoryFrameIndexTest, IndexesTrrFrames)
+{
+    std::string filename = fileManager_.getTemporaryFilePath("frames.trr");
+    writeTrr(filename, 5);
+    checkIndex(gmx::buildTrajectoryFrameIndex(filename), 5);
+}
+
+TEST_F(TrajectoryFrameIndexTest, OmitsTruncatedFrame)
+{
+    std::string filename = fileManager_.getTemporaryFilePath("complete.xtc");
+    writeXtc(filename, 4);
+    gmx::TrajectoryFrameIndex complete = gmx::buildTrajectoryFrameIndex(filename);
+    ASSERT_EQ(4, complete.frameCount());
+
+    /* Copy the file, cutting the last frame in half */
+    std::string       truncated = fileManager_.getTemporaryFilePath("truncated.xtc");
+    std::vector<char> contents((complete.frames()[3].offset + complete.fileSize()) / 2);
+    std::ifstream(filename, std::ios::binary).read(contents.data(), contents.size());
+    std::ofstream(truncated, std::ios::binary).write(contents.data(), contents.size());
+    checkIndex(gmx::buildTrajectoryFrameIndex(truncated), 3);
+}
+
+TEST_F(TrajectoryFrameIndexTest, ThrowsForUnsupportedFormat)
+{
+    EXPECT_THROW_GMX(gmx::buildTrajectoryFrameIndex("frames.gro"), gmx::InvalidInputError);
+}
+
+TEST_F(TrajectoryFrameIndexTest, WritesAndReadsIndexFile)
+{
+    std::string filename  = fileManager_.getTemporaryFilePath("written.xtc");
+    std::string indexFile = fileManager_.getTemporaryFilePath("written.xtc.frameindex");
+    ASSERT_EQ(indexFile, gmx::trajectoryFrameIndexFileName(filename));
+    writeXtc(filename, 6);
+
+    gmx::TrajectoryFrameIndex built = gmx::buildTrajectoryFrameIndex(filename);
+    gmx::writeTrajectoryFrameIndex(indexFile, built);
+
+    gmx::TrajectoryFrameIndex read;
+    ASSERT_TRUE(gmx::readTrajectoryFrameIndex(indexFile, filename, &read));
+    checkIndex(read, 6);
+    EXPECT_EQ(built.fileSize(), read.fileSize());
+    EXPECT_EQ(built.modificationTime(), read.modificationTime());
+    for (int f = 0; f < 6; f++)
+    {
+        EXPECT_EQ(built.frames()[f].offset, read.frames()[f].offset);
+    }
+}
+
+TEST_F(TrajectoryFrameIndexTest, RebuildsStaleIndexFile)
+{
+    std::string filename  = fileManager_.getTemporaryFilePath("stale.xtc");
+    std::string indexFile = fileManager_.getTemporaryFilePath("stale.xtc.frameindex");
+    ASSERT_EQ(indexFile, gmx::trajectoryFrameIndexFileName(filename));
+    writeXtc(filename, 3);
+    checkIndex(gmx::readOrBuildTrajectoryFrameIndex(filename), 3);
+
+    /* Appending changes the size, which invalidates the index file */
+    writeXtc(filename, 2, "a");
+    gmx::TrajectoryFrameIndex read;
+    EXPECT_FALSE(gmx::readTrajectoryFrameIndex(indexFile, filename, &read));
+    gmx::TrajectoryFrameIndex rebuilt = gmx::readOrBuildTrajectoryFrameIndex(filename);
+    ASSERT_EQ(5, rebuilt.frameCount());
+    EXPECT_TRUE(gmx::readTrajectoryFrameIndex(indexFile, filename, &read));
+    EXPECT_EQ(5, read.frameCount());
+}
+
+TEST_F(TrajectoryFrameIndexTest, SeeksToFrameWithTrxReader)
+{
+    std::string filename  = fileManager_.getTemporaryFilePath("seek.trr");
+    std::string indexFile = fileManager_.getTemporaryFilePath("seek.trr.frameindex");
+    ASSERT_EQ(indexFile, gmx::trajectoryFrameIndexFileName(filename));
+    writeTrr(filename, 6);
+
+    gmx_output_env_t* oenv;
+    output_env_init_default(&oenv);
+    t_trxstatus* status;
+    t_trxframe   fr;
+    ASSERT_TRUE(read_first_frame(oenv, &status, filename.c_str(), &fr, TRX_READ_X));
+    EXPECT_EQ(6, trx_frame_count(status));
+    ASSERT_TRUE(trx_seek_frame(status, 4));
+    ASSERT_TRUE(read_next_frame(oenv, status, &fr));
+    EXPECT_EQ(40, fr.step);
+    ASSERT_TRUE(trx_seek_frame(status, 1));
+    ASSERT_TRUE(read_next_frame(oenv, status, &fr));
+    EXPECT_EQ(10, fr.step);
+    EXPECT_FALSE(trx_seek_frame(status, 6));
+    // Without GMX_TRAJECTORY_INDEX, the index is only kept in memory
+    EXPECT_FALSE(gmx::File::exists(indexFile, gmx::File::returnFalseOnError));
+    close_trx(status);
+    done_frame(&fr);
+    output_env_done(oenv);
+}
+
+} // namespace
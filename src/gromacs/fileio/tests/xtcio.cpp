@@ -0,0 +1,289 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for reading and writing of xtc files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/xtcio.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/random/threefry.h"
+#include "gromacs/random/uniformrealdistribution.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace
+{
+
+//! Returns \p x rounded to \p precision as xtc compression does.
+real quantize(float x, float precision)
+{
+    const float scaled       = x * precision + (x >= 0.0 ? 0.5 : -0.5);
+    const float invPrecision = 1.0 / precision;
+    return static_cast<int>(scaled) * invPrecision;
+}
+
+class XtcTest : public ::testing::Test
+{
+public:
+    /*! \brief Generates water-like frames
+     *
+     * Groups of three atoms are close together, so that the compression
+     * encodes most atoms as small differences. */
+    void generateFrames(int natoms, int nframes, float boxSize, float spread)
+    {
+        gmx::DefaultRandomEngine             rng(1234);
+        gmx::UniformRealDistribution<float> dist;
+
+        natoms_ = natoms;
+        frames_.resize(nframes);
+        for (auto& frame : frames_)
+        {
+            frame.resize(natoms);
+            for (int i = 0; i < natoms; i++)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    if (i % 3 == 0)
+                    {
+                        frame[i][d] = boxSize * dist(rng);
+                    }
+                    else
+                    {
+                        frame[i][d] = frame[i - i % 3][d] + spread * (dist(rng) - 0.5F);
+                    }
+                }
+            }
+        }
+    }
+
+    //! Writes the generated frames to \p filename with \p precision.
+    void writeFrames(const std::string& filename, real precision)
+    {
+        matrix box;
+        clear_mat(box);
+        box[XX][XX] = box[YY][YY] = box[ZZ][ZZ] = 5;
+
+        t_fileio* fio = open_xtc(filename.c_str(), "w");
+        for (size_t f = 0; f < frames_.size(); f++)
+        {
+            ASSERT_EQ(1, write_xtc(fio, natoms_, f, f, box, as_rvec_array(frames_[f].data()), precision));
+        }
+        close_xtc(fio);
+    }
+
+    //! Writes the generated frames to \p filename through a writer thread.
+    void writeFramesWithThread(const std::string& filename, real precision, int maxQueuedFrames)
+    {
+        matrix box;
+        clear_mat(box);
+        box[XX][XX] = box[YY][YY] = box[ZZ][ZZ] = 5;
+
+        t_fileio* fio = open_xtc(filename.c_str(), "w");
+        {
+            gmx::XtcWriterThread writer(fio, maxQueuedFrames);
+            for (size_t f = 0; f < frames_.size(); f++)
+            {
+                ASSERT_TRUE(writer.writeFrame(natoms_, f, f, box, as_rvec_array(frames_[f].data()),
+                                              precision));
+                if (f == frames_.size() / 2)
+                {
+                    ASSERT_TRUE(writer.flush());
+                    /* All frames written so far should have reached the file */
+                    EXPECT_EQ(static_cast<size_t>(gmx_fio_ftell(fio)),
+                              fileContents(filename).size());
+                }
+            }
+        }
+        close_xtc(fio);
+    }
+
+    //! Returns the contents of \p filename.
+    static std::vector<char> fileContents(const std::string& filename)
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        return std::vector<char>(std::istreambuf_iterator<char>(stream),
+                                 std::istreambuf_iterator<char>());
+    }
+
+    //! Checks that \p x matches frame \p f quantized with \p precision.
+    void checkFrame(int f, const rvec* x, real precision)
+    {
+        for (int i = 0; i < natoms_; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                const real expected = (natoms_ <= 9) ? static_cast<float>(frames_[f][i][d])
+                                                     : quantize(frames_[f][i][d], precision);
+                ASSERT_EQ(expected, x[i][d]) << "frame " << f << " atom " << i << " dim " << d;
+            }
+        }
+    }
+
+    //! Reads \p filename serially and checks all frames.
+    void readAndCheckFrames(const std::string& filename, real precision)
+    {
+        t_fileio* fio = open_xtc(filename.c_str(), "r");
+        int       natoms;
+        int64_t   step;
+        real      time, prec;
+        matrix    box;
+        rvec*     x;
+        gmx_bool  bOK;
+
+        ASSERT_EQ(1, read_first_xtc(fio, &natoms, &step, &time, box, &x, &prec, &bOK));
+        ASSERT_EQ(natoms_, natoms);
+        checkFrame(0, x, precision);
+        for (size_t f = 1; f < frames_.size(); f++)
+        {
+            ASSERT_EQ(1, read_next_xtc(fio, natoms, &step, &time, box, x, &prec, &bOK));
+            EXPECT_EQ(static_cast<int64_t>(f), step);
+            checkFrame(f, x, precision);
+        }
+        EXPECT_EQ(0, read_next_xtc(fio, natoms, &step, &time, box, x, &prec, &bOK));
+        sfree(x);
+        close_xtc(fio);
+    }
+
+    //! Reads \p filename with read-ahead and checks all frames.
+    void readAheadAndCheckFrames(const std::string& filename, real precision, int framesAhead)
+    {
+        t_fileio* fio = open_xtc(filename.c_str(), "r");
+        int       natoms;
+        int64_t   step;
+        real      time, prec;
+        matrix    box;
+        rvec*     x;
+        gmx_bool  bOK;
+
+        ASSERT_EQ(1, read_first_xtc(fio, &natoms, &step, &time, box, &x, &prec, &bOK));
+        checkFrame(0, x, precision);
+        {
+            gmx::XtcReadAheadReader reader(fio, framesAhead, 2);
+            for (size_t f = 1; f < frames_.size(); f++)
+            {
+                ASSERT_EQ(1, reader.readNextFrame(natoms, &step, &time, box, x, &prec, &bOK));
+                EXPECT_TRUE(bOK);
+                EXPECT_EQ(static_cast<int64_t>(f), step);
+                EXPECT_EQ(static_cast<real>(f), time);
+                EXPECT_EQ(5, box[XX][XX]);
+                checkFrame(f, x, precision);
+            }
+            EXPECT_EQ(0, reader.readNextFrame(natoms, &step, &time, box, x, &prec, &bOK));
+        }
+        sfree(x);
+        close_xtc(fio);
+    }
+
+    gmx::test::TestFileManager  fileManager_;
+    int                         natoms_ = 0;
+    std::vector<std::vector<gmx::RVec>> frames_;
+};
+
+TEST_F(XtcTest, RoundTripsCompressedCoordinates)
+{
+    std::string filename = fileManager_.getTemporaryFilePath("compressed.xtc");
+    generateFrames(300, 5, 5.0, 0.2);
+    writeFrames(filename, 1000);
+    readAndCheckFrames(filename, 1000);
+}
+
+TEST_F(XtcTest, RoundTripsWithSmallIntegerTable)
+{
+    /* With low precision, the differences within a molecule fit in
+     * the small integer sizes that are decoded through a table.
+     */
+    std::string filename = fileManager_.getTemporaryFilePath("lowprecision.xtc");
+    generateFrames(300, 5, 5.0, 0.1);
+    writeFrames(filename, 50);
+    readAndCheckFrames(filename, 50);
+}
+
+TEST_F(XtcTest, RoundTripsLargeCoordinateRange)
+{
+    /* The coordinate range is too large to combine the three
+     * dimensions into one integer.
+     */
+    std::string filename = fileManager_.getTemporaryFilePath("largerange.xtc");
+    generateFrames(30, 3, 30.0, 0.2);
+    writeFrames(filename, 1e6);
+    readAndCheckFrames(filename, 1e6);
+}
+
+TEST_F(XtcTest, RoundTripsUncompressedSmallFrames)
+{
+    std::string filename = fileManager_.getTemporaryFilePath("small.xtc");
+    generateFrames(6, 3, 5.0, 0.2);
+    writeFrames(filename, 1000);
+    readAndCheckFrames(filename, 1000);
+}
+
+TEST_F(XtcTest, ReadAheadGivesIdenticalFrames)
+{
+    std::string filename = fileManager_.getTemporaryFilePath("readahead.xtc");
+    generateFrames(300, 11, 5.0, 0.2);
+    writeFrames(filename, 1000);
+    readAheadAndCheckFrames(filename, 1000, 1);
+    readAheadAndCheckFrames(filename, 1000, 4);
+    readAheadAndCheckFrames(filename, 1000, 20);
+}
+
+TEST_F(XtcTest, WriterThreadWritesIdenticalFile)
+{
+    std::string serial   = fileManager_.getTemporaryFilePath("serial.xtc");
+    std::string threaded = fileManager_.getTemporaryFilePath("threaded.xtc");
+    generateFrames(300, 9, 5.0, 0.2);
+    writeFrames(serial, 1000);
+    writeFramesWithThread(threaded, 1000, 1);
+    EXPECT_EQ(fileContents(serial), fileContents(threaded));
+    writeFramesWithThread(threaded, 1000, 3);
+    EXPECT_EQ(fileContents(serial), fileContents(threaded));
+    readAndCheckFrames(threaded, 1000);
+}
+
+} // namespace
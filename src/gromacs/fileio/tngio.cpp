@@ -41,8 +41,12 @@
 #include <cmath>
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #if GMX_USE_TNG
@@ -51,12 +55,14 @@
 
 #include "gromacs/math/units.h"
 #include "gromacs/math/utilities.h"
+#include "gromacs/math/vec.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/topology/ifunc.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/trajectory/trajectoryframe.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/baseversion.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
@@ -67,6 +73,8 @@
 
 #if !GMX_USE_TNG
 using tng_trajectory_t = void*;
+#else
+class TngBackgroundWriter;
 #endif
 
 /*! \brief Gromacs Wrapper around tng datatype
@@ -94,8 +102,96 @@ struct gmx_tng_trajectory
     bool             timePerFrameIsSet;    //!< True if we have set the time per frame
     int              boxOutputInterval;    //!< Number of steps between the output of box size
     int              lambdaOutputInterval; //!< Number of steps between the output of lambdas
+#if GMX_USE_TNG
+    //! Writes the frames in a separate thread, nullptr when frames are written directly
+    std::unique_ptr<TngBackgroundWriter> backgroundWriter;
+#endif
 };
 
+#if GMX_USE_TNG
+/*! \brief Compresses and writes TNG frames in a separate thread
+ *
+ * queueFrame() copies the frame into one of a fixed number of buffers,
+ * so memory use is bounded, and the writer thread passes the frames
+ * to the TNG library, which compresses each frame set when it is full.
+ */
+class TngBackgroundWriter
+{
+public:
+    //! A frame that is queued for writing.
+    struct Frame
+    {
+        //! Arguments of gmx_fwrite_tng().
+        bool bUseLossyCompression = false;
+        //! Arguments of gmx_fwrite_tng().
+        int64_t step = 0;
+        //! Arguments of gmx_fwrite_tng().
+        real elapsedPicoSeconds = 0;
+        //! Arguments of gmx_fwrite_tng().
+        real lambda = -1;
+        //! Whether the box should be written.
+        bool haveBox = false;
+        //! Box.
+        matrix box = { { 0 } };
+        //! Number of atoms.
+        int nAtoms = 0;
+        //! Positions, velocities and forces, empty when not written.
+        std::vector<gmx::RVec> x, v, f;
+        //! Compression precision to set before writing, when positive.
+        real precision = -1;
+    };
+
+    TngBackgroundWriter(gmx_tng_trajectory_t gmx_tng, int maxQueuedFrames);
+    //! Writes all queued frames.
+    ~TngBackgroundWriter();
+
+    //! Copies a frame into a buffer and queues it, returns false when an earlier write failed.
+    bool queueFrame(const gmx_bool bUseLossyCompression,
+                    int64_t        step,
+                    real           elapsedPicoSeconds,
+                    real           lambda,
+                    const rvec*    box,
+                    int            nAtoms,
+                    const rvec*    x,
+                    const rvec*    v,
+                    const rvec*    f);
+    //! Sets the compression precision for the frames queued after this call.
+    void setCompressionPrecision(real precision);
+    //! Waits until all queued frames are written, returns false when a write failed.
+    bool waitUntilIdle();
+
+private:
+    //! Writes queued frames until stopped.
+    void run();
+
+    gmx_tng_trajectory_t    gmx_tng_;
+    std::vector<Frame>      frames_;
+    std::deque<int>         queued_;
+    std::vector<int>        available_;
+    real                    pendingPrecision_;
+    bool                    busy_;
+    bool                    stop_;
+    bool                    failed_;
+    std::mutex              mutex_;
+    std::condition_variable frameQueued_;
+    std::condition_variable frameWritten_;
+    std::thread             thread_;
+};
+
+/*! \brief Waits for the frames queued for \p gmx_tng to be written
+ *
+ * Needs to be called before using the TNG handle of a trajectory
+ * that is written in the background.
+ */
+static void waitForBackgroundWriter(gmx_tng_trajectory_t gmx_tng)
+{
+    if (gmx_tng->backgroundWriter && !gmx_tng->backgroundWriter->waitUntilIdle())
+    {
+        gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+    }
+}
+#endif
+
 #if GMX_USE_TNG
 static const char* modeToVerb(char mode)
 {
@@ -202,6 +298,10 @@ void gmx_tng_close(gmx_tng_trajectory_t* gmx_tng)
     }
     tng_trajectory_t* tng = &(*gmx_tng)->tng;
 
+    /* Write all queued frames before closing */
+    waitForBackgroundWriter(*gmx_tng);
+    (*gmx_tng)->backgroundWriter.reset();
+
     if (tng)
     {
         tng_util_trajectory_close(tng);
@@ -731,6 +831,12 @@ static void add_selection_groups(gmx_tng_trajectory_t gmx_tng, const gmx_mtop_t*
 void gmx_tng_set_compression_precision(gmx_tng_trajectory_t gmx_tng, real prec)
 {
 #if GMX_USE_TNG
+    if (gmx_tng->backgroundWriter)
+    {
+        /* Applied by the writer thread, in order with the frames */
+        gmx_tng->backgroundWriter->setCompressionPrecision(prec);
+        return;
+    }
     tng_compression_precision_set(gmx_tng->tng, prec);
 #else
     GMX_UNUSED_VALUE(gmx_tng);
@@ -754,18 +860,22 @@ void gmx_tng_prepare_low_prec_writing(gmx_tng_trajectory_t gmx_tng, const gmx_mt
 #endif
 }
 
-void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
-                    const gmx_bool       bUseLossyCompression,
-                    int64_t              step,
-                    real                 elapsedPicoSeconds,
-                    real                 lambda,
-                    const rvec*          box,
-                    int                  nAtoms,
-                    const rvec*          x,
-                    const rvec*          v,
-                    const rvec*          f)
-{
 #if GMX_USE_TNG
+/*! \brief Writes a frame, see gmx_fwrite_tng()
+ *
+ * Returns false when writing failed.
+ */
+static bool writeTngFrame(gmx_tng_trajectory_t gmx_tng,
+                          const gmx_bool       bUseLossyCompression,
+                          int64_t              step,
+                          real                 elapsedPicoSeconds,
+                          real                 lambda,
+                          const rvec*          box,
+                          int                  nAtoms,
+                          const rvec*          x,
+                          const rvec*          v,
+                          const rvec*          f)
+{
     typedef tng_function_status (*write_data_func_pointer)(
             tng_trajectory_t, const int64_t, const double, const real*, const int64_t,
             const int64_t, const char*, const char, const char);
@@ -778,14 +888,6 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
     int64_t nParticles;
     char    compression;
 
-
-    if (!gmx_tng)
-    {
-        /* This function might get called when the type of the
-           compressed trajectory is actually XTC. So we exit and move
-           on. */
-        return;
-    }
     tng_trajectory_t tng = gmx_tng->tng;
 
     // While the GROMACS interface to this routine specifies 'step', TNG itself
@@ -848,7 +950,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        TNG_TRAJ_POSITIONS, "POSITIONS", TNG_PARTICLE_BLOCK_DATA, compression)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -858,7 +960,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        TNG_TRAJ_VELOCITIES, "VELOCITIES", TNG_PARTICLE_BLOCK_DATA, compression)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -870,7 +972,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        TNG_TRAJ_FORCES, "FORCES", TNG_PARTICLE_BLOCK_DATA, TNG_GZIP_COMPRESSION)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -882,7 +984,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        TNG_TRAJ_BOX_SHAPE, "BOX SHAPE", TNG_NON_PARTICLE_BLOCK_DATA, TNG_GZIP_COMPRESSION)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -894,7 +996,7 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
                        TNG_GMX_LAMBDA, "LAMBDAS", TNG_NON_PARTICLE_BLOCK_DATA, TNG_GZIP_COMPRESSION)
             != TNG_SUCCESS)
         {
-            gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+            return false;
         }
     }
 
@@ -904,6 +1006,193 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
     gmx_tng->lastStep            = step;
     gmx_tng->lastTimeDataIsValid = true;
     gmx_tng->lastTime            = elapsedSeconds;
+
+    return true;
+}
+
+TngBackgroundWriter::TngBackgroundWriter(gmx_tng_trajectory_t gmx_tng, int maxQueuedFrames) :
+    gmx_tng_(gmx_tng),
+    frames_(std::max(maxQueuedFrames, 1)),
+    pendingPrecision_(-1),
+    busy_(false),
+    stop_(false),
+    failed_(false)
+{
+    for (size_t i = 0; i < frames_.size(); i++)
+    {
+        available_.push_back(i);
+    }
+    thread_ = std::thread(&TngBackgroundWriter::run, this);
+}
+
+TngBackgroundWriter::~TngBackgroundWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    frameQueued_.notify_one();
+    thread_.join();
+}
+
+void TngBackgroundWriter::run()
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            frameQueued_.wait(lock, [this] { return stop_ || !queued_.empty(); });
+            if (queued_.empty())
+            {
+                return;
+            }
+            const int index = queued_.front();
+            queued_.pop_front();
+            busy_ = true;
+            lock.unlock();
+
+            const Frame& frame = frames_[index];
+            if (frame.precision > 0)
+            {
+                tng_compression_precision_set(gmx_tng_->tng, frame.precision);
+            }
+            auto rvecs = [](const std::vector<gmx::RVec>& vector) {
+                return vector.empty() ? nullptr : as_rvec_array(vector.data());
+            };
+            const bool bOK = writeTngFrame(gmx_tng_, frame.bUseLossyCompression, frame.step,
+                                           frame.elapsedPicoSeconds, frame.lambda,
+                                           frame.haveBox ? frame.box : nullptr, frame.nAtoms,
+                                           rvecs(frame.x), rvecs(frame.v), rvecs(frame.f));
+
+            lock.lock();
+            busy_   = false;
+            failed_ = failed_ || !bOK;
+            available_.push_back(index);
+            frameWritten_.notify_all();
+        }
+    }
+    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+}
+
+bool TngBackgroundWriter::queueFrame(const gmx_bool bUseLossyCompression,
+                                     int64_t        step,
+                                     real           elapsedPicoSeconds,
+                                     real           lambda,
+                                     const rvec*    box,
+                                     int            nAtoms,
+                                     const rvec*    x,
+                                     const rvec*    v,
+                                     const rvec*    f)
+{
+    int index;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        frameWritten_.wait(lock, [this] { return !available_.empty(); });
+        if (failed_)
+        {
+            return false;
+        }
+        index = available_.back();
+        available_.pop_back();
+    }
+
+    /* The buffer is not accessed by the writer thread until it is queued */
+    Frame& frame               = frames_[index];
+    frame.bUseLossyCompression = bUseLossyCompression;
+    frame.step                 = step;
+    frame.elapsedPicoSeconds   = elapsedPicoSeconds;
+    frame.lambda               = lambda;
+    frame.haveBox              = (box != nullptr);
+    if (box != nullptr)
+    {
+        copy_mat(box, frame.box);
+    }
+    frame.nAtoms = nAtoms;
+    auto copyRvecs = [nAtoms](const rvec* from, std::vector<gmx::RVec>* to) {
+        if (from != nullptr)
+        {
+            to->assign(from, from + nAtoms);
+        }
+        else
+        {
+            to->clear();
+        }
+    };
+    copyRvecs(x, &frame.x);
+    copyRvecs(v, &frame.v);
+    copyRvecs(f, &frame.f);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        frame.precision   = pendingPrecision_;
+        pendingPrecision_ = -1;
+        queued_.push_back(index);
+    }
+    frameQueued_.notify_one();
+
+    return true;
+}
+
+void TngBackgroundWriter::setCompressionPrecision(real precision)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    pendingPrecision_ = precision;
+}
+
+bool TngBackgroundWriter::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    frameWritten_.wait(lock, [this] { return queued_.empty() && !busy_; });
+
+    return !failed_;
+}
+
+#endif
+
+void gmx_tng_start_background_writing(gmx_tng_trajectory_t gmx_tng)
+{
+#if GMX_USE_TNG
+    if (gmx_tng && !gmx_tng->backgroundWriter)
+    {
+        gmx_tng->backgroundWriter = std::make_unique<TngBackgroundWriter>(gmx_tng, 2);
+    }
+#else
+    GMX_UNUSED_VALUE(gmx_tng);
+#endif
+}
+
+void gmx_fwrite_tng(gmx_tng_trajectory_t gmx_tng,
+                    const gmx_bool       bUseLossyCompression,
+                    int64_t              step,
+                    real                 elapsedPicoSeconds,
+                    real                 lambda,
+                    const rvec*          box,
+                    int                  nAtoms,
+                    const rvec*          x,
+                    const rvec*          v,
+                    const rvec*          f)
+{
+#if GMX_USE_TNG
+    if (!gmx_tng)
+    {
+        /* This function might get called when the type of the
+           compressed trajectory is actually XTC. So we exit and move
+           on. */
+        return;
+    }
+    GMX_ASSERT(box || !x, "Need a non-NULL box if positions are written");
+
+    const bool bOK = gmx_tng->backgroundWriter
+                             ? gmx_tng->backgroundWriter->queueFrame(bUseLossyCompression, step,
+                                                                     elapsedPicoSeconds, lambda, box,
+                                                                     nAtoms, x, v, f)
+                             : writeTngFrame(gmx_tng, bUseLossyCompression, step,
+                                             elapsedPicoSeconds, lambda, box, nAtoms, x, v, f);
+    if (!bOK)
+    {
+        gmx_file("Cannot write TNG trajectory frame; maybe you are out of disk space?");
+    }
 #else
     GMX_UNUSED_VALUE(gmx_tng);
     GMX_UNUSED_VALUE(bUseLossyCompression);
@@ -925,6 +1214,7 @@ void fflush_tng(gmx_tng_trajectory_t gmx_tng)
     {
         return;
     }
+    waitForBackgroundWriter(gmx_tng);
     tng_frame_set_premature_write(gmx_tng->tng, TNG_USE_HASH);
 #else
     GMX_UNUSED_VALUE(gmx_tng);
@@ -939,6 +1229,7 @@ float gmx_tng_get_time_of_final_frame(gmx_tng_trajectory_t gmx_tng)
     float            fTime;
     tng_trajectory_t tng = gmx_tng->tng;
 
+    waitForBackgroundWriter(gmx_tng);
     tng_num_frames_get(tng, &nFrames);
     tng_util_time_of_frame_get(tng, nFrames - 1, &time);
 
@@ -990,12 +1281,10 @@ void gmx_prepare_tng_writing(const char*              filename,
          * output tng container based on their respective values int
          * the input tng container */
         double  time, compression_precision;
-        int64_t n_frames_per_frame_set, interval = -1;
+        int64_t n_frames_per_frame_set;
 
         tng_compression_precision_get(*input, &compression_precision);
         tng_compression_precision_set(*output, compression_precision);
-        // TODO make this configurable in a future version
-        char compression_type = TNG_TNG_COMPRESSION;
 
         tng_molecule_system_copy(*input, *output);
 
@@ -1006,7 +1295,46 @@ void gmx_prepare_tng_writing(const char*              filename,
 
         tng_num_frames_per_frame_set_get(*input, &n_frames_per_frame_set);
         tng_num_frames_per_frame_set_set(*output, n_frames_per_frame_set);
+    }
+    else
+    {
+        /* TODO after trjconv is modularized: fix this so the user can
+           change precision when they are doing an operation where
+           this makes sense, and not otherwise.
+
+           char compression = bUseLossyCompression ? TNG_TNG_COMPRESSION : TNG_GZIP_COMPRESSION;
+           gmx_tng_set_compression_precision(*output, ndec2prec(nDecimalsOfPrecision));
+         */
+        gmx_tng_add_mtop(*gmx_tng_output, mtop);
+        tng_num_frames_per_frame_set_set(*output, 1);
+    }
 
+    if ((!index.empty()) && nAtoms > 0)
+    {
+        gmx_tng_setup_atom_subgroup(*gmx_tng_output, index, indexGroupName);
+    }
+
+    /* If for some reason there are more requested atoms than there are atoms in the
+     * molecular system create a number of implicit atoms (without atom data) to
+     * compensate for that. A molecular system copied from the input can already
+     * contain implicit atoms, which TNG would count twice, so remove them first. */
+    if (nAtoms >= 0)
+    {
+        tng_molecule_t implicitMolecule;
+        if (tng_molecule_find(*output, "TNG_IMPLICIT_MOL", -1, &implicitMolecule) == TNG_SUCCESS)
+        {
+            tng_molecule_cnt_set(*output, implicitMolecule, 0);
+        }
+        tng_implicit_num_particles_set(*output, nAtoms);
+    }
+
+    if (input)
+    {
+        /* The data blocks of the writing intervals are sized for the number of
+         * particles, so they are set up only once that number is final. */
+        // TODO make this configurable in a future version
+        char    compression_type = TNG_TNG_COMPRESSION;
+        int64_t interval         = -1;
         for (int i = 0; i < defaultNumIds; i++)
         {
             if (tng_data_get_stride_length(*input, fallbackIds[i], -1, &interval) == TNG_SUCCESS)
@@ -1037,31 +1365,6 @@ void gmx_prepare_tng_writing(const char*              filename,
             }
         }
     }
-    else
-    {
-        /* TODO after trjconv is modularized: fix this so the user can
-           change precision when they are doing an operation where
-           this makes sense, and not otherwise.
-
-           char compression = bUseLossyCompression ? TNG_TNG_COMPRESSION : TNG_GZIP_COMPRESSION;
-           gmx_tng_set_compression_precision(*output, ndec2prec(nDecimalsOfPrecision));
-         */
-        gmx_tng_add_mtop(*gmx_tng_output, mtop);
-        tng_num_frames_per_frame_set_set(*output, 1);
-    }
-
-    if ((!index.empty()) && nAtoms > 0)
-    {
-        gmx_tng_setup_atom_subgroup(*gmx_tng_output, index, indexGroupName);
-    }
-
-    /* If for some reason there are more requested atoms than there are atoms in the
-     * molecular system create a number of implicit atoms (without atom data) to
-     * compensate for that. */
-    if (nAtoms >= 0)
-    {
-        tng_implicit_num_particles_set(*output, nAtoms);
-    }
 #else
     GMX_UNUSED_VALUE(filename);
     GMX_UNUSED_VALUE(mode);
@@ -1767,3 +2070,147 @@ int gmx_tng_get_lambda_output_interval(gmx_tng_trajectory_t gmx_tng)
     return -1;
 #endif
 }
+
+namespace gmx
+{
+
+class TngFramePrefetcher::Impl
+{
+public:
+    Impl(gmx_tng_trajectory_t input, int64_t currentStep);
+    ~Impl();
+
+    //! Reads frames when requested, until stopped.
+    void run();
+    //! Requests the prefetch thread to read the frame after next_.
+    void startPrefetch();
+    //! Waits until the requested frame has been read.
+    void waitForPrefetch();
+
+    //! Trajectory to read from.
+    gmx_tng_trajectory_t input_;
+    //! The prefetched frame, also holds the step to continue reading from.
+    t_trxframe next_;
+    //! Return value of reading next_.
+    gmx_bool nextValid_;
+    //! Whether a frame has been requested and not read yet.
+    bool busy_;
+    //! Whether the prefetch thread should finish.
+    bool stop_;
+    //! Protects busy_ and stop_.
+    std::mutex mutex_;
+    //! Signals changes of busy_ and stop_.
+    std::condition_variable stateChanged_;
+    //! The prefetch thread.
+    std::thread thread_;
+};
+
+TngFramePrefetcher::Impl::Impl(gmx_tng_trajectory_t input, int64_t currentStep) :
+    input_(input),
+    next_(),
+    nextValid_(FALSE),
+    busy_(false),
+    stop_(false)
+{
+    next_.step = currentStep;
+    thread_    = std::thread(&Impl::run, this);
+}
+
+TngFramePrefetcher::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stateChanged_.notify_all();
+    thread_.join();
+    done_frame(&next_);
+}
+
+void TngFramePrefetcher::Impl::run()
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            /* A requested frame is read before stopping */
+            stateChanged_.wait(lock, [this] { return busy_ || stop_; });
+            if (!busy_)
+            {
+                return;
+            }
+            lock.unlock();
+            nextValid_ = gmx_read_next_tng_frame(input_, &next_, nullptr, 0);
+            lock.lock();
+            busy_ = false;
+            stateChanged_.notify_all();
+        }
+    }
+    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+}
+
+void TngFramePrefetcher::Impl::startPrefetch()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        busy_ = true;
+    }
+    stateChanged_.notify_all();
+}
+
+void TngFramePrefetcher::Impl::waitForPrefetch()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    stateChanged_.wait(lock, [this] { return !busy_; });
+}
+
+TngFramePrefetcher::TngFramePrefetcher(gmx_tng_trajectory_t input, int64_t currentStep) :
+    impl_(new Impl(input, currentStep))
+{
+    impl_->startPrefetch();
+}
+
+TngFramePrefetcher::~TngFramePrefetcher() {}
+
+gmx_bool TngFramePrefetcher::readNextFrame(t_trxframe* fr)
+{
+    impl_->waitForPrefetch();
+    if (!impl_->nextValid_)
+    {
+        return FALSE;
+    }
+
+    t_trxframe& next = impl_->next_;
+    fr->natoms       = next.natoms;
+    fr->bStep        = next.bStep;
+    fr->step         = next.step;
+    fr->bTime        = next.bTime;
+    fr->time         = next.time;
+    fr->bLambda      = next.bLambda;
+    fr->lambda       = next.lambda;
+    fr->bAtoms       = FALSE;
+    fr->bPrec        = next.bPrec;
+    fr->prec         = next.prec;
+    fr->bBox         = next.bBox;
+    fr->bX           = next.bX;
+    fr->bV           = next.bV;
+    fr->bF           = next.bF;
+    copy_mat(next.box, fr->box);
+    /* The buffers of fr are reused for reading the following frame */
+    std::swap(fr->x, next.x);
+    std::swap(fr->v, next.v);
+    std::swap(fr->f, next.f);
+
+    /* Decompress the following frame while the caller uses this one */
+    impl_->startPrefetch();
+
+    return TRUE;
+}
+
+void TngFramePrefetcher::waitForPrefetch()
+{
+    impl_->waitForPrefetch();
+}
+
+} // namespace gmx
@@ -41,6 +41,7 @@
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/real.h"
 
 struct gmx_mtop_t;
@@ -120,6 +121,20 @@ void gmx_fwrite_tng(gmx_tng_trajectory_t tng,
                     const rvec*          v,
                     const rvec*          f);
 
+/*! \brief Start writing frames to \p tng in a separate thread
+ *
+ * After this call gmx_fwrite_tng() copies the frame and returns, while
+ * the compression and the file output happen in the writer thread,
+ * in the order the frames were passed. Apart from writing frames, only
+ * gmx_tng_set_compression_precision(), fflush_tng(),
+ * gmx_tng_get_time_of_final_frame(), the output interval getters and
+ * gmx_tng_close() may be called for \p tng; the latter three wait for
+ * the queued frames to be written. Does nothing when \p tng is NULL.
+ *
+ * \param tng Valid handle to a TNG trajectory opened for writing
+ */
+void gmx_tng_start_background_writing(gmx_tng_trajectory_t tng);
+
 /*! \brief Write the current frame set to disk. Perform compression
  * etc.
  *
@@ -203,4 +218,44 @@ int gmx_tng_get_box_output_interval(gmx_tng_trajectory_t gmx_tng);
  * \return The box output interval, or -1 when TNG support is not available. */
 int gmx_tng_get_lambda_output_interval(gmx_tng_trajectory_t gmx_tng);
 
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Reads the next frame of a TNG trajectory in a separate thread.
+ *
+ * Reading a TNG frame is dominated by the decompression of its data
+ * blocks, so the frame after the one returned by readNextFrame() is read
+ * and decompressed by a separate thread while the caller processes the
+ * current frame. The coordinate buffers of the returned frame are exchanged
+ * with those of the prefetched frame, so they must be allocated with
+ * smalloc, and the caller should not hold on to them across frames.
+ *
+ * The trajectory handle must not be used by the caller while the
+ * prefetcher exists, except after waitForPrefetch().
+ */
+class TngFramePrefetcher
+{
+public:
+    //! Starts reading the frame after step \p currentStep, which was already read from \p input.
+    TngFramePrefetcher(gmx_tng_trajectory_t input, int64_t currentStep);
+    ~TngFramePrefetcher();
+
+    /*! \brief
+     * Returns the next frame in \p fr, with the same semantics as
+     * gmx_read_next_tng_frame() without requested block IDs.
+     */
+    gmx_bool readNextFrame(t_trxframe* fr);
+
+    //! Waits until the current read has finished, so \p input may be used.
+    void waitForPrefetch();
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
 #endif /* GMX_FILEIO_TNGIO_H */
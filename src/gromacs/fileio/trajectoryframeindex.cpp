@@ -0,0 +1,345 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements the on-disk index of frames in xtc and trr files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "trajectoryframeindex.h"
+
+#include <cerrno>
+#include <cstdio>
+
+#include <algorithm>
+#include <utility>
+
+#include <sys/stat.h>
+
+#include "gromacs/fileio/filetypes.h"
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/gmxfio_xdr.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/fileio/xdrf.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/futil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Magic number identifying an index file.
+const int c_frameIndexMagic = 0x47584649;
+//! Version of the index file format.
+const int c_frameIndexVersion = 1;
+//! Magic number at the start of each xtc frame.
+const int c_xtcMagic = 1995;
+
+/*! \brief
+ * Returns the size and modification time of \p filename.
+ *
+ * \throws FileIOError if the file can not be accessed.
+ */
+std::pair<int64_t, int64_t> fileSizeAndModificationTime(const std::string& filename)
+{
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0)
+    {
+        GMX_THROW_WITH_ERRNO(FileIOError("Could not access trajectory file " + filename), "stat", errno);
+    }
+    return std::make_pair(static_cast<int64_t>(info.st_size), static_cast<int64_t>(info.st_mtime));
+}
+
+//! Skips \p bytes bytes of \p fp, returns whether that stays within \p fileSize.
+bool skipBytes(FILE* fp, int64_t bytes, int64_t fileSize)
+{
+    const int64_t end = gmx_ftell(fp) + bytes;
+    return end <= fileSize && gmx_fseek(fp, end, SEEK_SET) == 0;
+}
+
+/*! \brief
+ * Appends the frames of the xtc file \p fio to \p frames.
+ *
+ * Reads the frame headers and the sizes of the compressed coordinates,
+ * and skips over the coordinates themselves.
+ */
+void indexXtcFrames(t_fileio* fio, int64_t fileSize, std::vector<TrajectoryFrameIndexEntry>* frames)
+{
+    XDR*  xd = gmx_fio_getxdr(fio);
+    FILE* fp = gmx_fio_getfp(fio);
+
+    while (true)
+    {
+        const int64_t offset = gmx_ftell(fp);
+        int           magic, natoms, step, coordCount;
+        float         time;
+        if (xdr_int(xd, &magic) == 0 || magic != c_xtcMagic || xdr_int(xd, &natoms) == 0
+            || xdr_int(xd, &step) == 0 || xdr_float(xd, &time) == 0)
+        {
+            break;
+        }
+        /* Skip the box */
+        if (!skipBytes(fp, DIM * DIM * 4, fileSize) || xdr_int(xd, &coordCount) == 0)
+        {
+            break;
+        }
+        if (coordCount <= 9)
+        {
+            /* Uncompressed coordinates */
+            if (!skipBytes(fp, DIM * 4 * static_cast<int64_t>(coordCount), fileSize))
+            {
+                break;
+            }
+        }
+        else
+        {
+            /* Skip precision, minimum and maximum integers and the small
+             * index, then the compressed bit stream, padded to 4 bytes */
+            int byteCount;
+            if (!skipBytes(fp, 8 * 4, fileSize) || xdr_int(xd, &byteCount) == 0 || byteCount < 0
+                || !skipBytes(fp, (static_cast<int64_t>(byteCount) + 3) / 4 * 4, fileSize))
+            {
+                break;
+            }
+        }
+        frames->push_back({ offset, step, time });
+    }
+}
+
+//! Appends the frames of the trr file \p fio to \p frames.
+void indexTrrFrames(t_fileio* fio, int64_t fileSize, std::vector<TrajectoryFrameIndexEntry>* frames)
+{
+    while (true)
+    {
+        const int64_t    offset = gmx_fio_ftell(fio);
+        gmx_trr_header_t header;
+        gmx_bool         bOK;
+        if (!gmx_trr_read_frame_header(fio, &header, &bOK) || !bOK)
+        {
+            break;
+        }
+        const int64_t dataSize = static_cast<int64_t>(header.box_size) + header.vir_size
+                                 + header.pres_size + header.x_size + header.v_size + header.f_size;
+        const int64_t end = gmx_fio_ftell(fio) + dataSize;
+        if (end > fileSize || gmx_fio_seek(fio, end) != 0)
+        {
+            break;
+        }
+        frames->push_back({ offset, header.step, header.t });
+    }
+}
+
+} // namespace
+
+TrajectoryFrameIndex::TrajectoryFrameIndex() : fileSize_(-1), modificationTime_(-1) {}
+
+TrajectoryFrameIndex::TrajectoryFrameIndex(int64_t                                fileSize,
+                                           int64_t                                modificationTime,
+                                           std::vector<TrajectoryFrameIndexEntry> frames) :
+    fileSize_(fileSize),
+    modificationTime_(modificationTime),
+    frames_(std::move(frames))
+{
+}
+
+int64_t TrajectoryFrameIndex::firstFrameAtOrAfter(double time) const
+{
+    auto frame = std::lower_bound(
+            frames_.begin(), frames_.end(), time,
+            [](const TrajectoryFrameIndexEntry& entry, double t) { return entry.time < t; });
+    return frame - frames_.begin();
+}
+
+std::string trajectoryFrameIndexFileName(const std::string& trajectoryFile)
+{
+    return trajectoryFile + ".frameindex";
+}
+
+TrajectoryFrameIndex buildTrajectoryFrameIndex(const std::string& trajectoryFile)
+{
+    const int ftp = fn2ftp(trajectoryFile.c_str());
+    if (ftp != efXTC && ftp != efTRR)
+    {
+        GMX_THROW(InvalidInputError("Frame indices are only supported for xtc and trr files, not "
+                                    + trajectoryFile));
+    }
+    const auto fileInfo = fileSizeAndModificationTime(trajectoryFile);
+
+    std::vector<TrajectoryFrameIndexEntry> frames;
+    t_fileio*                              fio = gmx_fio_open(trajectoryFile.c_str(), "r");
+    if (ftp == efXTC)
+    {
+        indexXtcFrames(fio, fileInfo.first, &frames);
+    }
+    else
+    {
+        indexTrrFrames(fio, fileInfo.first, &frames);
+    }
+    gmx_fio_close(fio);
+
+    return TrajectoryFrameIndex(fileInfo.first, fileInfo.second, std::move(frames));
+}
+
+namespace
+{
+
+/*! \brief Writes \p index to the file \p fp opened for writing and closes it
+ *
+ * Returns false when writing fails.
+ */
+bool writeTrajectoryFrameIndexToFile(FILE* fp, const TrajectoryFrameIndex& index)
+{
+    XDR xd;
+    xdrstdio_create(&xd, fp, XDR_ENCODE);
+
+    int     magic    = c_frameIndexMagic;
+    int     version  = c_frameIndexVersion;
+    int64_t fileSize = index.fileSize();
+    int64_t mtime    = index.modificationTime();
+    int64_t count    = index.frameCount();
+    bool    bOK = xdr_int(&xd, &magic) && xdr_int(&xd, &version) && xdr_int64(&xd, &fileSize)
+               && xdr_int64(&xd, &mtime) && xdr_int64(&xd, &count);
+    for (const auto& frame : index.frames())
+    {
+        if (!bOK)
+        {
+            break;
+        }
+        int64_t offset = frame.offset;
+        int64_t step   = frame.step;
+        double  time   = frame.time;
+        bOK = xdr_int64(&xd, &offset) && xdr_int64(&xd, &step) && xdr_double(&xd, &time);
+    }
+    xdr_destroy(&xd);
+    if (std::fclose(fp) != 0)
+    {
+        bOK = false;
+    }
+    return bOK;
+}
+
+} // namespace
+
+void writeTrajectoryFrameIndex(const std::string& indexFile, const TrajectoryFrameIndex& index)
+{
+    FILE* fp = std::fopen(indexFile.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        GMX_THROW_WITH_ERRNO(FileIOError("Could not create frame index file " + indexFile),
+                             "fopen", errno);
+    }
+    if (!writeTrajectoryFrameIndexToFile(fp, index))
+    {
+        std::remove(indexFile.c_str());
+        GMX_THROW(FileIOError("Could not write frame index file " + indexFile));
+    }
+}
+
+bool readTrajectoryFrameIndex(const std::string&    indexFile,
+                              const std::string&    trajectoryFile,
+                              TrajectoryFrameIndex* index)
+{
+    FILE* fp = std::fopen(indexFile.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        return false;
+    }
+    XDR xd;
+    xdrstdio_create(&xd, fp, XDR_DECODE);
+
+    int     magic, version;
+    int64_t fileSize, mtime, count;
+    bool    bOK = xdr_int(&xd, &magic) && magic == c_frameIndexMagic && xdr_int(&xd, &version)
+               && version == c_frameIndexVersion && xdr_int64(&xd, &fileSize)
+               && xdr_int64(&xd, &mtime) && xdr_int64(&xd, &count) && count >= 0;
+    if (bOK)
+    {
+        const auto fileInfo = fileSizeAndModificationTime(trajectoryFile);
+        bOK                 = (fileInfo.first == fileSize && fileInfo.second == mtime);
+    }
+    std::vector<TrajectoryFrameIndexEntry> frames;
+    for (int64_t i = 0; bOK && i < count; i++)
+    {
+        int64_t offset, step;
+        double  time;
+        bOK = xdr_int64(&xd, &offset) && xdr_int64(&xd, &step) && xdr_double(&xd, &time);
+        if (bOK)
+        {
+            frames.push_back({ offset, step, time });
+        }
+    }
+    xdr_destroy(&xd);
+    std::fclose(fp);
+    if (bOK)
+    {
+        *index = TrajectoryFrameIndex(fileSize, mtime, std::move(frames));
+    }
+    return bOK;
+}
+
+TrajectoryFrameIndex readOrBuildTrajectoryFrameIndex(const std::string& trajectoryFile)
+{
+    const std::string    indexFile = trajectoryFrameIndexFileName(trajectoryFile);
+    TrajectoryFrameIndex index;
+    if (readTrajectoryFrameIndex(indexFile, trajectoryFile, &index))
+    {
+        return index;
+    }
+    index = buildTrajectoryFrameIndex(trajectoryFile);
+    /* The index file is only a cache, so failing to write it,
+     * e.g. in a read-only directory, is not an error.
+     */
+    FILE* fp = std::fopen(indexFile.c_str(), "wb");
+    if (fp == nullptr || !writeTrajectoryFrameIndexToFile(fp, index))
+    {
+        if (fp != nullptr)
+        {
+            std::remove(indexFile.c_str());
+        }
+        if (debug)
+        {
+            fprintf(debug, "Could not write frame index file %s\n", indexFile.c_str());
+        }
+    }
+    return index;
+}
+
+} // namespace gmx
@@ -0,0 +1,172 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares an on-disk index of the frames in xtc and trr files.
+ *
+ * The index stores the file offset, step and time of each frame, so that
+ * readers can seek to a frame or time and count frames without scanning
+ * the trajectory. It is kept in a sidecar file next to the trajectory and
+ * is rebuilt when the size or modification time of the trajectory no
+ * longer match those recorded in the index.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_TRAJECTORYFRAMEINDEX_H
+#define GMX_FILEIO_TRAJECTORYFRAMEINDEX_H
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
+
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Location and time of one frame in a trajectory file.
+ */
+struct TrajectoryFrameIndexEntry
+{
+    //! Offset of the frame header in the file.
+    int64_t offset;
+    //! Step of the frame.
+    int64_t step;
+    //! Time of the frame.
+    double time;
+};
+
+/*! \libinternal \brief
+ * Index of the frames in an xtc or trr file.
+ *
+ * Typical use is
+ * \code
+   TrajectoryFrameIndex index = readOrBuildTrajectoryFrameIndex(filename);
+   for (const auto& frame : index.frames())
+   {
+       // seek to frame.offset
+   }
+ * \endcode
+ *
+ * Since the index records the time of each frame, a trajectory can also
+ * be split into ranges of frames that are read by separate workers.
+ */
+class TrajectoryFrameIndex
+{
+public:
+    //! Creates an empty index.
+    TrajectoryFrameIndex();
+    //! Creates an index for a file of \p fileSize bytes modified at \p modificationTime.
+    TrajectoryFrameIndex(int64_t                                fileSize,
+                         int64_t                                modificationTime,
+                         std::vector<TrajectoryFrameIndexEntry> frames);
+
+    //! Returns the size of the indexed file.
+    int64_t fileSize() const { return fileSize_; }
+    //! Returns the modification time of the indexed file.
+    int64_t modificationTime() const { return modificationTime_; }
+    //! Returns the number of frames.
+    int64_t frameCount() const { return static_cast<int64_t>(frames_.size()); }
+    //! Returns all frames in file order.
+    ArrayRef<const TrajectoryFrameIndexEntry> frames() const { return frames_; }
+    /*! \brief
+     * Returns the index of the first frame with time at least \p time.
+     *
+     * Returns frameCount() if there is no such frame. Frame times are
+     * assumed to increase through the file.
+     */
+    int64_t firstFrameAtOrAfter(double time) const;
+
+private:
+    //! Size of the indexed file in bytes.
+    int64_t fileSize_;
+    //! Modification time of the indexed file.
+    int64_t modificationTime_;
+    //! Frames in file order.
+    std::vector<TrajectoryFrameIndexEntry> frames_;
+};
+
+/*! \brief
+ * Returns the name of the index file for trajectory \p trajectoryFile.
+ */
+std::string trajectoryFrameIndexFileName(const std::string& trajectoryFile);
+
+/*! \brief
+ * Builds the index by scanning the frame headers of \p trajectoryFile.
+ *
+ * Only the headers are read; the coordinate data is skipped. A truncated
+ * last frame is not included.
+ *
+ * \throws InvalidInputError if the file is not an xtc or trr file.
+ * \throws FileIOError if the file can not be accessed.
+ */
+TrajectoryFrameIndex buildTrajectoryFrameIndex(const std::string& trajectoryFile);
+
+/*! \brief
+ * Writes \p index to \p indexFile.
+ *
+ * \throws FileIOError if the file can not be written.
+ */
+void writeTrajectoryFrameIndex(const std::string& indexFile, const TrajectoryFrameIndex& index);
+
+/*! \brief
+ * Reads the index of \p trajectoryFile from \p indexFile.
+ *
+ * Returns false, leaving \p index unchanged, when the index file does
+ * not exist, can not be parsed, or does not match the current size and
+ * modification time of \p trajectoryFile.
+ */
+bool readTrajectoryFrameIndex(const std::string&    indexFile,
+                              const std::string&    trajectoryFile,
+                              TrajectoryFrameIndex* index);
+
+/*! \brief
+ * Returns a valid index for \p trajectoryFile.
+ *
+ * Uses the sidecar index file when it is up to date, otherwise builds
+ * the index and tries to write it. Failure to write the index file, e.g.
+ * in a read-only directory, is not an error.
+ *
+ * \throws InvalidInputError if the file is not an xtc or trr file.
+ * \throws FileIOError if the trajectory can not be accessed.
+ */
+TrajectoryFrameIndex readOrBuildTrajectoryFrameIndex(const std::string& trajectoryFile);
+
+} // namespace gmx
+
+#endif
@@ -44,6 +44,8 @@
 #include <cmath>
 #include <cstring>
 
+#include <algorithm>
+
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/filetypes.h"
@@ -56,6 +58,7 @@
 #include "gromacs/fileio/timecontrol.h"
 #include "gromacs/fileio/tngio.h"
 #include "gromacs/fileio/tpxio.h"
+#include "gromacs/fileio/trajectoryframeindex.h"
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/xdrf.h"
 #include "gromacs/fileio/xtcio.h"
@@ -68,6 +71,7 @@
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 #if GMX_USE_PLUGINS
@@ -83,16 +87,19 @@ struct t_trxstatus
 {
     int  flags; /* flags for read_first/next_frame  */
     int  __frame;
-    real t0;                 /* time of the first frame, needed  *
-                              * for skipping frames with -dt     */
-    real                 tf; /* internal frame time              */
-    t_trxframe*          xframe;
-    t_fileio*            fio;
-    gmx_tng_trajectory_t tng;
-    int                  natoms;
-    double               DT, BOX[3];
-    gmx_bool             bReadBox;
-    char*                persistent_line; /* Persistent line for reading g96 trajectories */
+    real t0;                       /* time of the first frame, needed  *
+                                    * for skipping frames with -dt     */
+    real                       tf; /* internal frame time              */
+    t_trxframe*                xframe;
+    t_fileio*                  fio;
+    gmx_tng_trajectory_t       tng;
+    int                        natoms;
+    double                     DT, BOX[3];
+    gmx_bool                   bReadBox;
+    char*                      persistent_line; /* Persistent line for reading g96 trajectories */
+    gmx::XtcReadAheadReader*   xtcReadAhead;    /* Parallel xtc reader, nullptr when not used */
+    gmx::TrajectoryFrameIndex* frameIndex;      /* Frame index, nullptr when not loaded */
+    gmx::TngFramePrefetcher*   tngPrefetcher;   /* Reads TNG frames ahead, nullptr when not used */
 #if GMX_USE_PLUGINS
     gmx_vmdplugin_t* vmdplugin;
 #endif
@@ -166,8 +173,133 @@ static void status_init(t_trxstatus* status)
     status->tf              = 0;
     status->persistent_line = nullptr;
     status->tng             = nullptr;
+    status->xtcReadAhead    = nullptr;
+    status->frameIndex      = nullptr;
+    status->tngPrefetcher   = nullptr;
+}
+
+/*! \brief Return whether TNG frames are read and written in separate threads
+ *
+ * Turned on with the environment variable GMX_TNG_THREADS.
+ */
+static bool useTngThreads()
+{
+    return getenv("GMX_TNG_THREADS") != nullptr;
+}
+
+/*! \brief Return the number of threads for decompressing xtc frames
+ *
+ * Read-ahead with parallel decompression is only used when
+ * GMX_XTC_READAHEAD is set and more than one OpenMP thread is available.
+ */
+static int xtcReadAheadThreadCount()
+{
+    if (getenv("GMX_XTC_READAHEAD") == nullptr)
+    {
+        return 1;
+    }
+    return gmx_omp_get_max_threads();
+}
+
+//! The maximum size of the decompressed xtc frames that are read ahead
+static constexpr size_t c_xtcReadAheadMaxBytes = 256 * 1024 * 1024;
+
+/*! \brief Return the number of xtc frames to read ahead with \p threadCount threads
+ *
+ * Two frames per thread are read, but the memory of the decompressed
+ * frames is limited to c_xtcReadAheadMaxBytes.
+ */
+static int xtcReadAheadFrameCount(int natoms, int threadCount)
+{
+    const size_t frameBytes    = std::max<size_t>(natoms, 1) * sizeof(rvec);
+    const size_t maxFrameCount = std::max<size_t>(1, c_xtcReadAheadMaxBytes / frameBytes);
+
+    return static_cast<int>(std::min<size_t>(2 * threadCount, maxFrameCount));
+}
+
+
+//! Returns whether the frame index of a trajectory is stored in a file next to it.
+static bool useTrajectoryIndexFile()
+{
+    return getenv("GMX_TRAJECTORY_INDEX") != nullptr;
+}
+
+/*! \brief Returns the frame index of an xtc or trr file, nullptr for other files
+ *
+ * The index is built on first use. Only with GMX_TRAJECTORY_INDEX set,
+ * the index is read from, or written to, its sidecar file.
+ */
+static const gmx::TrajectoryFrameIndex* trxFrameIndex(t_trxstatus* status)
+{
+    if (status->frameIndex == nullptr && status->fio != nullptr && status->tng == nullptr)
+    {
+        const int ftp = gmx_fio_getftp(status->fio);
+        if (ftp == efXTC || ftp == efTRR)
+        {
+            const char* fn     = gmx_fio_getname(status->fio);
+            status->frameIndex = new gmx::TrajectoryFrameIndex(
+                    useTrajectoryIndexFile() ? gmx::readOrBuildTrajectoryFrameIndex(fn)
+                                             : gmx::buildTrajectoryFrameIndex(fn));
+        }
+    }
+    return status->frameIndex;
+}
+
+//! Returns whether the frame index should be used to seek to the -b time.
+static bool useFrameIndexForBeginTime()
+{
+    return bTimeSet(TBEGIN) && useTrajectoryIndexFile();
+}
+
+/*! \brief Positions the file at the first frame that is not skipped by -b
+ *
+ * Returns false, without moving, when no such frame is in the index.
+ */
+static bool seekToBeginTime(t_trxstatus* status)
+{
+    const gmx::TrajectoryFrameIndex* index = trxFrameIndex(status);
+    if (index == nullptr)
+    {
+        return false;
+    }
+    const auto frames = index->frames();
+    const auto frame  = std::find_if(frames.begin(), frames.end(),
+                                    [](const gmx::TrajectoryFrameIndexEntry& entry) {
+                                        return check_times(entry.time) >= 0;
+                                    });
+    if (frame == frames.end() || gmx_fio_seek(status->fio, frame->offset) != 0)
+    {
+        return false;
+    }
+    if (status->xtcReadAhead != nullptr)
+    {
+        status->xtcReadAhead->discardBufferedFrames();
+    }
+    return true;
+}
+
+int64_t trx_frame_count(t_trxstatus* status)
+{
+    const gmx::TrajectoryFrameIndex* index = trxFrameIndex(status);
+    return (index != nullptr) ? index->frameCount() : -1;
 }
 
+gmx_bool trx_seek_frame(t_trxstatus* status, int64_t frame)
+{
+    const gmx::TrajectoryFrameIndex* index = trxFrameIndex(status);
+    if (index == nullptr || frame < 0 || frame >= index->frameCount()
+        || gmx_fio_seek(status->fio, index->frames()[frame].offset) != 0)
+    {
+        return FALSE;
+    }
+    if (status->xtcReadAhead != nullptr)
+    {
+        status->xtcReadAhead->discardBufferedFrames();
+    }
+    status->__frame = frame - 1;
+
+    return TRUE;
+}
 
 int nframes_read(t_trxstatus* status)
 {
@@ -255,6 +387,10 @@ float trx_get_time_of_final_frame(t_trxstatus* status)
         {
             gmx_fatal(FARGS, "Error opening TNG file.");
         }
+        if (status->tngPrefetcher != nullptr)
+        {
+            status->tngPrefetcher->waitForPrefetch();
+        }
         lasttime = gmx_tng_get_time_of_final_frame(tng);
     }
     else
@@ -460,6 +596,10 @@ t_trxstatus* trjtools_gmx_prepare_tng_writing(const char*              filename,
 
     if (in != nullptr)
     {
+        if (in->tngPrefetcher != nullptr)
+        {
+            in->tngPrefetcher->waitForPrefetch();
+        }
         gmx_prepare_tng_writing(filename, filemode, &in->tng, &out->tng, natoms, mtop, index,
                                 index_group_name);
     }
@@ -478,6 +618,10 @@ t_trxstatus* trjtools_gmx_prepare_tng_writing(const char*              filename,
         gmx_prepare_tng_writing(filename, filemode, nullptr, &out->tng, natoms, mtop, index,
                                 index_group_name);
     }
+    if (useTngThreads())
+    {
+        gmx_tng_start_background_writing(out->tng);
+    }
     return out;
 }
 
@@ -597,7 +741,11 @@ void close_trx(t_trxstatus* status)
     {
         return;
     }
+    /* The prefetcher might still be reading from the TNG file */
+    delete status->tngPrefetcher;
     gmx_tng_close(&status->tng);
+    delete status->xtcReadAhead;
+    delete status->frameIndex;
     if (status->fio)
     {
         gmx_fio_close(status->fio);
@@ -803,9 +951,11 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                 break;
             }
             case efXTC:
-                if (bTimeSet(TBEGIN) && (status->tf < rTimeValue(TBEGIN)))
+                if (bTimeSet(TBEGIN) && (status->tf < rTimeValue(TBEGIN))
+                    && status->xtcReadAhead == nullptr)
                 {
-                    if (xtc_seek_time(status->fio, rTimeValue(TBEGIN), fr->natoms, TRUE))
+                    if (!(useFrameIndexForBeginTime() && seekToBeginTime(status))
+                        && xtc_seek_time(status->fio, rTimeValue(TBEGIN), fr->natoms, TRUE))
                     {
                         gmx_fatal(FARGS,
                                   "Specified frame (time %f) doesn't exist or file "
@@ -814,9 +964,25 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                     }
                     initcount(status);
                 }
-                bRet = (read_next_xtc(status->fio, fr->natoms, &fr->step, &fr->time, fr->box, fr->x,
-                                      &fr->prec, &bOK)
-                        != 0);
+                else if (status->xtcReadAhead == nullptr && xtcReadAheadThreadCount() > 1)
+                {
+                    const int threadCount = xtcReadAheadThreadCount();
+                    const int framesAhead = xtcReadAheadFrameCount(fr->natoms, threadCount);
+                    status->xtcReadAhead =
+                            new gmx::XtcReadAheadReader(status->fio, framesAhead, threadCount);
+                }
+                if (status->xtcReadAhead != nullptr)
+                {
+                    bRet = (status->xtcReadAhead->readNextFrame(fr->natoms, &fr->step, &fr->time,
+                                                                fr->box, fr->x, &fr->prec, &bOK)
+                            != 0);
+                }
+                else
+                {
+                    bRet = (read_next_xtc(status->fio, fr->natoms, &fr->step, &fr->time, fr->box,
+                                          fr->x, &fr->prec, &bOK)
+                            != 0);
+                }
                 fr->bPrec = (bRet && fr->prec > 0);
                 fr->bStep = bRet;
                 fr->bTime = bRet;
@@ -829,7 +995,11 @@ bool read_next_frame(const gmx_output_env_t* oenv, t_trxstatus* status, t_trxfra
                     fr->not_ok = DATA_NOT_OK;
                 }
                 break;
-            case efTNG: bRet = gmx_read_next_tng_frame(status->tng, fr, nullptr, 0); break;
+            case efTNG:
+                bRet = (status->tngPrefetcher != nullptr)
+                               ? status->tngPrefetcher->readNextFrame(fr)
+                               : gmx_read_next_tng_frame(status->tng, fr, nullptr, 0);
+                break;
             case efPDB: bRet = pdb_next_x(status, gmx_fio_getfp(status->fio), fr); break;
             case efGRO: bRet = gro_next_x_or_v(gmx_fio_getfp(status->fio), fr); break;
             default:
@@ -905,6 +1075,11 @@ bool read_first_frame(const gmx_output_env_t* oenv, t_trxstatus** status, const
     else
     {
         fio = (*status)->fio = gmx_fio_open(fn, "r");
+        if ((ftp == efXTC || ftp == efTRR) && useFrameIndexForBeginTime())
+        {
+            /* Start directly at the first frame after the begin time */
+            seekToBeginTime(*status);
+        }
     }
     switch (ftp)
     {
@@ -971,6 +1146,10 @@ bool read_first_frame(const gmx_output_env_t* oenv, t_trxstatus** status, const
             else
             {
                 printcount(*status, oenv, fr->time, FALSE);
+                if (useTngThreads())
+                {
+                    (*status)->tngPrefetcher = new gmx::TngFramePrefetcher((*status)->tng, fr->step);
+                }
             }
             bFirst = FALSE;
             break;
@@ -1049,6 +1228,10 @@ int read_first_x(const gmx_output_env_t* oenv, t_trxstatus** status, const char*
     t_trxframe fr;
 
     read_first_frame(oenv, status, fn, &fr, TRX_NEED_X);
+    /* read_next_x() reads into the buffer of the caller, which can not be
+     * exchanged with the buffers of the prefetcher */
+    delete (*status)->tngPrefetcher;
+    (*status)->tngPrefetcher = nullptr;
 
     snew((*status)->xframe, 1);
     (*(*status)->xframe) = fr;
@@ -1077,6 +1260,10 @@ void rewind_trj(t_trxstatus* status)
     initcount(status);
 
     gmx_fio_rewind(status->fio);
+    if (status->xtcReadAhead != nullptr)
+    {
+        status->xtcReadAhead->discardBufferedFrames();
+    }
 }
 
 /***** T O P O L O G Y   S T U F F ******/
@@ -160,6 +160,20 @@ struct t_fileio* trx_get_fileio(t_trxstatus* status);
 float trx_get_time_of_final_frame(t_trxstatus* status);
 /* get time of final frame. Only supported for TNG and XTC */
 
+int64_t trx_frame_count(t_trxstatus* status);
+/* Returns the number of frames of an xtc or trr file opened with
+ * read_first_frame, or -1 for other formats. Uses the frame index of
+ * the file (see trajectoryframeindex.h), which is built on first use.
+ */
+
+gmx_bool trx_seek_frame(t_trxstatus* status, int64_t frame);
+/* Positions an xtc or trr file opened with read_first_frame, such that
+ * the next call to read_next_frame returns frame number frame (counting
+ * from 0). Uses the frame index of the file. Returns FALSE, without
+ * changing the position, for other formats or frames outside the file.
+ * This allows several readers to process separate ranges of frames.
+ */
+
 gmx_bool bRmod_fd(double a, double b, double c, gmx_bool bDouble);
 /* Returns TRUE when (a - b) MOD c = 0, using a margin which is slightly
  * larger than the float/double precision.
@@ -39,6 +39,8 @@
 
 #include <stdio.h>
 
+#include <vector>
+
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/real.h"
 
@@ -59,6 +61,48 @@
 int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision);
 
 
+/*! \brief Compressed coordinates of one frame, as stored by xdr3dfcoord()
+ *
+ * Reading the compressed data from the stream and decompressing it are
+ * separate steps, so that the (expensive) decompression of several frames
+ * can run concurrently once their data has been read.
+ */
+struct XtcCompressedCoords
+{
+    //! Number of coordinate triplets
+    int natoms = 0;
+    //! Precision, -1 when the coordinates are stored uncompressed
+    float precision = -1;
+    //! Minimum integer coordinate in each dimension
+    int minint[3] = { 0, 0, 0 };
+    //! Maximum integer coordinate in each dimension
+    int maxint[3] = { 0, 0, 0 };
+    //! Initial index into the table of small-integer sizes
+    int smallidx = 0;
+    //! Uncompressed coordinates, only used for frames with at most 9 atoms
+    std::vector<float> uncompressed;
+    //! The compressed bit stream
+    std::vector<unsigned char> bytes;
+};
+
+/* Read the compressed coordinates written by xdr3dfcoord() without
+ * decompressing them. *size has the same meaning as for xdr3dfcoord().
+ */
+int xdr3dfcoord_read_compressed(XDR* xdrs, XtcCompressedCoords* coords, int* size);
+
+/* Decompress coordinates read by xdr3dfcoord_read_compressed() into fp,
+ * which should hold 3*coords.natoms floats. Produces the same output as
+ * reading with xdr3dfcoord(). Does not access the XDR stream, so it can
+ * be called concurrently for different frames.
+ */
+int xdr3dfcoord_decompress(const XtcCompressedCoords& coords, float* fp);
+
+/* As xdr3dfcoord(), but when reading, the compressed data is stored in
+ * *buffer, so its memory can be reused for the next frame.
+ */
+int xdr3dfcoord(XDR* xdrs, float* fp, int* size, float* precision, XtcCompressedCoords* buffer);
+
+
 /* Read or write a *real* value (stored as float) */
 int xdr_real(XDR* xdrs, real* r);
 
@@ -40,10 +40,18 @@
 
 #include <cstring>
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
 #include "gromacs/fileio/xdrf.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/smalloc.h"
@@ -137,7 +145,15 @@ static int xtc_header(XDR* xd, int* magic, int* natoms, int64_t* step, real* tim
     return result;
 }
 
-static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_bool bRead)
+/* coordBuffer stores the compressed coordinates when reading,
+ * so its memory is reused over frames. */
+static int xtc_coord(XDR*                 xd,
+                     int*                 natoms,
+                     rvec*                box,
+                     rvec*                x,
+                     real*                prec,
+                     gmx_bool             bRead,
+                     XtcCompressedCoords* coordBuffer)
 {
     int i, j, result;
 #if GMX_DOUBLE
@@ -175,7 +191,7 @@ static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_b
         }
         fprec = *prec;
     }
-    result = XTC_CHECK("x", xdr3dfcoord(xd, ftmp, natoms, &fprec));
+    result = XTC_CHECK("x", xdr3dfcoord(xd, ftmp, natoms, &fprec, coordBuffer));
 
     /* Copy from temp. array if reading */
     if (bRead)
@@ -190,7 +206,7 @@ static int xtc_coord(XDR* xd, int* natoms, rvec* box, rvec* x, real* prec, gmx_b
     }
     sfree(ftmp);
 #else
-    result = XTC_CHECK("x", xdr3dfcoord(xd, x[0], natoms, prec));
+    result = XTC_CHECK("x", xdr3dfcoord(xd, x[0], natoms, prec, coordBuffer));
 #endif
 
     return result;
@@ -220,8 +236,8 @@ int write_xtc(t_fileio* fio, int natoms, int64_t step, real time, const rvec* bo
     }
 
     /* write data */
-    bOK = xtc_coord(xd, &natoms, const_cast<rvec*>(box), const_cast<rvec*>(x), &prec,
-                    FALSE); /* bOK will be 1 if writing went well */
+    bOK = xtc_coord(xd, &natoms, const_cast<rvec*>(box), const_cast<rvec*>(x), &prec, FALSE,
+                    gmx_fio_getxtccoords(fio)); /* bOK will be 1 if writing went well */
 
     if (bOK)
     {
@@ -252,7 +268,7 @@ int read_first_xtc(t_fileio* fio, int* natoms, int64_t* step, real* time, matrix
 
     snew(*x, *natoms);
 
-    *bOK = (xtc_coord(xd, natoms, box, *x, prec, TRUE) != 0);
+    *bOK = (xtc_coord(xd, natoms, box, *x, prec, TRUE, gmx_fio_getxtccoords(fio)) != 0);
 
     return static_cast<int>(*bOK);
 }
@@ -280,7 +296,363 @@ int read_next_xtc(t_fileio* fio, int natoms, int64_t* step, real* time, matrix b
         gmx_fatal(FARGS, "Frame contains more atoms (%d) than expected (%d)", n, natoms);
     }
 
-    *bOK = (xtc_coord(xd, &natoms, box, x, prec, TRUE) != 0);
+    *bOK = (xtc_coord(xd, &natoms, box, x, prec, TRUE, gmx_fio_getxtccoords(fio)) != 0);
 
     return static_cast<int>(*bOK);
 }
+
+namespace gmx
+{
+
+/********************************************************************
+ * XtcReadAheadReader::Impl
+ */
+
+class XtcReadAheadReader::Impl
+{
+public:
+    //! A frame that has been read, but not yet returned.
+    struct Frame
+    {
+        //! Whether the header could be read.
+        bool headerOK = false;
+        //! Return value of the read, as for read_next_xtc().
+        int status = 0;
+        //! Whether the frame is not corrupted.
+        gmx_bool bOK = TRUE;
+        //! Magic number from the header.
+        int magic = 0;
+        //! Number of atoms in the header.
+        int natoms = 0;
+        //! Step from the header.
+        int64_t step = 0;
+        //! Time from the header.
+        real time = 0;
+        //! Box.
+        matrix box = { { 0 } };
+        //! Compressed coordinates.
+        XtcCompressedCoords coords;
+        //! Decompressed coordinates.
+        std::vector<float> x;
+    };
+
+    Impl(t_fileio* fio, int framesAhead, int threadCount);
+
+    //! Reads up to framesAhead_ frames and decompresses them.
+    void readFrames(int natoms);
+    //! Reads the header, box and compressed coordinates of one frame.
+    void readFrame(int natoms, Frame* frame);
+
+    //! File to read from.
+    t_fileio* fio_;
+    //! Maximum number of frames to read ahead.
+    int framesAhead_;
+    //! Number of threads for decompression.
+    int threadCount_;
+    //! Frames that have been read; only the first frameCount_ are valid.
+    std::vector<Frame> frames_;
+    //! Number of valid frames in frames_.
+    int frameCount_;
+    //! Index of the next frame to return.
+    int nextFrame_;
+};
+
+XtcReadAheadReader::Impl::Impl(t_fileio* fio, int framesAhead, int threadCount) :
+    fio_(fio),
+    framesAhead_(std::max(framesAhead, 1)),
+    threadCount_(std::max(threadCount, 1)),
+    frames_(framesAhead_),
+    frameCount_(0),
+    nextFrame_(0)
+{
+}
+
+void XtcReadAheadReader::Impl::readFrame(int natoms, Frame* frame)
+{
+    XDR* xd = gmx_fio_getxdr(fio_);
+
+    frame->bOK      = TRUE;
+    frame->status   = 0;
+    frame->headerOK = (xtc_header(xd, &frame->magic, &frame->natoms, &frame->step, &frame->time,
+                                  TRUE, &frame->bOK)
+                       != 0);
+    if (!frame->headerOK)
+    {
+        return;
+    }
+    /* An inconsistent frame is reported when it is returned, so that all
+     * preceding frames are still processed as with read_next_xtc().
+     */
+    if (frame->magic != XTC_MAGIC || frame->natoms > natoms)
+    {
+        return;
+    }
+
+    int result = 1;
+    for (int i = 0; ((i < DIM) && result); i++)
+    {
+        for (int j = 0; ((j < DIM) && result); j++)
+        {
+            result = XTC_CHECK("box", xdr_r2f(xd, &(frame->box[i][j]), TRUE));
+        }
+    }
+    if (result)
+    {
+        int size = natoms;
+        result   = XTC_CHECK("x", xdr3dfcoord_read_compressed(xd, &frame->coords, &size));
+    }
+    frame->bOK    = (result != 0);
+    frame->status = result;
+}
+
+void XtcReadAheadReader::Impl::readFrames(int natoms)
+{
+    frameCount_ = 0;
+    nextFrame_  = 0;
+    while (frameCount_ < framesAhead_)
+    {
+        Frame* frame = &frames_[frameCount_++];
+        readFrame(natoms, frame);
+        if (!frame->bOK || frame->magic != XTC_MAGIC || frame->natoms > natoms)
+        {
+            break;
+        }
+    }
+
+    const int numToDecompress = frameCount_;
+#pragma omp parallel for num_threads(threadCount_) schedule(dynamic)
+    for (int f = 0; f < numToDecompress; f++)
+    {
+        try
+        {
+            Frame* frame = &frames_[f];
+            if (frame->headerOK && frame->bOK && frame->magic == XTC_MAGIC && frame->natoms <= natoms)
+            {
+                frame->x.resize(3 * std::max(frame->coords.natoms, 0));
+                frame->bOK    = XTC_CHECK("x", xdr3dfcoord_decompress(frame->coords, frame->x.data()));
+                frame->status = static_cast<int>(frame->bOK);
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
+    }
+}
+
+/********************************************************************
+ * XtcReadAheadReader
+ */
+
+XtcReadAheadReader::XtcReadAheadReader(t_fileio* fio, int framesAhead, int threadCount) :
+    impl_(new Impl(fio, framesAhead, threadCount))
+{
+}
+
+XtcReadAheadReader::~XtcReadAheadReader() {}
+
+int XtcReadAheadReader::readNextFrame(int       natoms,
+                                      int64_t*  step,
+                                      real*     time,
+                                      matrix    box,
+                                      rvec*     x,
+                                      real*     prec,
+                                      gmx_bool* bOK)
+{
+    if (impl_->nextFrame_ == impl_->frameCount_)
+    {
+        impl_->readFrames(natoms);
+    }
+    const Impl::Frame& frame = impl_->frames_[impl_->nextFrame_++];
+
+    *step = frame.step;
+    *time = frame.time;
+    *bOK  = frame.bOK;
+    if (!frame.headerOK)
+    {
+        return 0;
+    }
+    check_xtc_magic(frame.magic);
+    if (frame.natoms > natoms)
+    {
+        gmx_fatal(FARGS, "Frame contains more atoms (%d) than expected (%d)", frame.natoms, natoms);
+    }
+    copy_mat(frame.box, box);
+    if (frame.status != 0)
+    {
+        for (int i = 0; i < frame.coords.natoms; i++)
+        {
+            x[i][XX] = frame.x[DIM * i + XX];
+            x[i][YY] = frame.x[DIM * i + YY];
+            x[i][ZZ] = frame.x[DIM * i + ZZ];
+        }
+        *prec = frame.coords.precision;
+    }
+
+    return frame.status;
+}
+
+void XtcReadAheadReader::discardBufferedFrames()
+{
+    impl_->frameCount_ = 0;
+    impl_->nextFrame_  = 0;
+}
+
+/********************************************************************
+ * XtcWriterThread::Impl
+ */
+
+class XtcWriterThread::Impl
+{
+public:
+    //! A frame that is queued for writing.
+    struct Frame
+    {
+        //! Step.
+        int64_t step = 0;
+        //! Time.
+        real time = 0;
+        //! Box.
+        matrix box = { { 0 } };
+        //! Coordinates, the size is the number of atoms.
+        std::vector<RVec> x;
+        //! Compression precision.
+        real prec = 0;
+    };
+
+    Impl(t_fileio* fio, int maxQueuedFrames);
+    ~Impl();
+
+    //! Writes queued frames until stopped.
+    void run();
+
+    //! File to write to.
+    t_fileio* fio_;
+    //! Buffers for all frames, queued or not.
+    std::vector<Frame> frames_;
+    //! Indices of the frames waiting to be written, oldest first.
+    std::deque<int> queued_;
+    //! Indices of the frames that can be filled.
+    std::vector<int> available_;
+    //! Whether the writer thread is writing a frame.
+    bool busy_;
+    //! Whether the writer thread should finish.
+    bool stop_;
+    //! Whether writing any frame failed.
+    bool failed_;
+    //! Protects the members above, except for the contents of queued frames.
+    std::mutex mutex_;
+    //! Signals changes of the queue to the writer thread.
+    std::condition_variable frameQueued_;
+    //! Signals to the caller that a frame has been written.
+    std::condition_variable frameWritten_;
+    //! The writer thread.
+    std::thread thread_;
+};
+
+XtcWriterThread::Impl::Impl(t_fileio* fio, int maxQueuedFrames) :
+    fio_(fio),
+    frames_(std::max(maxQueuedFrames, 1)),
+    busy_(false),
+    stop_(false),
+    failed_(false)
+{
+    for (size_t i = 0; i < frames_.size(); i++)
+    {
+        available_.push_back(i);
+    }
+    thread_ = std::thread(&Impl::run, this);
+}
+
+XtcWriterThread::Impl::~Impl()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    frameQueued_.notify_one();
+    thread_.join();
+}
+
+void XtcWriterThread::Impl::run()
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true)
+        {
+            frameQueued_.wait(lock, [this] { return stop_ || !queued_.empty(); });
+            if (queued_.empty())
+            {
+                /* Only stop when all queued frames have been written */
+                return;
+            }
+            const int index = queued_.front();
+            queued_.pop_front();
+            busy_ = true;
+            lock.unlock();
+
+            Frame&    frame = frames_[index];
+            const int bOK   = write_xtc(fio_, frame.x.size(), frame.step, frame.time, frame.box,
+                                      as_rvec_array(frame.x.data()), frame.prec);
+
+            lock.lock();
+            busy_ = false;
+            failed_ = failed_ || (bOK == 0);
+            available_.push_back(index);
+            frameWritten_.notify_all();
+        }
+    }
+    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+}
+
+/********************************************************************
+ * XtcWriterThread
+ */
+
+XtcWriterThread::XtcWriterThread(t_fileio* fio, int maxQueuedFrames) :
+    impl_(new Impl(fio, maxQueuedFrames))
+{
+}
+
+XtcWriterThread::~XtcWriterThread() {}
+
+bool XtcWriterThread::writeFrame(int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec)
+{
+    int index;
+    {
+        std::unique_lock<std::mutex> lock(impl_->mutex_);
+        impl_->frameWritten_.wait(lock, [this] { return !impl_->available_.empty(); });
+        if (impl_->failed_)
+        {
+            return false;
+        }
+        index = impl_->available_.back();
+        impl_->available_.pop_back();
+    }
+
+    /* The buffer is not accessed by the writer thread until it is queued */
+    Impl::Frame& frame = impl_->frames_[index];
+    frame.step         = step;
+    frame.time         = time;
+    frame.prec         = prec;
+    copy_mat(box, frame.box);
+    frame.x.assign(x, x + natoms);
+
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex_);
+        impl_->queued_.push_back(index);
+    }
+    impl_->frameQueued_.notify_one();
+
+    return true;
+}
+
+bool XtcWriterThread::flush()
+{
+    std::unique_lock<std::mutex> lock(impl_->mutex_);
+    impl_->frameWritten_.wait(lock, [this] { return impl_->queued_.empty() && !impl_->busy_; });
+    /* The writer thread is idle until a new frame is queued, which needs the lock */
+    impl_->failed_ = impl_->failed_ || (gmx_fio_flush(impl_->fio_) != 0);
+
+    return !impl_->failed_;
+}
+
+} // namespace gmx
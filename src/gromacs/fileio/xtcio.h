@@ -40,6 +40,7 @@
 
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/real.h"
 
 struct t_fileio;
@@ -77,4 +78,94 @@ int read_next_xtc(struct t_fileio* fio, int natoms, int64_t* step, real* time, m
 int write_xtc(struct t_fileio* fio, int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec);
 /* Write a frame to xtc file */
 
+namespace gmx
+{
+
+/*! \libinternal \brief
+ * Reads xtc frames ahead of the caller and decompresses them in parallel.
+ *
+ * The compressed data of up to \p framesAhead frames is read from the file
+ * in one go, after which the frames are decompressed concurrently by
+ * \p threadCount OpenMP threads and handed out one at a time by
+ * readNextFrame(). The frames are identical to those returned by
+ * read_next_xtc().
+ *
+ * Because of the read-ahead, the position of the file is beyond the last
+ * frame returned. Call discardBufferedFrames() after repositioning the file.
+ */
+class XtcReadAheadReader
+{
+public:
+    /*! \brief
+     * Creates a reader for \p fio, which must remain open while the reader
+     * is in use.
+     */
+    XtcReadAheadReader(t_fileio* fio, int framesAhead, int threadCount);
+    ~XtcReadAheadReader();
+
+    /*! \brief
+     * Returns the next frame, with the same semantics as read_next_xtc().
+     */
+    int readNextFrame(int       natoms,
+                      int64_t*  step,
+                      real*     time,
+                      matrix    box,
+                      rvec*     x,
+                      real*     prec,
+                      gmx_bool* bOK);
+
+    //! Discards frames that have been read ahead but not yet returned.
+    void discardBufferedFrames();
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+/*! \libinternal \brief
+ * Compresses and writes xtc frames in a background thread.
+ *
+ * writeFrame() copies the coordinates into one of \p maxQueuedFrames
+ * buffers and returns, while a dedicated thread compresses the frame and
+ * writes it to the file. When all buffers are in use, writeFrame() waits
+ * for the oldest frame to be written, so memory use is bounded.
+ * The file contents are identical to those written by write_xtc().
+ *
+ * The file must not be accessed otherwise while frames are queued.
+ * Call flush() before reading the file position, e.g. when writing a
+ * checkpoint. The destructor writes all queued frames.
+ */
+class XtcWriterThread
+{
+public:
+    /*! \brief
+     * Creates a writer for \p fio, which must remain open while the
+     * writer exists.
+     */
+    XtcWriterThread(t_fileio* fio, int maxQueuedFrames);
+    ~XtcWriterThread();
+
+    /*! \brief
+     * Queues a frame for writing, with the same arguments as write_xtc().
+     *
+     * Returns false when writing an earlier frame failed.
+     */
+    bool writeFrame(int natoms, int64_t step, real time, const rvec* box, const rvec* x, real prec);
+
+    /*! \brief
+     * Waits until all queued frames have been written, then flushes the file.
+     *
+     * Returns false when writing any frame, or flushing, failed.
+     */
+    bool flush();
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
 #endif
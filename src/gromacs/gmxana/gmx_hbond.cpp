@@ -43,7 +43,9 @@
 #include <cstring>
 
 #include <algorithm>
+#include <memory>
 #include <numeric>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
@@ -62,6 +64,7 @@
 #include "gromacs/math/vec.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/selection/nbsearch.h"
 #include "gromacs/topology/ifunc.h"
 #include "gromacs/topology/index.h"
 #include "gromacs/topology/topology.h"
@@ -106,9 +109,6 @@ static const unsigned char c_acceptorMask = (1 << 0);
 static const unsigned char c_donorMask    = (1 << 1);
 static const unsigned char c_inGroupMask  = (1 << 2);
 
-
-static const char* grpnames[grNR] = { "0", "1", "I" };
-
 static gmx_bool bDebug = FALSE;
 
 #define HB_NO 0
@@ -125,21 +125,22 @@ static gmx_bool bDebug = FALSE;
 #define ISDON(h) ((h)&c_donorMask)
 #define ISINGRP(h) ((h)&c_inGroupMask)
 
-typedef struct
-{
-    int  nr;
-    int  maxnr;
-    int* atoms;
-} t_ncell;
+typedef int t_icell[grNR];
+typedef int h_id[MAXHYDRO];
 
+/* Run-length encoded existence of a hydrogen bond as a function of time.
+ * The frames in which the bond exists are stored as sorted, disjoint
+ * half-open intervals [begin[i], end[i]) of absolute frame indices.
+ * Frames are analyzed in order, so recording a frame is usually a matter
+ * of extending the last interval, and the memory use scales with the
+ * number of times a bond forms instead of with the trajectory length.
+ */
 typedef struct
 {
-    t_ncell d[grNR];
-    t_ncell a[grNR];
-} t_gridcell;
-
-typedef int t_icell[grNR];
-typedef int h_id[MAXHYDRO];
+    int  nr, maxnr;
+    int* begin;
+    int* end;
+} t_hbexist;
 
 typedef struct
 {
@@ -147,13 +148,13 @@ typedef struct
     /* Has this hbond existed ever? If so as hbDist or hbHB or both.
      * Result is stored as a bitmap (1 = hbDist) || (2 = hbHB)
      */
-    /* Bitmask array which tells whether a hbond is present
-     * at a given time. Either of these may be NULL
+    /* Existence of the hbond per hydrogen as a function of time.
+     * Either of these may be NULL
      */
-    int            n0;                 /* First frame a HB was found     */
-    int            nframes, maxframes; /* Amount of frames in this hbond */
-    unsigned int** h;
-    unsigned int** g;
+    int         n0;      /* First frame a HB was found     */
+    int         nframes; /* Amount of frames in this hbond */
+    t_hbexist** h;
+    t_hbexist** g;
     /* See Xu and Berne, JPCB 105 (2001), p. 11929. We define the
      * function g(t) = [1-h(t)] H(t) where H(t) is one when the donor-
      * acceptor distance is less than the user-specified distance (typically
@@ -183,7 +184,6 @@ typedef struct
 typedef struct
 {
     gmx_bool bHBmap, bDAnr;
-    int      wordlen;
     /* The following arrays are nframes long */
     int      nframes, max_frames, maxhydro;
     int *    nhb, *ndist;
@@ -199,6 +199,15 @@ typedef struct
     t_hbond*** hbmap;
 } t_hbdata;
 
+/* A hydrogen bond (or distance) found in a frame, before it is added to t_hbdata */
+typedef struct
+{
+    int  d, a, h;    /* Donor, acceptor and hydrogen atoms */
+    int  grpd, grpa; /* Donor and acceptor groups          */
+    int  ihb;        /* hbHB or hbDist                     */
+    real dist, ang;  /* Distance and angle (rad) for hbHB  */
+} t_hbcandidate;
+
 /* Changed argument 'bMerge' into 'oneHB' below,
  * since -contact should cause maxhydro to be 1,
  * not just -merge.
@@ -210,9 +219,8 @@ static t_hbdata* mk_hbdata(gmx_bool bHBmap, gmx_bool bDAnr, gmx_bool oneHB)
     t_hbdata* hb;
 
     snew(hb, 1);
-    hb->wordlen = 8 * sizeof(unsigned int);
-    hb->bHBmap  = bHBmap;
-    hb->bDAnr   = bDAnr;
+    hb->bHBmap = bHBmap;
+    hb->bDAnr  = bDAnr;
     if (oneHB)
     {
         hb->maxhydro = 1;
@@ -261,29 +269,156 @@ static void add_frames(t_hbdata* hb, int nframes)
     hb->nframes = nframes;
 }
 
-#define OFFSET(frame) ((frame) / 32)
-#define MASK(frame) (1 << ((frame) % 32))
+/* Inserts the interval [begin, end) before interval pos */
+static void hbexist_insert(t_hbexist* hbexist, int pos, int begin, int end)
+{
+    if (hbexist->nr >= hbexist->maxnr)
+    {
+        hbexist->maxnr = std::max(4, 2 * hbexist->maxnr);
+        srenew(hbexist->begin, hbexist->maxnr);
+        srenew(hbexist->end, hbexist->maxnr);
+    }
+    for (int i = hbexist->nr; i > pos; i--)
+    {
+        hbexist->begin[i] = hbexist->begin[i - 1];
+        hbexist->end[i]   = hbexist->end[i - 1];
+    }
+    hbexist->begin[pos] = begin;
+    hbexist->end[pos]   = end;
+    hbexist->nr++;
+}
 
-static void _set_hb(unsigned int hbexist[], unsigned int frame, gmx_bool bValue)
+/* Marks frame as present. Appending frames in increasing order is O(1). */
+static void _set_hb(t_hbexist* hbexist, int frame)
 {
-    if (bValue)
+    int n = hbexist->nr;
+
+    if (n == 0 || hbexist->end[n - 1] < frame)
+    {
+        hbexist_insert(hbexist, n, frame, frame + 1);
+        return;
+    }
+    if (hbexist->end[n - 1] == frame)
+    {
+        hbexist->end[n - 1]++;
+        return;
+    }
+    /* Out of order: find the first interval that ends at or after frame */
+    int pos = static_cast<int>(std::lower_bound(hbexist->end, hbexist->end + n, frame)
+                               - hbexist->end);
+    if (hbexist->begin[pos] <= frame && frame < hbexist->end[pos])
     {
-        hbexist[OFFSET(frame)] |= MASK(frame);
+        return;
+    }
+    if (hbexist->end[pos] == frame)
+    {
+        hbexist->end[pos]++;
+        if (pos + 1 < n && hbexist->begin[pos + 1] == hbexist->end[pos])
+        {
+            hbexist->end[pos] = hbexist->end[pos + 1];
+            for (int i = pos + 1; i + 1 < n; i++)
+            {
+                hbexist->begin[i] = hbexist->begin[i + 1];
+                hbexist->end[i]   = hbexist->end[i + 1];
+            }
+            hbexist->nr--;
+        }
+    }
+    else if (hbexist->begin[pos] == frame + 1)
+    {
+        hbexist->begin[pos] = frame;
     }
     else
     {
-        hbexist[OFFSET(frame)] &= ~MASK(frame);
+        hbexist_insert(hbexist, pos, frame, frame + 1);
+    }
+}
+
+static gmx_bool is_hb(const t_hbexist* hbexist, int frame)
+{
+    const int* endPtr = std::upper_bound(hbexist->end, hbexist->end + hbexist->nr, frame);
+    int        pos    = static_cast<int>(endPtr - hbexist->end);
+
+    return pos < hbexist->nr && hbexist->begin[pos] <= frame;
+}
+
+/* Fills values[0..n) with the existence of the bond in frames n0..n0+n,
+ * ignoring frames at or after n0+nvalid.
+ */
+static void hbexist_to_real(const t_hbexist* hbexist, int n0, int nvalid, int n, real values[])
+{
+    int last = n0 + std::min(nvalid, n);
+
+    for (int j = 0; j < n; j++)
+    {
+        values[j] = 0;
+    }
+    for (int i = 0; i < hbexist->nr; i++)
+    {
+        int begin = std::max(hbexist->begin[i], n0);
+        int end   = std::min(hbexist->end[i], last);
+        for (int j = begin; j < end; j++)
+        {
+            values[j - n0] = 1;
+        }
+    }
+}
+
+/* Adds all frames present in src to dest */
+static void merge_hbexist(t_hbexist* dest, const t_hbexist* src)
+{
+    int  nr = 0, i = 0, j = 0;
+    int *begin, *end;
+
+    snew(begin, dest->nr + src->nr);
+    snew(end, dest->nr + src->nr);
+    while (i < dest->nr || j < src->nr)
+    {
+        int b, e;
+        if (j >= src->nr || (i < dest->nr && dest->begin[i] <= src->begin[j]))
+        {
+            b = dest->begin[i];
+            e = dest->end[i];
+            i++;
+        }
+        else
+        {
+            b = src->begin[j];
+            e = src->end[j];
+            j++;
+        }
+        if (nr > 0 && b <= end[nr - 1])
+        {
+            end[nr - 1] = std::max(end[nr - 1], e);
+        }
+        else
+        {
+            begin[nr] = b;
+            end[nr]   = e;
+            nr++;
+        }
     }
+    sfree(dest->begin);
+    sfree(dest->end);
+    dest->begin = begin;
+    dest->end   = end;
+    dest->maxnr = dest->nr + src->nr;
+    dest->nr    = nr;
 }
 
-static gmx_bool is_hb(const unsigned int hbexist[], int frame)
+static void free_hbexist(t_hbexist** hbexist)
 {
-    return (hbexist[OFFSET(frame)] & MASK(frame)) != 0;
+    if (*hbexist)
+    {
+        sfree((*hbexist)->begin);
+        sfree((*hbexist)->end);
+        sfree(*hbexist);
+    }
 }
 
 static void set_hb(t_hbdata* hb, int id, int ih, int ia, int frame, int ihb)
 {
-    unsigned int* ghptr = nullptr;
+    t_hbexist* ghptr = nullptr;
 
     if (ihb == hbHB)
     {
@@ -298,49 +433,27 @@ static void set_hb(t_hbdata* hb, int id, int ih, int ia, int frame, int ihb)
         gmx_fatal(FARGS, "Incomprehensible iValue %d in set_hb", ihb);
     }
 
-    _set_hb(ghptr, frame - hb->hbmap[id][ia]->n0, TRUE);
+    _set_hb(ghptr, frame);
 }
 
 static void add_ff(t_hbdata* hbd, int id, int h, int ia, int frame, int ihb)
 {
-    int      i, j, n;
+    int      i;
     t_hbond* hb       = hbd->hbmap[id][ia];
     int      maxhydro = std::min(hbd->maxhydro, hbd->d.nhydro[id]);
-    int      wlen     = hbd->wordlen;
-    int      delta    = 32 * wlen;
 
     if (!hb->h[0])
     {
-        hb->n0        = frame;
-        hb->maxframes = delta;
+        hb->n0 = frame;
         for (i = 0; (i < maxhydro); i++)
         {
-            snew(hb->h[i], hb->maxframes / wlen);
-            snew(hb->g[i], hb->maxframes / wlen);
+            snew(hb->h[i], 1);
+            snew(hb->g[i], 1);
         }
     }
     else
     {
         hb->nframes = frame - hb->n0;
-        /* We need a while loop here because hbonds may be returning
-         * after a long time.
-         */
-        while (hb->nframes >= hb->maxframes)
-        {
-            n = hb->maxframes + delta;
-            for (i = 0; (i < maxhydro); i++)
-            {
-                srenew(hb->h[i], n / wlen);
-                srenew(hb->g[i], n / wlen);
-                for (j = hb->maxframes / wlen; (j < n / wlen); j++)
-                {
-                    hb->h[i][j] = 0;
-                    hb->g[i][j] = 0;
-                }
-            }
-
-            hb->maxframes = n;
-        }
     }
     if (frame >= 0)
     {
@@ -508,21 +621,13 @@ add_hbond(t_hbdata* hb, int d, int a, int h, int grpd, int grpa, int frame, gmx_
 
         if (hb->bHBmap)
         {
-
-#pragma omp critical
+            if (hb->hbmap[id][ia] == nullptr)
             {
-                try
-                {
-                    if (hb->hbmap[id][ia] == nullptr)
-                    {
-                        snew(hb->hbmap[id][ia], 1);
-                        snew(hb->hbmap[id][ia]->h, hb->maxhydro);
-                        snew(hb->hbmap[id][ia]->g, hb->maxhydro);
-                    }
-                    add_ff(hb, id, k, ia, frame, ihb);
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                snew(hb->hbmap[id][ia], 1);
+                snew(hb->hbmap[id][ia]->h, hb->maxhydro);
+                snew(hb->hbmap[id][ia]->g, hb->maxhydro);
             }
+            add_ff(hb, id, k, ia, frame, ihb);
         }
 
         /* Strange construction with frame >=0 is a relic from old code
@@ -877,53 +982,6 @@ static void search_donors(const t_topology* top,
     }
 }
 
-static t_gridcell*** init_grid(gmx_bool bBox, rvec box[], real rcut, ivec ngrid)
-{
-    t_gridcell*** grid;
-    int           i, y, z;
-
-    if (bBox)
-    {
-        for (i = 0; i < DIM; i++)
-        {
-            ngrid[i] = static_cast<int>(box[i][i] / (1.2 * rcut));
-        }
-    }
-
-    if (!bBox || (ngrid[XX] < 3) || (ngrid[YY] < 3) || (ngrid[ZZ] < 3))
-    {
-        for (i = 0; i < DIM; i++)
-        {
-            ngrid[i] = 1;
-        }
-    }
-    else
-    {
-        printf("\nWill do grid-search on %dx%dx%d grid, rcut=%3.8f\n", ngrid[XX], ngrid[YY],
-               ngrid[ZZ], rcut);
-    }
-    if (((ngrid[XX] * ngrid[YY] * ngrid[ZZ]) * sizeof(grid)) > INT_MAX)
-    {
-        gmx_fatal(FARGS,
-                  "Failed to allocate memory for %d x %d x %d grid points, which is larger than "
-                  "the maximum of %zu. "
-                  "You are likely either using a box that is too large (box dimensions are %3.8f "
-                  "nm x%3.8f nm x%3.8f nm) or a cutoff (%3.8f nm) that is too small.",
-                  ngrid[XX], ngrid[YY], ngrid[ZZ], INT_MAX / sizeof(grid), box[XX][XX], box[YY][YY],
-                  box[ZZ][ZZ], rcut);
-    }
-    snew(grid, ngrid[ZZ]);
-    for (z = 0; z < ngrid[ZZ]; z++)
-    {
-        snew((grid)[z], ngrid[YY]);
-        for (y = 0; y < ngrid[YY]; y++)
-        {
-            snew((grid)[z][y], ngrid[XX]);
-        }
-    }
-    return grid;
-}
-
 static void reset_nhbonds(t_donors* ddd)
 {
     int i, j;
@@ -937,288 +995,6 @@ static void reset_nhbonds(t_donors* ddd)
     }
 }
 
-static void pbc_correct_gem(rvec dx, matrix box, const rvec hbox);
-static void pbc_in_gridbox(rvec dx, matrix box);
-
-static void build_grid(t_hbdata*     hb,
-                       rvec          x[],
-                       rvec          xshell,
-                       gmx_bool      bBox,
-                       matrix        box,
-                       rvec          hbox,
-                       real          rcut,
-                       real          rshell,
-                       ivec          ngrid,
-                       t_gridcell*** grid)
-{
-    int      i, m, gr, xi, yi, zi, nr;
-    int*     ad;
-    ivec     grididx;
-    rvec     invdelta, dshell;
-    t_ncell* newgrid;
-    gmx_bool bDoRshell, bInShell;
-    real     rshell2 = 0;
-    int      gx, gy, gz;
-    int      dum = -1;
-
-    bDoRshell = (rshell > 0);
-    rshell2   = gmx::square(rshell);
-    bInShell  = TRUE;
-
-#define DBB(x)           \
-    if (debug && bDebug) \
-    fprintf(debug, "build_grid, line %d, %s = %d\n", __LINE__, #x, x)
-    DBB(dum);
-    for (m = 0; m < DIM; m++)
-    {
-        hbox[m] = box[m][m] * 0.5;
-        if (bBox)
-        {
-            invdelta[m] = ngrid[m] / box[m][m];
-            if (1 / invdelta[m] < rcut)
-            {
-                gmx_fatal(FARGS,
-                          "Your computational box has shrunk too much.\n"
-                          "%s can not handle this situation, sorry.\n",
-                          gmx::getProgramContext().displayName());
-            }
-        }
-        else
-        {
-            invdelta[m] = 0;
-        }
-    }
-    grididx[XX] = 0;
-    grididx[YY] = 0;
-    grididx[ZZ] = 0;
-    DBB(dum);
-    /* resetting atom counts */
-    for (gr = 0; (gr < grNR); gr++)
-    {
-        for (zi = 0; zi < ngrid[ZZ]; zi++)
-        {
-            for (yi = 0; yi < ngrid[YY]; yi++)
-            {
-                for (xi = 0; xi < ngrid[XX]; xi++)
-                {
-                    grid[zi][yi][xi].d[gr].nr = 0;
-                    grid[zi][yi][xi].a[gr].nr = 0;
-                }
-            }
-        }
-        DBB(dum);
-
-        /* put atoms in grid cells */
-        for (int acc = 0; acc < 2; acc++)
-        {
-            if (acc == 1)
-            {
-                nr = hb->a.nra;
-                ad = hb->a.acc;
-            }
-            else
-            {
-                nr = hb->d.nrd;
-                ad = hb->d.don;
-            }
-            DBB(acc);
-            for (i = 0; (i < nr); i++)
-            {
-                /* check if we are inside the shell */
-                /* if bDoRshell=FALSE then bInShell=TRUE always */
-                DBB(i);
-                if (bDoRshell)
-                {
-                    bInShell = TRUE;
-                    rvec_sub(x[ad[i]], xshell, dshell);
-                    if (bBox)
-                    {
-                        gmx_bool bDone = FALSE;
-                        while (!bDone)
-                        {
-                            bDone = TRUE;
-                            for (m = DIM - 1; m >= 0 && bInShell; m--)
-                            {
-                                if (dshell[m] < -hbox[m])
-                                {
-                                    bDone = FALSE;
-                                    rvec_inc(dshell, box[m]);
-                                }
-                                if (dshell[m] >= hbox[m])
-                                {
-                                    bDone = FALSE;
-                                    dshell[m] -= 2 * hbox[m];
-                                }
-                            }
-                        }
-                        for (m = DIM - 1; m >= 0 && bInShell; m--)
-                        {
-                            /* if we're outside the cube, we're outside the sphere also! */
-                            if ((dshell[m] > rshell) || (-dshell[m] > rshell))
-                            {
-                                bInShell = FALSE;
-                            }
-                        }
-                    }
-                    /* if we're inside the cube, check if we're inside the sphere */
-                    if (bInShell)
-                    {
-                        bInShell = norm2(dshell) < rshell2;
-                    }
-                }
-                DBB(i);
-                if (bInShell)
-                {
-                    if (bBox)
-                    {
-                        pbc_in_gridbox(x[ad[i]], box);
-
-                        for (m = DIM - 1; m >= 0; m--)
-                        { /* determine grid index of atom */
-                            grididx[m] = static_cast<int>(x[ad[i]][m] * invdelta[m]);
-                            grididx[m] = (grididx[m] + ngrid[m]) % ngrid[m];
-                        }
-                    }
-
-                    gx = grididx[XX];
-                    gy = grididx[YY];
-                    gz = grididx[ZZ];
-                    range_check(gx, 0, ngrid[XX]);
-                    range_check(gy, 0, ngrid[YY]);
-                    range_check(gz, 0, ngrid[ZZ]);
-                    DBB(gx);
-                    DBB(gy);
-                    DBB(gz);
-                    /* add atom to grid cell */
-                    if (acc == 1)
-                    {
-                        newgrid = &(grid[gz][gy][gx].a[gr]);
-                    }
-                    else
-                    {
-                        newgrid = &(grid[gz][gy][gx].d[gr]);
-                    }
-                    if (newgrid->nr >= newgrid->maxnr)
-                    {
-                        newgrid->maxnr += 10;
-                        DBB(newgrid->maxnr);
-                        srenew(newgrid->atoms, newgrid->maxnr);
-                    }
-                    DBB(newgrid->nr);
-                    newgrid->atoms[newgrid->nr] = ad[i];
-                    newgrid->nr++;
-                }
-            }
-        }
-    }
-}
-
-static void count_da_grid(const ivec ngrid, t_gridcell*** grid, t_icell danr)
-{
-    int gr, xi, yi, zi;
-
-    for (gr = 0; (gr < grNR); gr++)
-    {
-        danr[gr] = 0;
-        for (zi = 0; zi < ngrid[ZZ]; zi++)
-        {
-            for (yi = 0; yi < ngrid[YY]; yi++)
-            {
-                for (xi = 0; xi < ngrid[XX]; xi++)
-                {
-                    danr[gr] += grid[zi][yi][xi].d[gr].nr;
-                }
-            }
-        }
-    }
-}
-
-/* The grid loop.
- * Without a box, the grid is 1x1x1, so all loops are 1 long.
- * With a rectangular box (bTric==FALSE) all loops are 3 long.
- * With a triclinic box all loops are 3 long, except when a cell is
- * located next to one of the box edges which is not parallel to the
- * x/y-plane, in that case all cells in a line or layer are searched.
- * This could be implemented slightly more efficient, but the code
- * would get much more complicated.
- */
-static inline int grid_loop_begin(int n, int x, gmx_bool bTric, gmx_bool bEdge)
-{
-    return ((n == 1) ? x : bTric && bEdge ? 0 : (x - 1));
-}
-static inline int grid_loop_end(int n, int x, gmx_bool bTric, gmx_bool bEdge)
-{
-    return ((n == 1) ? x : bTric && bEdge ? (n - 1) : (x + 1));
-}
-static inline int grid_mod(int j, int n)
-{
-    return (j + n) % (n);
-}
-
-static void dump_grid(FILE* fp, ivec ngrid, t_gridcell*** grid)
-{
-    int gr, x, y, z, sum[grNR];
-
-    fprintf(fp, "grid %dx%dx%d\n", ngrid[XX], ngrid[YY], ngrid[ZZ]);
-    for (gr = 0; gr < grNR; gr++)
-    {
-        sum[gr] = 0;
-        fprintf(fp, "GROUP %d (%s)\n", gr, grpnames[gr]);
-        for (z = 0; z < ngrid[ZZ]; z += 2)
-        {
-            fprintf(fp, "Z=%d,%d\n", z, z + 1);
-            for (y = 0; y < ngrid[YY]; y++)
-            {
-                for (x = 0; x < ngrid[XX]; x++)
-                {
-                    fprintf(fp, "%3d", grid[x][y][z].d[gr].nr);
-                    sum[gr] += grid[z][y][x].d[gr].nr;
-                    fprintf(fp, "%3d", grid[x][y][z].a[gr].nr);
-                    sum[gr] += grid[z][y][x].a[gr].nr;
-                }
-                fprintf(fp, " | ");
-                if ((z + 1) < ngrid[ZZ])
-                {
-                    for (x = 0; x < ngrid[XX]; x++)
-                    {
-                        fprintf(fp, "%3d", grid[z + 1][y][x].d[gr].nr);
-                        sum[gr] += grid[z + 1][y][x].d[gr].nr;
-                        fprintf(fp, "%3d", grid[z + 1][y][x].a[gr].nr);
-                        sum[gr] += grid[z + 1][y][x].a[gr].nr;
-                    }
-                }
-                fprintf(fp, "\n");
-            }
-        }
-    }
-    fprintf(fp, "TOTALS:");
-    for (gr = 0; gr < grNR; gr++)
-    {
-        fprintf(fp, " %d=%d", gr, sum[gr]);
-    }
-    fprintf(fp, "\n");
-}
-
-/* New GMX record! 5 * in a row. Congratulations!
- * Sorry, only four left.
- */
-static void free_grid(const ivec ngrid, t_gridcell**** grid)
-{
-    int           y, z;
-    t_gridcell*** g = *grid;
-
-    for (z = 0; z < ngrid[ZZ]; z++)
-    {
-        for (y = 0; y < ngrid[YY]; y++)
-        {
-            sfree(g[z][y]);
-        }
-        sfree(g[z]);
-    }
-    sfree(g);
-    g = nullptr;
-}
-
 static void pbc_correct_gem(rvec dx, matrix box, const rvec hbox)
 {
     int      m;
@@ -1242,29 +1018,65 @@ static void pbc_correct_gem(rvec dx, matrix box, const rvec hbox)
     }
 }
 
-static void pbc_in_gridbox(rvec dx, matrix box)
+/* Stores the atoms from ad[] that are within a shell of rshell around
+ * xshell in sel, or all atoms when rshell <= 0.
+ */
+static void select_in_shell(int               nr,
+                            const int         ad[],
+                            rvec              x[],
+                            const rvec        xshell,
+                            gmx_bool          bBox,
+                            matrix            box,
+                            const rvec        hbox,
+                            real              rshell,
+                            std::vector<int>* sel)
 {
-    int      m;
-    gmx_bool bDone = FALSE;
-    while (!bDone)
+    rvec dshell;
+
+    sel->clear();
+    for (int i = 0; (i < nr); i++)
     {
-        bDone = TRUE;
-        for (m = DIM - 1; m >= 0; m--)
+        if (rshell > 0)
         {
-            if (dx[m] < 0)
+            rvec_sub(x[ad[i]], xshell, dshell);
+            if (bBox)
             {
-                bDone = FALSE;
-                rvec_inc(dx, box[m]);
+                pbc_correct_gem(dshell, box, hbox);
             }
-            if (dx[m] >= box[m][m])
+            if (norm2(dshell) >= gmx::square(rshell))
             {
-                bDone = FALSE;
-                rvec_dec(dx, box[m]);
+                continue;
             }
         }
+        sel->push_back(ad[i]);
     }
 }
 
+/* Returns the largest distance between a donor and one of its hydrogens */
+static real max_donor_hydrogen_distance(const t_donors* ddd,
+                                        rvec            x[],
+                                        gmx_bool        bBox,
+                                        matrix          box,
+                                        const rvec      hbox)
+{
+    rvec dx;
+    real dmax2 = 0;
+
+    for (int i = 0; (i < ddd->nrd); i++)
+    {
+        for (int k = 0; (k < ddd->nhydro[i]); k++)
+        {
+            rvec_sub(x[ddd->don[i]], x[ddd->hydro[i][k]], dx);
+            if (bBox)
+            {
+                pbc_correct_gem(dx, box, hbox);
+            }
+            dmax2 = std::max(dmax2, norm2(dx));
+        }
+    }
+    return std::sqrt(dmax2);
+}
+
 /* Added argument r2cut, changed contact and implemented
  * use of second cut-off.
  * - Erik Marklund, June 29, 2006
@@ -1402,69 +1214,32 @@ static int is_hbond(t_hbdata* hb,
 /* Merging is now done on the fly, so do_merge is most likely obsolete now.
  * Will do some more testing before removing the function entirely.
  * - Erik Marklund, MAY 10 2010 */
-static void do_merge(t_hbdata* hb, int ntmp, bool htmp[], bool gtmp[], t_hbond* hb0, t_hbond* hb1)
+static void do_merge(t_hbond* hb0, t_hbond* hb1)
 {
     /* Here we need to make sure we're treating periodicity in
      * the right way for the geminate recombination kinetics. */
 
-    int m, mm, n00, n01, nn0, nnframes;
+    int n00, n01, nn0, nnframes;
 
     /* Decide where to start from when merging */
     n00      = hb0->n0;
     n01      = hb1->n0;
     nn0      = std::min(n00, n01);
     nnframes = std::max(n00 + hb0->nframes, n01 + hb1->nframes) - nn0;
-    /* Initiate tmp arrays */
-    for (m = 0; (m < ntmp); m++)
-    {
-        htmp[m] = false;
-        gtmp[m] = false;
-    }
-    /* Fill tmp arrays with values due to first HB */
-    /* Once again '<' had to be replaced with '<='
-       to catch the last frame in which the hbond
-       appears.
-       - Erik Marklund, June 1, 2006 */
-    for (m = 0; (m <= hb0->nframes); m++)
-    {
-        mm       = m + n00 - nn0;
-        htmp[mm] = is_hb(hb0->h[0], m);
-    }
-    for (m = 0; (m <= hb0->nframes); m++)
-    {
-        mm       = m + n00 - nn0;
-        gtmp[mm] = is_hb(hb0->g[0], m);
-    }
-    /* Next HB */
-    for (m = 0; (m <= hb1->nframes); m++)
-    {
-        mm       = m + n01 - nn0;
-        htmp[mm] = htmp[mm] || is_hb(hb1->h[0], m);
-        gtmp[mm] = gtmp[mm] || is_hb(hb1->g[0], m);
-    }
-    /* Reallocate target array */
-    if (nnframes > hb0->maxframes)
-    {
-        srenew(hb0->h[0], 4 + nnframes / hb->wordlen);
-        srenew(hb0->g[0], 4 + nnframes / hb->wordlen);
-    }
 
-    /* Copy temp array to target array */
-    for (m = 0; (m <= nnframes); m++)
-    {
-        _set_hb(hb0->h[0], m, htmp[m]);
-        _set_hb(hb0->g[0], m, gtmp[m]);
-    }
+    /* The existence is stored with absolute frame numbers,
+     * so the intervals of both bonds can be combined directly. */
+    merge_hbexist(hb0->h[0], hb1->h[0]);
+    merge_hbexist(hb0->g[0], hb1->g[0]);
 
     /* Set scalar variables */
-    hb0->n0        = nn0;
-    hb0->maxframes = nnframes;
+    hb0->n0      = nn0;
+    hb0->nframes = nnframes;
 }
 
 static void merge_hb(t_hbdata* hb, gmx_bool bTwo, gmx_bool bContact)
 {
-    int      i, inrnew, indnew, j, ii, jj, id, ia, ntmp;
-    bool *   htmp, *gtmp;
+    int      i, inrnew, indnew, j, ii, jj, id, ia;
     t_hbond *hb0, *hb1;
 
     inrnew = hb->nrhb;
@@ -1473,9 +1248,6 @@ static void merge_hb(t_hbdata* hb, gmx_bool bTwo, gmx_bool bContact)
     /* Check whether donors are also acceptors */
     printf("Merging hbonds with Acceptor and Donor swapped\n");
 
-    ntmp = 2 * hb->max_frames;
-    snew(gtmp, ntmp);
-    snew(htmp, ntmp);
     for (i = 0; (i < hb->d.nrd); i++)
     {
         fprintf(stderr, "\r%d/%d", i + 1, hb->d.nrd);
@@ -1493,7 +1265,7 @@ static void merge_hb(t_hbdata* hb, gmx_bool bTwo, gmx_bool bContact)
                 hb1 = hb->hbmap[jj][ii];
                 if (hb0 && hb1 && ISHB(hb0->history[0]) && ISHB(hb1->history[0]))
                 {
-                    do_merge(hb, ntmp, htmp, gtmp, hb0, hb1);
+                    do_merge(hb0, hb1);
                     if (ISHB(hb1->history[0]))
                     {
                         inrnew--;
@@ -1510,8 +1282,8 @@ static void merge_hb(t_hbdata* hb, gmx_bool bTwo, gmx_bool bContact)
                     {
                         gmx_incons("Neither hydrogen bond nor distance");
                     }
-                    sfree(hb1->h[0]);
-                    sfree(hb1->g[0]);
+                    free_hbexist(&hb1->h[0]);
+                    free_hbexist(&hb1->g[0]);
                     hb1->h[0]       = nullptr;
                     hb1->g[0]       = nullptr;
                     hb1->history[0] = hbNo;
@@ -1524,8 +1296,6 @@ static void merge_hb(t_hbdata* hb, gmx_bool bTwo, gmx_bool bContact)
     printf("- Reduced number of distances from %d to %d\n", hb->nrdist, indnew);
     hb->nrhb   = inrnew;
     hb->nrdist = indnew;
-    sfree(gtmp);
-    sfree(htmp);
 }
 
 static void do_nhb_dist(FILE* fp, t_hbdata* hb, real t)
@@ -1560,12 +1330,12 @@ static void do_hblife(const char* fn, t_hbdata* hb, gmx_bool bMerge, gmx_bool bC
     FILE*          fp;
     const char*    leg[] = { "p(t)", "t p(t)" };
     int*           histo;
-    int            i, j, j0, k, m, nh, ihb, ohb, nhydro, ndump = 0;
-    int            nframes = hb->nframes;
-    unsigned int** h;
-    real           t, x1, dt;
-    double         sum, integral;
-    t_hbond*       hbh;
+    int         i, j, j0, k, m, nh, nhydro, ndump = 0;
+    int         nframes = hb->nframes;
+    t_hbexist** h;
+    real        t, x1, dt;
+    double      sum, integral;
+    t_hbond*    hbh;
 
     snew(h, hb->maxhydro);
     snew(histo, nframes + 1);
@@ -1602,27 +1372,18 @@ static void do_hblife(const char* fn, t_hbdata* hb, gmx_bool bMerge, gmx_bool bC
                 }
                 for (nh = 0; (nh < nhydro); nh++)
                 {
-                    ohb = 0;
-                    j0  = 0;
-
-                    for (j = 0; (j <= hbh->nframes); j++)
+                    /* Each interval is one uninterrupted lifetime. Only count
+                     * the ones that were seen breaking within the frames
+                     * analyzed for this bond. */
+                    for (j = 0; (j < h[nh]->nr); j++)
                     {
-                        ihb = static_cast<int>(is_hb(h[nh], j));
                         if (debug && (ndump < 10))
                         {
-                            fprintf(debug, "%5d  %5d\n", j, ihb);
+                            fprintf(debug, "%5d  %5d\n", h[nh]->begin[j], h[nh]->end[j]);
                         }
-                        if (ihb != ohb)
+                        if (h[nh]->end[j] <= hbh->n0 + hbh->nframes)
                         {
-                            if (ihb)
-                            {
-                                j0 = j;
-                            }
-                            else
-                            {
-                                histo[j - j0]++;
-                            }
-                            ohb = ihb;
+                            histo[h[nh]->end[j] - h[nh]->begin[j]]++;
                         }
                     }
                     ndump++;
@@ -1699,8 +1460,8 @@ static void dump_ac(t_hbdata* hb, gmx_bool oneHB, int nDump)
                 {
                     if (hbh->h[0])
                     {
-                        ihb    = static_cast<int>(is_hb(hbh->h[0], j));
-                        idist  = static_cast<int>(is_hb(hbh->g[0], j));
+                        ihb    = static_cast<int>(is_hb(hbh->h[0], hbh->n0 + j));
+                        idist  = static_cast<int>(is_hb(hbh->g[0], hbh->n0 + j));
                         bPrint = TRUE;
                     }
                 }
@@ -1708,10 +1469,12 @@ static void dump_ac(t_hbdata* hb, gmx_bool oneHB, int nDump)
                 {
                     for (m = 0; (m < hb->maxhydro) && !ihb; m++)
                     {
-                        ihb   = static_cast<int>((ihb != 0)
-                                               || (((hbh->h[m]) != nullptr) && is_hb(hbh->h[m], j)));
-                        idist = static_cast<int>((idist != 0)
-                                                 || (((hbh->g[m]) != nullptr) && is_hb(hbh->g[m], j)));
+                        ihb   = static_cast<int>(
+                                (ihb != 0)
+                                || (((hbh->h[m]) != nullptr) && is_hb(hbh->h[m], hbh->n0 + j)));
+                        idist = static_cast<int>(
+                                (idist != 0)
+                                || (((hbh->g[m]) != nullptr) && is_hb(hbh->g[m], hbh->n0 + j)));
                     }
                     /* This is not correct! */
                     /* What isn't correct? -Erik M */
@@ -1970,7 +1733,7 @@ static void do_hbac(const char*             fn,
                     int                     nThreads)
 {
     FILE* fp;
-    int   i, j, k, m, ihb, idist, n2, nn;
+    int   i, j, k, m, n2, nn;
 
     const char* legLuzar[] = { "Ac\\sfin sys\\v{}\\z{}(t)", "Ac(t)", "Cc\\scontact,hb\\v{}\\z{}(t)",
                                "-dAc\\sfs\\v{}\\z{}/dt" };
@@ -1980,11 +1743,11 @@ static void do_hbac(const char*             fn,
     real *      ct, tail, tail2, dtail, *cct;
     const real  tol     = 1e-3;
     int         nframes = hb->nframes;
-    unsigned int **h = nullptr, **g = nullptr;
-    int            nh, nhbonds, nhydro;
-    t_hbond*       hbh;
-    int            acType;
-    int*           dondata = nullptr;
+    t_hbexist **h = nullptr, **g = nullptr;
+    int         nh, nhbonds, nhydro;
+    t_hbond*    hbh;
+    int         acType;
+    int*        dondata = nullptr;
 
     enum
     {
@@ -2103,30 +1866,24 @@ static void do_hbac(const char*             fn,
                         fflush(stderr);
                     }
                     nhbonds++;
+                    /* Expand the existence intervals, relative to the first
+                     * frame of this bond, into h(t) and g(t) */
+                    hbexist_to_real(h[nh], hbh->n0, nf + 1, nframes, ht);
+                    hbexist_to_real(g[nh], hbh->n0, nf + 1, nframes, gt);
                     for (j = 0; (j < nframes); j++)
                     {
-                        if (j <= nf)
-                        {
-                            ihb   = static_cast<int>(is_hb(h[nh], j));
-                            idist = static_cast<int>(is_hb(g[nh], j));
-                        }
-                        else
-                        {
-                            ihb = idist = 0;
-                        }
-                        rhbex[j] = ihb;
+                        rhbex[j] = ht[j];
                         /* For contacts: if a second cut-off is provided, use it,
                          * otherwise use g(t) = 1-h(t) */
                         if (!R2 && bContact)
                         {
-                            gt[j] = 1 - ihb;
+                            gt[j] = 1 - ht[j];
                         }
                         else
                         {
-                            gt[j] = idist * (1 - ihb);
+                            gt[j] = gt[j] * (1 - ht[j]);
                         }
-                        ht[j] = rhbex[j];
-                        nhb += ihb;
+                        nhb += ht[j];
                     }
 
                     /* The autocorrelation function is normalized after summation only */
@@ -2392,31 +2149,6 @@ static void dump_hbmap(t_hbdata*      hb,
     }
 }
 
-/* sync_hbdata() updates the parallel t_hbdata p_hb using hb as template.
- * It mimics add_frames() and init_frame() to some extent. */
-static void sync_hbdata(t_hbdata* p_hb, int nframes)
-{
-    if (nframes >= p_hb->max_frames)
-    {
-        p_hb->max_frames += 4096;
-        srenew(p_hb->nhb, p_hb->max_frames);
-        srenew(p_hb->ndist, p_hb->max_frames);
-        srenew(p_hb->n_bound, p_hb->max_frames);
-        srenew(p_hb->nhx, p_hb->max_frames);
-        if (p_hb->bDAnr)
-        {
-            srenew(p_hb->danr, p_hb->max_frames);
-        }
-        std::memset(&(p_hb->nhb[nframes]), 0, sizeof(int) * (p_hb->max_frames - nframes));
-        std::memset(&(p_hb->ndist[nframes]), 0, sizeof(int) * (p_hb->max_frames - nframes));
-        p_hb->nhb[nframes]   = 0;
-        p_hb->ndist[nframes] = 0;
-    }
-    p_hb->nframes = nframes;
-
-    std::memset(&(p_hb->nhx[nframes]), 0, sizeof(int) * max_hx); /* zero the helix count for this frame */
-}
-
 int gmx_hbond(int argc, char* argv[])
 {
     const char* desc[] = {
@@ -2605,29 +2337,22 @@ int gmx_hbond(int argc, char* argv[])
     int**             index;
     rvec *            x, hbox;
     matrix            box;
-    real              t, ccut, dist = 0.0, ang = 0.0;
+    t_pbc             pbc;
+    real              t, ccut, searchCutoff, dist = 0.0, ang = 0.0;
     double            max_nhb, aver_nhb, aver_dist;
-    int               h = 0, i = 0, j, k = 0, ogrp, nsel;
-    int               xi = 0, yi, zi, ai;
-    int               xj, yj, zj, aj, xjj, yjj, zjj;
-    gmx_bool          bSelected, bHBmap, bStop, bTwo, bBox, bTric;
+    int               h = 0, i = 0, j, nsel;
+    gmx_bool          bSelected, bHBmap, bStop, bTwo, bBox;
     int *             adist, *rdist;
-    int               grp, nabin, nrbin, resdist, ihb;
+    int               nabin, nrbin, ihb;
     char**            leg;
     t_hbdata*         hb;
     FILE *            fp, *fpnhb = nullptr, *donor_properties = nullptr;
-    t_gridcell***     grid;
-    t_ncell *         icell, *jcell;
-    ivec              ngrid;
     unsigned char*    datable;
     gmx_output_env_t* oenv;
     int               ii, hh, actual_nThreads;
-    int               threadNr = 0;
-    gmx_bool          bParallel;
-    gmx_bool          bEdge_yjj, bEdge_xjj;
 
-    t_hbdata** p_hb    = nullptr; /* one per thread, then merge after the frame loop */
-    int **     p_adist = nullptr, **p_rdist = nullptr; /* a histogram for each thread. */
+    std::vector<int> donors, acceptors; /* donors and acceptors within the shell */
+    std::vector<std::vector<t_hbcandidate>> p_found; /* bonds found by each thread */
 
     const bool bOMP = GMX_OPENMP;
 
@@ -2848,393 +2573,192 @@ int gmx_hbond(int argc, char* argv[])
     }
 
     bBox  = (ir->ePBC != epbcNONE);
-    grid  = init_grid(bBox, box, (rcut > r2cut) ? rcut : r2cut, ngrid);
     nabin = static_cast<int>(acut / abin);
     nrbin = static_cast<int>(rcut / rbin);
     snew(adist, nabin + 1);
     snew(rdist, nrbin + 1);
 
-#if !GMX_OPENMP
-#    define __ADIST adist
-#    define __RDIST rdist
-#    define __HBDATA hb
-#else /* GMX_OPENMP ==================================================    \
-       * Set up the OpenMP stuff,                                       | \
-       * like the number of threads and such                            | \
-       * Also start the parallel loop.                                  | \
-       */
-#    define __ADIST p_adist[threadNr]
-#    define __RDIST p_rdist[threadNr]
-#    define __HBDATA p_hb[threadNr]
-#endif
-    if (bOMP)
+    for (int m = 0; m < DIM; m++)
     {
-        bParallel = !bSelected;
-
-        if (bParallel)
-        {
-            actual_nThreads = std::min((nThreads <= 0) ? INT_MAX : nThreads, gmx_omp_get_max_threads());
-
-            gmx_omp_set_num_threads(actual_nThreads);
-            printf("Frame loop parallelized with OpenMP using %i threads.\n", actual_nThreads);
-            fflush(stdout);
-        }
-        else
-        {
-            actual_nThreads = 1;
-        }
-
-        snew(p_hb, actual_nThreads);
-        snew(p_adist, actual_nThreads);
-        snew(p_rdist, actual_nThreads);
-        for (i = 0; i < actual_nThreads; i++)
-        {
-            snew(p_hb[i], 1);
-            snew(p_adist[i], nabin + 1);
-            snew(p_rdist[i], nrbin + 1);
-
-            p_hb[i]->max_frames = 0;
-            p_hb[i]->nhb        = nullptr;
-            p_hb[i]->ndist      = nullptr;
-            p_hb[i]->n_bound    = nullptr;
-            p_hb[i]->time       = nullptr;
-            p_hb[i]->nhx        = nullptr;
+        hbox[m] = box[m][m] * 0.5;
+    }
+    searchCutoff = (rcut > r2cut) ? rcut : r2cut;
+    std::unique_ptr<gmx::AnalysisNeighborhood> nb;
+    gmx::AnalysisNeighborhoodPairList          pairs;
 
-            p_hb[i]->bHBmap   = hb->bHBmap;
-            p_hb[i]->bDAnr    = hb->bDAnr;
-            p_hb[i]->wordlen  = hb->wordlen;
-            p_hb[i]->nframes  = hb->nframes;
-            p_hb[i]->maxhydro = hb->maxhydro;
-            p_hb[i]->danr     = hb->danr;
-            p_hb[i]->d        = hb->d;
-            p_hb[i]->a        = hb->a;
-            p_hb[i]->hbmap    = hb->hbmap;
-            p_hb[i]->time     = hb->time; /* This may need re-syncing at every frame. */
+    if (bOMP && !bSelected)
+    {
+        actual_nThreads = std::min((nThreads <= 0) ? INT_MAX : nThreads, gmx_omp_get_max_threads());
 
-            p_hb[i]->nrhb   = 0;
-            p_hb[i]->nrdist = 0;
-        }
+        gmx_omp_set_num_threads(actual_nThreads);
+        printf("Frame loop parallelized with OpenMP using %i threads.\n", actual_nThreads);
+        fflush(stdout);
     }
+    else
+    {
+        actual_nThreads = 1;
+    }
+    p_found.resize(actual_nThreads);
 
-    /* Make a thread pool here,
-     * instead of forking anew at every frame. */
-
-#pragma omp parallel firstprivate(i) private(                                                   \
-        j, h, ii, hh, xi, yi, zi, xj, yj, zj, threadNr, dist, ang, icell, jcell, grp, ogrp, ai, \
-        aj, xjj, yjj, zjj, ihb, resdist, k, bTric, bEdge_xjj, bEdge_yjj) default(shared)
-    { /* Start of parallel region */
-        if (bOMP)
+    do
+    {
+        for (int m = 0; m < DIM; m++)
         {
-            threadNr = gmx_omp_get_thread_num();
+            hbox[m] = box[m][m] * 0.5;
         }
-        do
+        if (bBox)
         {
+            set_pbc(&pbc, ir->ePBC, box);
+        }
+        reset_nhbonds(&(hb->d));
 
-            bTric = bBox && TRICLINIC(box);
+        add_frames(hb, nframes);
+        init_hbframe(hb, nframes, output_env_conv_time(oenv, t));
 
-            if (bOMP)
+        if (bSelected)
+        {
+            /* Do not parallelize this just yet. */
+            for (ii = 0; (ii < nsel); ii++)
             {
-                try
+                int dd       = index[0][i];
+                int aa       = index[0][i + 2];
+                /* int */ hh = index[0][i + 1];
+                ihb = is_hbond(hb, ii, ii, dd, aa, rcut, r2cut, ccut, x, bBox, box, hbox, &dist,
+                               &ang, bDA, &h, bContact, bMerge);
+
+                if (ihb)
                 {
-                    sync_hbdata(p_hb[threadNr], nframes);
+                    /* add to index if not already there */
+                    /* Add a hbond */
+                    add_hbond(hb, dd, aa, hh, ii, ii, nframes, bMerge, ihb, bContact);
                 }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
             }
-#pragma omp single
+        } /* if (bSelected) */
+        else
+        {
+            select_in_shell(hb->d.nrd, hb->d.don, x, x[shatom], bBox, box, hbox, rshell, &donors);
+            select_in_shell(hb->a.nra, hb->a.acc, x, x[shatom], bBox, box, hbox, rshell,
+                            &acceptors);
+            if (hb->bDAnr)
             {
-                try
+                for (int gr = 0; (gr < grNR); gr++)
                 {
-                    build_grid(hb, x, x[shatom], bBox, box, hbox, (rcut > r2cut) ? rcut : r2cut,
-                               rshell, ngrid, grid);
-                    reset_nhbonds(&(hb->d));
-
-                    if (debug && bDebug)
-                    {
-                        dump_grid(debug, ngrid, grid);
-                    }
-
-                    add_frames(hb, nframes);
-                    init_hbframe(hb, nframes, output_env_conv_time(oenv, t));
-
-                    if (hb->bDAnr)
-                    {
-                        count_da_grid(ngrid, grid, hb->danr[nframes]);
-                    }
+                    hb->danr[nframes][gr] = static_cast<int>(donors.size());
                 }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-            } /* omp single */
-
-            if (bOMP)
-            {
-                p_hb[threadNr]->time = hb->time; /* This pointer may have changed. */
             }
 
-            if (bSelected)
-            {
-
-#pragma omp single
-                {
-                    try
-                    {
-                        /* Do not parallelize this just yet. */
-                        /* int ii; */
-                        for (ii = 0; (ii < nsel); ii++)
-                        {
-                            int dd       = index[0][i];
-                            int aa       = index[0][i + 2];
-                            /* int */ hh = index[0][i + 1];
-                            ihb = is_hbond(hb, ii, ii, dd, aa, rcut, r2cut, ccut, x, bBox, box,
-                                           hbox, &dist, &ang, bDA, &h, bContact, bMerge);
-
-                            if (ihb)
-                            {
-                                /* add to index if not already there */
-                                /* Add a hbond */
-                                add_hbond(hb, dd, aa, hh, ii, ii, nframes, bMerge, ihb, bContact);
-                            }
-                        }
-                    }
-                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-                } /* omp single */
-            }     /* if (bSelected) */
-            else
+            if (!bDA && !bContact)
             {
-                /* The outer grid loop will have to do for now. */
-#pragma omp for schedule(dynamic)
-                for (xi = 0; xi < ngrid[XX]; xi++)
+                /* The cut-off is applied to the hydrogen-acceptor distance, so
+                 * donors need to be searched further out by the longest
+                 * donor-hydrogen distance in this frame. The cut-off can not
+                 * be changed after the first search, so the search is
+                 * recreated, with some margin for bond vibrations, whenever
+                 * the bonds have stretched beyond it. */
+                real maxDonorHydrogen = max_donor_hydrogen_distance(&hb->d, x, bBox, box, hbox);
+                if (rcut + maxDonorHydrogen > searchCutoff)
                 {
-                    try
-                    {
-                        for (yi = 0; (yi < ngrid[YY]); yi++)
-                        {
-                            for (zi = 0; (zi < ngrid[ZZ]); zi++)
-                            {
-
-                                /* loop over donor groups gr0 (always) and gr1 (if necessary) */
-                                for (grp = gr0; (grp <= (bTwo ? gr1 : gr0)); grp++)
-                                {
-                                    icell = &(grid[zi][yi][xi].d[grp]);
-
-                                    if (bTwo)
-                                    {
-                                        ogrp = 1 - grp;
-                                    }
-                                    else
-                                    {
-                                        ogrp = grp;
-                                    }
-
-                                    /* loop over all hydrogen atoms from group (grp)
-                                     * in this gridcell (icell)
-                                     */
-                                    for (ai = 0; (ai < icell->nr); ai++)
-                                    {
-                                        i = icell->atoms[ai];
-
-                                        /* loop over all adjacent gridcells (xj,yj,zj) */
-                                        for (zjj = grid_loop_begin(ngrid[ZZ], zi, bTric, FALSE);
-                                             zjj <= grid_loop_end(ngrid[ZZ], zi, bTric, FALSE); zjj++)
-                                        {
-                                            zj        = grid_mod(zjj, ngrid[ZZ]);
-                                            bEdge_yjj = (zj == 0) || (zj == ngrid[ZZ] - 1);
-                                            for (yjj = grid_loop_begin(ngrid[YY], yi, bTric, bEdge_yjj);
-                                                 yjj <= grid_loop_end(ngrid[YY], yi, bTric, bEdge_yjj);
-                                                 yjj++)
-                                            {
-                                                yj        = grid_mod(yjj, ngrid[YY]);
-                                                bEdge_xjj = (yj == 0) || (yj == ngrid[YY] - 1)
-                                                            || (zj == 0) || (zj == ngrid[ZZ] - 1);
-                                                for (xjj = grid_loop_begin(ngrid[XX], xi, bTric, bEdge_xjj);
-                                                     xjj <= grid_loop_end(ngrid[XX], xi, bTric, bEdge_xjj);
-                                                     xjj++)
-                                                {
-                                                    xj    = grid_mod(xjj, ngrid[XX]);
-                                                    jcell = &(grid[zj][yj][xj].a[ogrp]);
-                                                    /* loop over acceptor atoms from other group
-                                                     * (ogrp) in this adjacent gridcell (jcell)
-                                                     */
-                                                    for (aj = 0; (aj < jcell->nr); aj++)
-                                                    {
-                                                        j = jcell->atoms[aj];
-
-                                                        /* check if this once was a h-bond */
-                                                        ihb = is_hbond(__HBDATA, grp, ogrp, i, j,
-                                                                       rcut, r2cut, ccut, x, bBox,
-                                                                       box, hbox, &dist, &ang, bDA,
-                                                                       &h, bContact, bMerge);
-
-                                                        if (ihb)
-                                                        {
-                                                            /* add to index if not already there */
-                                                            /* Add a hbond */
-                                                            add_hbond(__HBDATA, i, j, h, grp, ogrp,
-                                                                      nframes, bMerge, ihb, bContact);
-
-                                                            /* make angle and distance distributions */
-                                                            if (ihb == hbHB && !bContact)
-                                                            {
-                                                                if (dist > rcut)
-                                                                {
-                                                                    gmx_fatal(
-                                                                            FARGS,
-                                                                            "distance is higher "
-                                                                            "than what is allowed "
-                                                                            "for an hbond: %f",
-                                                                            dist);
-                                                                }
-                                                                ang *= RAD2DEG;
-                                                                __ADIST[static_cast<int>(ang / abin)]++;
-                                                                __RDIST[static_cast<int>(dist / rbin)]++;
-                                                                if (!bTwo)
-                                                                {
-                                                                    if (donor_index(&hb->d, grp, i) == NOTSET)
-                                                                    {
-                                                                        gmx_fatal(
-                                                                                FARGS,
-                                                                                "Invalid donor %d", i);
-                                                                    }
-                                                                    if (acceptor_index(&hb->a, ogrp, j)
-                                                                        == NOTSET)
-                                                                    {
-                                                                        gmx_fatal(FARGS,
-                                                                                  "Invalid "
-                                                                                  "acceptor %d",
-                                                                                  j);
-                                                                    }
-                                                                    resdist = std::abs(
-                                                                            top.atoms.atom[i].resind
-                                                                            - top.atoms.atom[j].resind);
-                                                                    if (resdist >= max_hx)
-                                                                    {
-                                                                        resdist = max_hx - 1;
-                                                                    }
-                                                                    __HBDATA->nhx[nframes][resdist]++;
-                                                                }
-                                                            }
-                                                        }
-                                                    } /* for aj  */
-                                                }     /* for xjj */
-                                            }         /* for yjj */
-                                        }             /* for zjj */
-                                    }                 /* for ai  */
-                                }                     /* for grp */
-                            }                         /* for xi,yi,zi */
-                        }
-                    }
-                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+                    searchCutoff = std::max(r2cut, rcut + 1.2F * maxDonorHydrogen);
+                    nb.reset();
                 }
-            } /* if (bSelected) {...} else */
+            }
+            if (!nb)
+            {
+                nb = std::make_unique<gmx::AnalysisNeighborhood>();
+                nb->setCutoff(searchCutoff);
+            }
 
+            /* Find all donor-acceptor pairs that can be within the cut-off */
+            gmx::AnalysisNeighborhoodPositions acceptorPositions(x, natoms);
+            gmx::AnalysisNeighborhoodPositions donorPositions(x, natoms);
+            gmx::AnalysisNeighborhoodSearch    search =
+                    nb->initSearch(bBox ? &pbc : nullptr, acceptorPositions.indexed(acceptors));
+            search.findAllPairs(donorPositions.indexed(donors), &pairs);
 
-            /* Better wait for all threads to finnish using x[] before updating it. */
-            k = nframes;
-#pragma omp barrier
-#pragma omp critical
+            /* Check the pairs in parallel, each thread collecting the bonds
+             * it finds in its own buffer, so no data is shared while searching */
+            const int npairs = pairs.size();
+#pragma omp parallel for num_threads(actual_nThreads) schedule(static)
+            for (int thread = 0; thread < actual_nThreads; thread++)
             {
                 try
                 {
-                    /* Sum up histograms and counts from p_hb[] into hb */
-                    if (bOMP)
+                    std::vector<t_hbcandidate>& found = p_found[thread];
+                    int                         pairBegin = (npairs * thread) / actual_nThreads;
+                    int                         pairEnd = (npairs * (thread + 1)) / actual_nThreads;
+
+                    found.clear();
+                    for (int p = pairBegin; p < pairEnd; p++)
                     {
-                        hb->nhb[k] += p_hb[threadNr]->nhb[k];
-                        hb->ndist[k] += p_hb[threadNr]->ndist[k];
-                        for (j = 0; j < max_hx; j++)
+                        t_hbcandidate c;
+                        c.d    = donors[pairs.testIndices()[p]];
+                        c.a    = acceptors[pairs.refIndices()[p]];
+                        c.grpd = hb->d.grp[hb->d.dptr[c.d]];
+                        /* With two groups, donors of one group bind to acceptors of the other */
+                        c.grpa = bTwo ? 1 - c.grpd : c.grpd;
+                        c.ihb  = is_hbond(hb, c.grpd, c.grpa, c.d, c.a, rcut, r2cut, ccut, x, bBox,
+                                         box, hbox, &c.dist, &c.ang, bDA, &c.h, bContact, bMerge);
+                        if (c.ihb)
                         {
-                            hb->nhx[k][j] += p_hb[threadNr]->nhx[k][j];
+                            found.push_back(c);
                         }
                     }
                 }
                 GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
             }
 
-            /* Here are a handful of single constructs
-             * to share the workload a bit. The most
-             * important one is of course the last one,
-             * where there's a potential bottleneck in form
-             * of slow I/O.                    */
-#pragma omp barrier
-#pragma omp single
+            /* Add the bonds in pair order, independent of the number of threads */
+            for (const std::vector<t_hbcandidate>& found : p_found)
             {
-                try
+                for (const t_hbcandidate& c : found)
                 {
-                    analyse_donor_properties(donor_properties, hb, k, t);
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-            }
+                    /* Add a hbond */
+                    add_hbond(hb, c.d, c.a, c.h, c.grpd, c.grpa, nframes, bMerge, c.ihb, bContact);
 
-#pragma omp single
-            {
-                try
-                {
-                    if (fpnhb)
+                    /* make angle and distance distributions */
+                    if (c.ihb == hbHB && !bContact)
                     {
-                        do_nhb_dist(fpnhb, hb, t);
+                        if (c.dist > rcut)
+                        {
+                            gmx_fatal(FARGS,
+                                      "distance is higher than what is allowed for an hbond: %f",
+                                      c.dist);
+                        }
+                        adist[static_cast<int>(c.ang * RAD2DEG / abin)]++;
+                        rdist[static_cast<int>(c.dist / rbin)]++;
+                        if (!bTwo)
+                        {
+                            if (donor_index(&hb->d, c.grpd, c.d) == NOTSET)
+                            {
+                                gmx_fatal(FARGS, "Invalid donor %d", c.d);
+                            }
+                            if (acceptor_index(&hb->a, c.grpa, c.a) == NOTSET)
+                            {
+                                gmx_fatal(FARGS, "Invalid acceptor %d", c.a);
+                            }
+                            int resdist = std::abs(top.atoms.atom[c.d].resind
+                                                   - top.atoms.atom[c.a].resind);
+                            if (resdist >= max_hx)
+                            {
+                                resdist = max_hx - 1;
+                            }
+                            hb->nhx[nframes][resdist]++;
+                        }
                     }
                 }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-            }
-
-#pragma omp single
-            {
-                try
-                {
-                    trrStatus = (read_next_x(oenv, status, &t, x, box));
-                    nframes++;
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
             }
+        } /* if (bSelected) {...} else */
 
-#pragma omp barrier
-        } while (trrStatus);
+        analyse_donor_properties(donor_properties, hb, nframes, t);
 
-        if (bOMP)
+        if (fpnhb)
         {
-#pragma omp critical
-            {
-                hb->nrhb += p_hb[threadNr]->nrhb;
-                hb->nrdist += p_hb[threadNr]->nrdist;
-            }
-
-            /* Free parallel datastructures */
-            sfree(p_hb[threadNr]->nhb);
-            sfree(p_hb[threadNr]->ndist);
-            sfree(p_hb[threadNr]->nhx);
-
-#pragma omp for
-            for (i = 0; i < nabin; i++)
-            {
-                try
-                {
-                    for (j = 0; j < actual_nThreads; j++)
-                    {
-
-                        adist[i] += p_adist[j][i];
-                    }
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-            }
-#pragma omp for
-            for (i = 0; i <= nrbin; i++)
-            {
-                try
-                {
-                    for (j = 0; j < actual_nThreads; j++)
-                    {
-                        rdist[i] += p_rdist[j][i];
-                    }
-                }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
-            }
-
-            sfree(p_adist[threadNr]);
-            sfree(p_rdist[threadNr]);
+            do_nhb_dist(fpnhb, hb, t);
         }
-    } /* End of parallel region */
-    if (bOMP)
-    {
-        sfree(p_adist);
-        sfree(p_rdist);
-    }
+
+        trrStatus = (read_next_x(oenv, status, &t, x, box));
+        nframes++;
+    } while (trrStatus);
 
     if (nframes < 2 && (opt2bSet("-ac", NFILE, fnm) || opt2bSet("-life", NFILE, fnm)))
     {
@@ -3242,8 +2766,6 @@ int gmx_hbond(int argc, char* argv[])
                   "Cannot calculate autocorrelation of life times with less than two frames");
     }
 
-    free_grid(ngrid, &grid);
-
     close_trx(status);
 
     if (donor_properties)
@@ -3426,12 +2948,17 @@ int gmx_hbond(int argc, char* argv[])
                             {
                                 if (ISHB(hb->hbmap[id][ia]->history[hh]))
                                 {
-                                    for (x = 0; (x <= hb->hbmap[id][ia]->nframes); x++)
+                                    const t_hbexist* hbexist = hb->hbmap[id][ia]->h[hh];
+                                    int              nn0     = hb->hbmap[id][ia]->n0;
+                                    int last = std::min(nn0 + hb->hbmap[id][ia]->nframes + 1, mat.nx);
+                                    range_check(y, 0, mat.ny);
+                                    for (int n = 0; (n < hbexist->nr); n++)
                                     {
-                                        int nn0 = hb->hbmap[id][ia]->n0;
-                                        range_check(y, 0, mat.ny);
-                                        mat.matrix(x + nn0, y) = static_cast<t_matelmt>(
-                                                is_hb(hb->hbmap[id][ia]->h[hh], x));
+                                        for (x = std::max(hbexist->begin[n], nn0);
+                                             (x < std::min(hbexist->end[n], last)); x++)
+                                        {
+                                            mat.matrix(x, y) = 1;
+                                        }
                                     }
                                     y++;
                                 }
@@ -0,0 +1,129 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx hbond.
+ */
+
+#include "gmxpre.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/gmxpreprocess/grompp.h"
+#include "gromacs/utility/path.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/refdata.h"
+#include "testutils/stdiohelper.h"
+#include "testutils/testfilemanager.h"
+#include "testutils/xvgtest.h"
+
+namespace
+{
+
+using gmx::test::CommandLine;
+using gmx::test::StdioTestHelper;
+using gmx::test::XvgMatch;
+
+class HbondTest : public gmx::test::CommandLineTestBase
+{
+public:
+    HbondTest()
+    {
+        XvgMatch  xvg;
+        XvgMatch& toler = xvg.tolerance(gmx::test::relativeToleranceAsFloatingPoint(1, 1e-4));
+        setOutputFile("-num", "hbnum.xvg", toler);
+        setOutputFile("-life", "hblife.xvg", toler);
+        setOutputFile("-ac", "hbac.xvg", toler);
+        setInputFile("-f", "hbond_traj.xtc");
+    }
+
+    void runTest(const CommandLine& args)
+    {
+        std::string tpr = fileManager().getTemporaryFilePath(".tpr");
+        std::string mdp = fileManager().getTemporaryFilePath(".mdp");
+        FILE*       fp  = fopen(mdp.c_str(), "w");
+        fprintf(fp, "cutoff-scheme = verlet\n");
+        fprintf(fp, "rcoulomb      = 0.8\n");
+        fprintf(fp, "rvdw          = 0.8\n");
+        fclose(fp);
+
+        // Prepare a .tpr file for the 216 water molecules in the trajectory
+        {
+            CommandLine caller;
+            auto        simDB = gmx::test::TestFileManager::getTestSimulationDatabaseDirectory();
+            auto        base  = gmx::Path::join(simDB, "spc216");
+            caller.append("grompp");
+            caller.addOption("-maxwarn", 0);
+            caller.addOption("-f", mdp.c_str());
+            std::string gro = (base + ".gro");
+            caller.addOption("-c", gro.c_str());
+            std::string top = (base + ".top");
+            caller.addOption("-p", top.c_str());
+            caller.addOption("-o", tpr.c_str());
+            ASSERT_EQ(0, gmx_grompp(caller.argc(), caller.argv()));
+        }
+        // Run the hydrogen bond analysis between all water molecules
+        {
+            StdioTestHelper stdioHelper(&fileManager());
+            stdioHelper.redirectStringToStdin("0\n0\n");
+
+            CommandLine& cmdline = commandLine();
+            cmdline.merge(args);
+            cmdline.addOption("-s", tpr.c_str());
+            ASSERT_EQ(0, gmx_hbond(cmdline.argc(), cmdline.argv()));
+            checkOutputFiles();
+        }
+    }
+};
+
+/* hbond_traj.xtc contains 11 frames (0.02 ps per frame) of the 216 water
+ * molecules in spc216.gro, simulated at 300 K. */
+
+TEST_F(HbondTest, DonorAcceptorDistance)
+{
+    const char* const cmdline[] = { "hbond", "-da" };
+    runTest(CommandLine(cmdline));
+}
+
+TEST_F(HbondTest, HydrogenAcceptorDistance)
+{
+    const char* const cmdline[] = { "hbond", "-noda" };
+    runTest(CommandLine(cmdline));
+}
+
+} // namespace
@@ -49,6 +49,7 @@
 
 #include <algorithm>
 #include <array>
+#include <vector>
 
 #include "gromacs/gmxlib/network.h"
 #include "gromacs/gmxlib/nrnb.h"
@@ -576,15 +577,14 @@ void calc_listed_lambda(const t_idef*         idef,
                         const t_forcerec*     fr,
                         const struct t_pbc*   pbc,
                         const struct t_graph* g,
-                        gmx_grppairener_t*    grpp,
-                        real*                 epot,
-                        t_nrnb*               nrnb,
+                        const t_lambda*       fepvals,
                         const real*           lambda,
+                        gmx_enerdata_t*       enerd,
+                        t_nrnb*               nrnb,
                         const t_mdatoms*      md,
                         t_fcdata*             fcd,
                         int*                  global_atom_index)
 {
-    real          v;
     real          dvdl_dum[efptNR] = { 0 };
     rvec4*        f;
     rvec*         fshift;
@@ -601,6 +601,24 @@ void calc_listed_lambda(const t_idef*         idef,
         pbc_null = nullptr;
     }
 
+    /* Set up the lambda values and energy output for each lambda */
+    const int                             numLambdas = enerd->enerpart_lambda.size();
+    std::vector<std::array<real, efptNR>> lambdas(numLambdas);
+    std::vector<gmx_grppairener_t>        grpp(numLambdas, enerd->foreign_grpp);
+    std::vector<std::array<real, F_NRE>>  epot(numLambdas);
+    for (int i = 0; i < numLambdas; i++)
+    {
+        for (int j = 0; j < efptNR; j++)
+        {
+            lambdas[i][j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
+        }
+        for (auto& energies : grpp[i].ener)
+        {
+            std::fill(energies.begin(), energies.end(), 0);
+        }
+        epot[i].fill(0);
+    }
+
     /* Copy the whole idef, so we can modify the contents locally */
     idef_fe = *idef;
 
@@ -628,15 +646,28 @@ void calc_listed_lambda(const t_idef*         idef,
             {
                 gmx::StepWorkload tempFlags;
                 tempFlags.computeEnergy = true;
-                v = calc_one_bond(0, ftype, &idef_fe, workDivision, x, f, fshift, fr, pbc_null, g,
-                                  grpp, nrnb, lambda, dvdl_dum, md, fcd, tempFlags, global_atom_index);
-                epot[ftype] += v;
+                for (int i = 0; i < numLambdas; i++)
+                {
+                    real v = calc_one_bond(0, ftype, &idef_fe, workDivision, x, f, fshift, fr,
+                                           pbc_null, g, &grpp[i], nrnb, lambdas[i].data(),
+                                           dvdl_dum, md, fcd, tempFlags, global_atom_index);
+                    epot[i][ftype] += v;
+                }
             }
         }
     }
 
     sfree(fshift);
     sfree(f);
+
+    for (int i = 0; i < numLambdas; i++)
+    {
+        reset_foreign_enerdata(enerd);
+        enerd->foreign_grpp.ener = grpp[i].ener;
+        std::copy(epot[i].begin(), epot[i].end(), enerd->foreign_term);
+        sum_epot(&(enerd->foreign_grpp), enerd->foreign_term);
+        enerd->enerpart_lambda[i] += enerd->foreign_term[F_EPOT];
+    }
 }
 
 void do_force_listed(struct gmx_wallcycle*    wcycle,
@@ -688,20 +719,8 @@ void do_force_listed(struct gmx_wallcycle*    wcycle,
             {
                 gmx_incons("The bonded interactions are not sorted for free energy");
             }
-            for (size_t i = 0; i < enerd->enerpart_lambda.size(); i++)
-            {
-                real lam_i[efptNR];
-
-                reset_foreign_enerdata(enerd);
-                for (int j = 0; j < efptNR; j++)
-                {
-                    lam_i[j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
-                }
-                calc_listed_lambda(idef, x, fr, pbc, graph, &(enerd->foreign_grpp),
-                                   enerd->foreign_term, nrnb, lam_i, md, fcd, global_atom_index);
-                sum_epot(&(enerd->foreign_grpp), enerd->foreign_term);
-                enerd->enerpart_lambda[i] += enerd->foreign_term[F_EPOT];
-            }
+            calc_listed_lambda(idef, x, fr, pbc, graph, fepvals, lambda, enerd, nrnb, md, fcd,
+                               global_atom_index);
             wallcycle_sub_stop(wcycle, ewcsLISTED_FEP);
         }
     }
@@ -131,19 +131,22 @@ void calc_listed(const t_commrec*         cr,
                  int*                     ddgatindex,
                  const gmx::StepWorkload& stepWork);
 
-/*! \brief As calc_listed(), but only determines the potential energy
- * for the perturbed interactions.
+/*! \brief As calc_listed(), but only determines the potential energies
+ * for the perturbed interactions, at the current and all foreign lambda values.
  *
- * The shift forces in fr are not affected. */
+ * Each interaction list is processed for all lambda values in turn,
+ * so the list and coordinates only need to be read once.
+ * The energy at lambda value i is added to enerd->enerpart_lambda[i].
+ * The forces and shift forces in fr are not affected. */
 void calc_listed_lambda(const t_idef*         idef,
                         const rvec            x[],
                         const t_forcerec*     fr,
                         const struct t_pbc*   pbc,
                         const struct t_graph* g,
-                        gmx_grppairener_t*    grpp,
-                        real*                 epot,
-                        t_nrnb*               nrnb,
+                        const t_lambda*       fepvals,
                         const real*           lambda,
+                        gmx_enerdata_t*       enerd,
+                        t_nrnb*               nrnb,
                         const t_mdatoms*      md,
                         struct t_fcdata*      fcd,
                         int*                  global_atom_index);
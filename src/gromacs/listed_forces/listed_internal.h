@@ -43,6 +43,8 @@
 #ifndef GMX_LISTED_FORCES_LISTED_INTERNAL_H
 #define GMX_LISTED_FORCES_LISTED_INTERNAL_H
 
+#include <cstdio>
+
 #include <memory>
 
 #include "gromacs/math/vectypes.h"
@@ -134,6 +136,11 @@ struct bonded_threading_t
     //! Maximum thread count for uniform distribution of bondeds over threads
     int max_nthread_uniform;
 
+    //! Log file for the estimated load imbalance of the division, can be nullptr
+    FILE* fplog;
+    //! Whether the estimated load imbalance has been reported in fplog
+    bool haveReportedLoadImbalance;
+
     //! The division of work in the t_list over threads.
     WorkDivision workDivision;
 
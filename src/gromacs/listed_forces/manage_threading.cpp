@@ -54,7 +54,10 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/listed_forces/bonded.h"
 #include "gromacs/listed_forces/gpubonded.h"
 #include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/pbcutil/ishift.h"
@@ -73,8 +76,23 @@ typedef struct
     const t_ilist* il;    /**< pointer to t_ilist entry corresponding to ftype */
     int            ftype; /**< the function type index */
     int            nat;   /**< nr of atoms involved in a single ftype interaction */
+    int            cost;  /**< estimated cost of a single ftype interaction */
 } ilist_data_t;
 
+/*! \brief Returns the estimated cost of one interaction of type \p ftype
+ *
+ * We use the flop count estimates, which account for the large cost
+ * differences between e.g. bonds and CMAP. When no estimate is available,
+ * we fall back to the number of atoms involved in the interaction.
+ */
+static int interactionCost(int ftype)
+{
+    const int nrnbIndexForType = nrnbIndex(ftype);
+    const int cost             = (nrnbIndexForType >= 0 ? cost_nrnb(nrnbIndexForType) : 0);
+
+    return (cost > 0 ? cost : NRAL(ftype));
+}
+
 /*! \brief Divides listed interactions over threads
  *
  * This routine attempts to divide all interactions of the numType bondeds
@@ -84,18 +102,18 @@ typedef struct
  */
 static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, const ilist_data_t* ild)
 {
-    int nat_tot, nat_sum;
-    int ind[F_NRE];    /* index into the ild[].il->iatoms */
-    int at_ind[F_NRE]; /* index of the first atom of the interaction at ind */
-    int f, t;
+    int64_t cost_tot, cost_sum;
+    int     ind[F_NRE];    /* index into the ild[].il->iatoms */
+    int     at_ind[F_NRE]; /* index of the first atom of the interaction at ind */
+    int     f, t;
 
     assert(numType <= F_NRE);
 
-    nat_tot = 0;
+    cost_tot = 0;
     for (f = 0; f < numType; f++)
     {
-        /* Sum #bondeds*#atoms_per_bond over all bonded types */
-        nat_tot += ild[f].il->nr / (ild[f].nat + 1) * ild[f].nat;
+        /* Sum #bondeds*cost_per_bond over all bonded types */
+        cost_tot += static_cast<int64_t>(ild[f].il->nr / (ild[f].nat + 1)) * ild[f].cost;
         /* The start bound for thread 0 is 0 for all interactions */
         ind[f] = 0;
         /* Initialize the next atom index array */
@@ -103,7 +121,7 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
         at_ind[f] = ild[f].il->iatoms[1];
     }
 
-    nat_sum = 0;
+    cost_sum = 0;
     /* Loop over the end bounds of the nthreads threads to determine
      * which interactions threads 0 to nthreads shall calculate.
      *
@@ -117,18 +135,13 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
      */
     for (t = 1; t <= bt->nthreads; t++)
     {
-        int nat_thread;
-
-        /* Here we assume that the computational cost is proportional
-         * to the number of atoms in the interaction. This is a rough
-         * measure, but roughly correct. Usually there are very few
-         * interactions anyhow and there are distributed relatively
-         * uniformly. Proper and RB dihedrals are often distributed
-         * non-uniformly, but their cost is roughly equal.
+        /* We weight the interactions by their estimated cost, so types
+         * with expensive interactions, such as CMAP, that are often
+         * distributed non-uniformly, do not cause load imbalance.
          */
-        nat_thread = (nat_tot * t) / bt->nthreads;
+        const int64_t cost_thread = (cost_tot * t) / bt->nthreads;
 
-        while (nat_sum < nat_thread)
+        while (cost_sum < cost_thread)
         {
             /* To divide bonds based on atom order, we compare
              * the index of the first atom in the bonded interaction.
@@ -158,7 +171,7 @@ static void divide_bondeds_by_locality(bonded_threading_t* bt, int numType, cons
              * index f_min) to thread t-1 by increasing ind.
              */
             ind[f_min] += ild[f_min].nat + 1;
-            nat_sum += ild[f_min].nat;
+            cost_sum += ild[f_min].cost;
 
             /* Update the first unassigned atom index for this type */
             if (ind[f_min] < ild[f_min].il->nr)
@@ -285,6 +298,7 @@ static void divide_bondeds_over_threads(bonded_threading_t* bt, bool useGpuForBo
             ild[numType].ftype = fType;
             ild[numType].il    = &il;
             ild[numType].nat   = nat;
+            ild[numType].cost  = interactionCost(fType);
 
             /* The first index for the thread division is always 0 */
             bt->workDivision.setBound(fType, 0, 0);
@@ -320,6 +334,51 @@ static void divide_bondeds_over_threads(bonded_threading_t* bt, bool useGpuForBo
             }
         }
     }
+
+    /* Report the load imbalance based on the cost estimates, in the log only
+     * for the first division, as later divisions after repartitioning are
+     * similar */
+    const bool reportInLog =
+            (bt->fplog != nullptr && !bt->haveReportedLoadImbalance && numThreads > 1);
+    if (debug || reportInLog)
+    {
+        std::vector<int64_t> threadCost(numThreads, 0);
+        for (int f = 0; f < F_NRE; f++)
+        {
+            if (ftype_is_bonded_potential(f) && idef.il[f].nr > 0)
+            {
+                for (int t = 0; t < numThreads; t++)
+                {
+                    const int numInteractions =
+                            (bt->workDivision.bound(f, t + 1) - bt->workDivision.bound(f, t))
+                            / (1 + NRAL(f));
+                    threadCost[t] += static_cast<int64_t>(numInteractions) * interactionCost(f);
+                }
+            }
+        }
+        const int64_t maxCost = *std::max_element(threadCost.begin(), threadCost.end());
+        int64_t       sumCost = 0;
+        for (int64_t cost : threadCost)
+        {
+            sumCost += cost;
+        }
+        if (sumCost > 0)
+        {
+            const double imbalance = maxCost * numThreads / static_cast<double>(sumCost);
+            if (debug)
+            {
+                fprintf(debug, "Estimated bonded thread load imbalance: %.2f\n", imbalance);
+            }
+            if (reportInLog)
+            {
+                fprintf(bt->fplog,
+                        "\nEstimated load imbalance of the bonded interactions over %d threads: "
+                        "%.2f\n",
+                        numThreads, imbalance);
+                bt->haveReportedLoadImbalance = true;
+            }
+        }
+    }
 }
 
 //! Construct a reduction mask for which parts (blocks) of the force array are touched on which thread task
@@ -506,6 +565,8 @@ bonded_threading_t::bonded_threading_t(const int numThreads, const int numEnergy
     nthreads(numThreads),
     nblock_used(0),
     haveBondeds(false),
+    fplog(nullptr),
+    haveReportedLoadImbalance(false),
     workDivision(nthreads),
     foreignLambdaWorkDivision(1)
 {
@@ -536,6 +597,7 @@ bonded_threading_t* init_bonded_threading(FILE* fplog, const int nenergrp)
      * is much larger than the reduction overhead.
      */
     bonded_threading_t* bt = new bonded_threading_t(gmx_omp_nthreads_get(emntBonded), nenergrp);
+    bt->fplog              = fplog;
 
     /* The optimal value after which to switch from uniform to localized
      * bonded interaction distribution is 3, 4 or 5 depending on the system
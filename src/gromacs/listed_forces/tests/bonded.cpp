@@ -43,6 +43,7 @@
 
 #include "gromacs/listed_forces/bonded.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <memory>
@@ -57,6 +58,7 @@
 #include "gromacs/mdtypes/mdatom.h"
 #include "gromacs/pbcutil/ishift.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/simd/simd.h"
 #include "gromacs/topology/idef.h"
 #include "gromacs/utility/strconvert.h"
 #include "gromacs/utility/stringstream.h"
@@ -84,8 +86,8 @@ struct OutputQuantities
     real dvdlambda = 0;
     //! Shift vectors
     rvec fshift[N_IVEC] = { { 0 } };
-    //! Forces
-    rvec4 f[c_numAtoms] = { { 0 } };
+    //! Forces, aligned as the SIMD kernels use aligned force updates
+    alignas(GMX_SIMD_ALIGNMENT) rvec4 f[c_numAtoms] = { { 0 } };
 };
 
 /*! \brief Utility to check the output from bonded tests
@@ -556,6 +558,48 @@ protected:
         // and bonded functions.
         EXPECT_TRUE((input_.fep || (output.dvdlambda == 0.0))) << "dvdlambda was " << output.dvdlambda;
         checkOutput(checker, output);
+        if (!input_.fep)
+        {
+            // The force-only flavor, which can use SIMD, should give the same forces
+            OutputQuantities outputForcesOnly;
+            calculateSimpleBond(input_.ftype, iatoms.size(), iatoms.data(), &input_.iparams,
+                                as_rvec_array(x_.data()), outputForcesOnly.f,
+                                outputForcesOnly.fshift, &pbc_,
+                                /* const struct t_graph *g */ nullptr, lambda,
+                                &outputForcesOnly.dvdlambda, &mdatoms,
+                                /* struct t_fcdata * */ nullptr, ddgatindex.data(),
+                                BondedKernelFlavor::ForcesSimdWhenAvailable);
+            // Each force component should agree within a few hundred ULP. The
+            // SIMD angle kernels compute the cosine in single precision, whereas
+            // the reference accumulates it in double. For the nearly linear angle
+            // in the first set of test coordinates, this gives differences of
+            // about 600 ULP.
+            const bool isSimdAngle = (input_.ftype == F_ANGLES || input_.ftype == F_UREY_BRADLEY);
+            const uint64_t ulpDiff = isSimdAngle ? 1000 : 300;
+            // Components that are small due to cancellation are compared with
+            // an absolute tolerance set by the largest force component, but
+            // never tighter than the absolute tolerance of the reference data.
+            real forceMagnitude = 0;
+            for (int a = 0; a < c_numAtoms; a++)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    forceMagnitude = std::max(forceMagnitude, std::abs(output.f[a][d]));
+                }
+            }
+            const test::FloatingPointTolerance tolerance(
+                    std::max(input_.ftoler, float(forceMagnitude * ulpDiff * GMX_FLOAT_EPS)),
+                    std::max(input_.dtoler, forceMagnitude * ulpDiff * GMX_DOUBLE_EPS), 0.0, 0.0,
+                    ulpDiff, ulpDiff, false);
+            for (int a = 0; a < c_numAtoms; a++)
+            {
+                for (int d = 0; d < DIM; d++)
+                {
+                    EXPECT_REAL_EQ_TOL(output.f[a][d], outputForcesOnly.f[a][d], tolerance)
+                            << "for atom " << a << " dimension " << d;
+                }
+            }
+        }
     }
     void testIfunc()
     {
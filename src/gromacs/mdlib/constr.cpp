@@ -50,6 +50,7 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <functional>
 
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
@@ -87,6 +88,9 @@
 namespace gmx
 {
 
+//! The number of SETTLE chunks per thread when SETTLE runs dynamically scheduled within LINCS
+static constexpr int c_settleChunksPerThread = 4;
+
 /* \brief Impl class for Constraints
  *
  * \todo Members like md, idef are valid only for the lifetime of a
@@ -455,11 +459,54 @@ bool Constraints::Impl::apply(bool               bLog,
         }
     }
 
+    /* When constraining coordinates with both LINCS and SETTLE, we run
+     * SETTLE inside the LINCS parallel region. SETTLE and LINCS act on
+     * disjoint sets of atoms, so the threads that finish their LINCS task
+     * early can dynamically pick up chunks of water molecules instead
+     * of waiting for the other LINCS threads and a second parallel region.
+     */
+    const bool runSettleWithinLincs = (lincsd != nullptr && nsettle > 0
+                                       && econq == ConstraintVariable::Positions
+                                       && gmx_omp_nthreads_get(emntLINCS) == nth);
+    bool bSettleErrorHasOccurred0 = false;
+
     if (lincsd != nullptr)
     {
+        std::function<void(int)> settleTask;
+        if (runSettleWithinLincs)
+        {
+            settleTask = [&](int th) {
+                if (th > 0)
+                {
+                    clear_mat(vir_r_m_dr_th[th]);
+                }
+
+                /* Use several chunks per thread for load balancing */
+                const int numChunks       = nth * c_settleChunksPerThread;
+                bool      errorOnThisTask = false;
+#pragma omp for schedule(dynamic) nowait
+                for (int chunk = 0; chunk < numChunks; chunk++)
+                {
+                    bool errorInChunk = false;
+                    csettle(settled, numChunks, chunk, pbc_null, x[0], xprime[0], invdt,
+                            v ? v[0] : nullptr, vir != nullptr,
+                            th == 0 ? vir_r_m_dr : vir_r_m_dr_th[th], &errorInChunk);
+                    errorOnThisTask = errorOnThisTask || errorInChunk;
+                }
+                if (th == 0)
+                {
+                    bSettleErrorHasOccurred0 = errorOnThisTask;
+                }
+                else
+                {
+                    bSettleErrorHasOccurred[th] = errorOnThisTask;
+                }
+            };
+        }
+
         bOK = constrain_lincs(bLog || bEner, ir, step, lincsd, md, cr, ms, x, xprime, min_proj, box,
                               pbc_null, lambda, dvdlambda, invdt, v, vir != nullptr, vir_r_m_dr,
-                              econq, nrnb, maxwarn, &warncount_lincs);
+                              econq, nrnb, maxwarn, &warncount_lincs, settleTask);
         if (!bOK && maxwarn < INT_MAX)
         {
             if (log != nullptr)
@@ -489,26 +536,29 @@ bool Constraints::Impl::apply(bool               bLog,
 
     if (nsettle > 0)
     {
-        bool bSettleErrorHasOccurred0 = false;
-
         switch (econq)
         {
             case ConstraintVariable::Positions:
-#pragma omp parallel for num_threads(nth) schedule(static)
-                for (int th = 0; th < nth; th++)
+                if (!runSettleWithinLincs)
                 {
-                    try
+#pragma omp parallel for num_threads(nth) schedule(static)
+                    for (int th = 0; th < nth; th++)
                     {
-                        if (th > 0)
+                        try
                         {
-                            clear_mat(vir_r_m_dr_th[th]);
+                            if (th > 0)
+                            {
+                                clear_mat(vir_r_m_dr_th[th]);
+                            }
+
+                            csettle(settled, nth, th, pbc_null, x[0], xprime[0], invdt,
+                                    v ? v[0] : nullptr, vir != nullptr,
+                                    th == 0 ? vir_r_m_dr : vir_r_m_dr_th[th],
+                                    th == 0 ? &bSettleErrorHasOccurred0
+                                            : &bSettleErrorHasOccurred[th]);
                         }
-
-                        csettle(settled, nth, th, pbc_null, x[0], xprime[0], invdt, v ? v[0] : nullptr,
-                                vir != nullptr, th == 0 ? vir_r_m_dr : vir_r_m_dr_th[th],
-                                th == 0 ? &bSettleErrorHasOccurred0 : &bSettleErrorHasOccurred[th]);
+                        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
                     }
-                    GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
                 }
                 inc_nrnb(nrnb, eNR_SETTLE, nsettle);
                 if (v != nullptr)
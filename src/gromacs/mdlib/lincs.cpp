@@ -2260,28 +2260,29 @@ static LincsDeviations makeLincsDeviations(const Lincs& lincsd, const rvec* x, c
     return result;
 }
 
-bool constrain_lincs(bool                  computeRmsd,
-                     const t_inputrec&     ir,
-                     int64_t               step,
-                     Lincs*                lincsd,
-                     const t_mdatoms&      md,
-                     const t_commrec*      cr,
-                     const gmx_multisim_t* ms,
-                     const rvec*           x,
-                     rvec*                 xprime,
-                     rvec*                 min_proj,
-                     const matrix          box,
-                     t_pbc*                pbc,
-                     real                  lambda,
-                     real*                 dvdlambda,
-                     real                  invdt,
-                     rvec*                 v,
-                     bool                  bCalcVir,
-                     tensor                vir_r_m_dr,
-                     ConstraintVariable    econq,
-                     t_nrnb*               nrnb,
-                     int                   maxwarn,
-                     int*                  warncount)
+bool constrain_lincs(bool                            computeRmsd,
+                     const t_inputrec&               ir,
+                     int64_t                         step,
+                     Lincs*                          lincsd,
+                     const t_mdatoms&                md,
+                     const t_commrec*                cr,
+                     const gmx_multisim_t*           ms,
+                     const rvec*                     x,
+                     rvec*                           xprime,
+                     rvec*                           min_proj,
+                     const matrix                    box,
+                     t_pbc*                          pbc,
+                     real                            lambda,
+                     real*                           dvdlambda,
+                     real                            invdt,
+                     rvec*                           v,
+                     bool                            bCalcVir,
+                     tensor                          vir_r_m_dr,
+                     ConstraintVariable              econq,
+                     t_nrnb*                         nrnb,
+                     int                             maxwarn,
+                     int*                            warncount,
+                     const std::function<void(int)>& concurrentTask)
 {
     bool bOK = TRUE;
 
@@ -2298,6 +2299,21 @@ bool constrain_lincs(bool                  computeRmsd,
             lincsd->rmsdData = { { 0 } };
         }
 
+        /* There is no LINCS work, but the caller relies on the concurrent
+         * task being run, so we still need a parallel region for it.
+         */
+        if (concurrentTask && econq == ConstraintVariable::Positions)
+        {
+#pragma omp parallel num_threads(lincsd->ntask)
+            {
+                try
+                {
+                    concurrentTask(gmx_omp_get_thread_num());
+                }
+                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+            }
+        }
+
         return bOK;
     }
 
@@ -2376,6 +2392,11 @@ bool constrain_lincs(bool                  computeRmsd,
 
                 do_lincs(x, xprime, box, pbc, lincsd, th, md.invmass, cr, bCalcDHDL, ir.LincsWarnAngle,
                          &bWarn, invdt, v, bCalcVir, th == 0 ? vir_r_m_dr : lincsd->task[th].vir_r_m_dr);
+
+                if (concurrentTask)
+                {
+                    concurrentTask(th);
+                }
             }
             GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
         }
@@ -46,6 +46,8 @@
 
 #include <cstdio>
 
+#include <functional>
+
 #include "gromacs/math/vectypes.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
@@ -91,30 +93,39 @@ void done_lincs(Lincs* li);
 void set_lincs(const t_idef& idef, const t_mdatoms& md, bool bDynamics, const t_commrec* cr, Lincs* li);
 
 /*! \brief Applies LINCS constraints.
+ *
+ * When \p concurrentTask is set and the coordinates are constrained,
+ * it is called by every LINCS thread, with its thread index, after
+ * that thread has finished its LINCS task and inside the same OpenMP
+ * parallel region. This also happens when there are no constraints
+ * for LINCS to apply. This allows independent work, such as SETTLE, to
+ * fill the load imbalance of LINCS. The task should not touch atoms
+ * constrained by LINCS.
  *
  * \returns true if the constraining succeeded. */
-bool constrain_lincs(bool                  computeRmsd,
-                     const t_inputrec&     ir,
-                     int64_t               step,
-                     Lincs*                lincsd,
-                     const t_mdatoms&      md,
-                     const t_commrec*      cr,
-                     const gmx_multisim_t* ms,
-                     const rvec*           x,
-                     rvec*                 xprime,
-                     rvec*                 min_proj,
-                     const matrix          box,
-                     t_pbc*                pbc,
-                     real                  lambda,
-                     real*                 dvdlambda,
-                     real                  invdt,
-                     rvec*                 v,
-                     bool                  bCalcVir,
-                     tensor                vir_r_m_dr,
-                     ConstraintVariable    econq,
-                     t_nrnb*               nrnb,
-                     int                   maxwarn,
-                     int*                  warncount);
+bool constrain_lincs(bool                            computeRmsd,
+                     const t_inputrec&               ir,
+                     int64_t                         step,
+                     Lincs*                          lincsd,
+                     const t_mdatoms&                md,
+                     const t_commrec*                cr,
+                     const gmx_multisim_t*           ms,
+                     const rvec*                     x,
+                     rvec*                           xprime,
+                     rvec*                           min_proj,
+                     const matrix                    box,
+                     t_pbc*                          pbc,
+                     real                            lambda,
+                     real*                           dvdlambda,
+                     real                            invdt,
+                     rvec*                           v,
+                     bool                            bCalcVir,
+                     tensor                          vir_r_m_dr,
+                     ConstraintVariable              econq,
+                     t_nrnb*                         nrnb,
+                     int                             maxwarn,
+                     int*                            warncount,
+                     const std::function<void(int)>& concurrentTask = nullptr);
 
 } // namespace gmx
 
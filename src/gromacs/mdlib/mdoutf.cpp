@@ -61,30 +61,38 @@
 #include "gromacs/utility/pleasecite.h"
 #include "gromacs/utility/smalloc.h"
 
+/*! \brief Number of frames the xtc writer thread can have queued
+ *
+ * Each frame holds a copy of the compressed-output coordinates.
+ */
+static constexpr int c_xtcWriterQueuedFrames = 2;
+
 struct gmx_mdoutf
 {
-    t_fileio*                     fp_trn;
-    t_fileio*                     fp_xtc;
-    gmx_tng_trajectory_t          tng;
-    gmx_tng_trajectory_t          tng_low_prec;
-    int                           x_compression_precision; /* only used by XTC output */
-    ener_file_t                   fp_ene;
-    const char*                   fn_cpt;
-    gmx_bool                      bKeepAndNumCPT;
-    int                           eIntegrator;
-    gmx_bool                      bExpanded;
-    int                           elamstats;
-    int                           simulation_part;
-    FILE*                         fp_dhdl;
-    int                           natoms_global;
-    int                           natoms_x_compressed;
-    SimulationGroups*             groups; /* for compressed position writing */
-    gmx_wallcycle_t               wcycle;
-    rvec*                         f_global;
-    gmx::IMDOutputProvider*       outputProvider;
-    const gmx::MdModulesNotifier* mdModulesNotifier;
-    bool                          simulationsShareState;
-    MPI_Comm                      mpiCommMasters;
+    t_fileio*                        fp_trn;
+    t_fileio*                        fp_xtc;
+    gmx::XtcWriterThread*            xtcWriter; /* writes fp_xtc in the background, can be nullptr */
+    gmx_tng_trajectory_t             tng;
+    gmx_tng_trajectory_t             tng_low_prec;
+    int                              x_compression_precision; /* only used by XTC output */
+    ener_file_t                      fp_ene;
+    const char*                      fn_cpt;
+    gmx::BackgroundCheckpointWriter* checkpointWriter; /* can be nullptr */
+    gmx_bool                         bKeepAndNumCPT;
+    int                              eIntegrator;
+    gmx_bool                         bExpanded;
+    int                              elamstats;
+    int                              simulation_part;
+    FILE*                            fp_dhdl;
+    int                              natoms_global;
+    int                              natoms_x_compressed;
+    SimulationGroups*                groups; /* for compressed position writing */
+    gmx_wallcycle_t                  wcycle;
+    rvec*                            f_global;
+    gmx::IMDOutputProvider*          outputProvider;
+    const gmx::MdModulesNotifier*    mdModulesNotifier;
+    bool                             simulationsShareState;
+    MPI_Comm                         mpiCommMasters;
 };
 
 
@@ -111,12 +119,14 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
 
     snew(of, 1);
 
-    of->fp_trn       = nullptr;
-    of->fp_ene       = nullptr;
-    of->fp_xtc       = nullptr;
-    of->tng          = nullptr;
-    of->tng_low_prec = nullptr;
-    of->fp_dhdl      = nullptr;
+    of->fp_trn           = nullptr;
+    of->fp_ene           = nullptr;
+    of->fp_xtc           = nullptr;
+    of->xtcWriter        = nullptr;
+    of->checkpointWriter = nullptr;
+    of->tng              = nullptr;
+    of->tng_low_prec     = nullptr;
+    of->fp_dhdl          = nullptr;
 
     of->eIntegrator             = ir->eI;
     of->bExpanded               = ir->bExpanded;
@@ -138,6 +148,10 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
     if (MASTER(cr))
     {
         of->bKeepAndNumCPT = mdrunOptions.checkpointOptions.keepAndNumberCheckpointFiles;
+        if (getenv("GMX_BACKGROUND_CHECKPOINT") != nullptr)
+        {
+            of->checkpointWriter = new gmx::BackgroundCheckpointWriter();
+        }
 
         filemode = restartWithAppending ? appendMode : writeMode;
 
@@ -147,13 +161,23 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
             filename = ftp2fn(efCOMPRESSED, nfile, fnm);
             switch (fn2ftp(filename))
             {
-                case efXTC: of->fp_xtc = open_xtc(filename, filemode); break;
+                case efXTC:
+                    of->fp_xtc = open_xtc(filename, filemode);
+                    if (getenv("GMX_XTC_WRITER_THREAD") != nullptr)
+                    {
+                        of->xtcWriter = new gmx::XtcWriterThread(of->fp_xtc, c_xtcWriterQueuedFrames);
+                    }
+                    break;
                 case efTNG:
                     gmx_tng_open(filename, filemode[0], &of->tng_low_prec);
                     if (filemode[0] == 'w')
                     {
                         gmx_tng_prepare_low_prec_writing(of->tng_low_prec, top_global, ir);
                     }
+                    if (getenv("GMX_TNG_THREADS") != nullptr)
+                    {
+                        gmx_tng_start_background_writing(of->tng_low_prec);
+                    }
                     bCiteTng = TRUE;
                     break;
                 default: gmx_incons("Invalid reduced precision file format");
@@ -183,6 +207,10 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
                     {
                         gmx_tng_prepare_md_writing(of->tng, top_global, ir);
                     }
+                    if (getenv("GMX_TNG_THREADS") != nullptr)
+                    {
+                        gmx_tng_start_background_writing(of->tng);
+                    }
                     bCiteTng = TRUE;
                     break;
                 default: gmx_incons("Invalid full precision file format");
@@ -239,6 +267,15 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
     return of;
 }
 
+//! Ends the run after a failure to write an xtc frame.
+[[noreturn]] static void xtcWriteError()
+{
+    gmx_fatal(FARGS,
+              "XTC error. This indicates you are out of disk space, or a "
+              "simulation with major instabilities resulting in coordinates "
+              "that are NaN or too large to be represented in the XTC format.\n");
+}
+
 ener_file_t mdoutf_get_fp_ene(gmx_mdoutf_t of)
 {
     return of->fp_ene;
@@ -308,6 +345,13 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
         {
             fflush_tng(of->tng);
             fflush_tng(of->tng_low_prec);
+            /* The checkpoint stores the positions of the output files,
+             * so all queued xtc frames need to be written first.
+             */
+            if (of->xtcWriter != nullptr && !of->xtcWriter->flush())
+            {
+                xtcWriteError();
+            }
             /* Write the checkpoint file.
              * When simulations share the state, an MPI barrier is applied before
              * renaming old and new checkpoint files to minimize the risk of
@@ -319,7 +363,7 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
                              DOMAINDECOMP(cr) ? cr->dd->nnodes : cr->nnodes, of->eIntegrator,
                              of->simulation_part, of->bExpanded, of->elamstats, step, t,
                              state_global, observablesHistory, *(of->mdModulesNotifier),
-                             of->simulationsShareState, of->mpiCommMasters);
+                             of->simulationsShareState, of->mpiCommMasters, of->checkpointWriter);
         }
 
         if (mdof_flags & (MDOF_X | MDOF_V | MDOF_F))
@@ -380,14 +424,19 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
                     }
                 }
             }
-            if (write_xtc(of->fp_xtc, of->natoms_x_compressed, step, t, state_local->box, xxtc,
-                          of->x_compression_precision)
-                == 0)
+            if (of->xtcWriter != nullptr)
+            {
+                if (!of->xtcWriter->writeFrame(of->natoms_x_compressed, step, t, state_local->box,
+                                               xxtc, of->x_compression_precision))
+                {
+                    xtcWriteError();
+                }
+            }
+            else if (write_xtc(of->fp_xtc, of->natoms_x_compressed, step, t, state_local->box,
+                               xxtc, of->x_compression_precision)
+                     == 0)
             {
-                gmx_fatal(FARGS,
-                          "XTC error. This indicates you are out of disk space, or a "
-                          "simulation with major instabilities resulting in coordinates "
-                          "that are NaN or too large to be represented in the XTC format.\n");
+                xtcWriteError();
             }
             gmx_fwrite_tng(of->tng_low_prec, TRUE, step, t, state_local->lambda[efptFEP],
                            state_local->box, of->natoms_x_compressed, xxtc, nullptr, nullptr);
@@ -448,10 +497,23 @@ void mdoutf_tng_close(gmx_mdoutf_t of)
 
 void done_mdoutf(gmx_mdoutf_t of)
 {
+    if (of->checkpointWriter != nullptr)
+    {
+        of->checkpointWriter->waitForCompletion();
+        delete of->checkpointWriter;
+    }
     if (of->fp_ene != nullptr)
     {
         done_ener_file(of->fp_ene);
     }
+    if (of->xtcWriter != nullptr)
+    {
+        if (!of->xtcWriter->flush())
+        {
+            xtcWriteError();
+        }
+        delete of->xtcWriter;
+    }
     if (of->fp_xtc)
     {
         close_xtc(of->fp_xtc);
@@ -57,13 +57,16 @@
 
 #include "gromacs/math/vec.h"
 #include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/settle.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/topology/ifunc.h"
 #include "gromacs/utility/stringutil.h"
 
 #include "testutils/testasserts.h"
 
 #include "constrtestdata.h"
 #include "constrtestrunners.h"
+#include "settletestdata.h"
 
 namespace gmx
 {
@@ -635,6 +638,77 @@ INSTANTIATE_TEST_CASE_P(WithParameters,
                         ::testing::Combine(::testing::Values("PBCNone", "PBCXYZ"),
                                            ::testing::ValuesIn(getRunnersNames())));
 
+/*! \brief Test that SETTLE runs within LINCS when LINCS has no constraints to apply.
+ *
+ * Without domain decomposition, constrain_lincs() has no work when there are no
+ * constraints in the local topology, but SETTLE can be scheduled within its parallel
+ * region and should still be applied.
+ */
+TEST(LincsConcurrentTaskTest, SettleIsAppliedWithoutLincsConstraints)
+{
+    std::string title    = "one constraint type, no local constraints";
+    int         numAtoms = 2;
+
+    std::vector<real> masses        = { 1.0, 12.0 };
+    std::vector<int>  constraints   = { 0, 0, 1 };
+    std::vector<real> constraintsR0 = { 0.1 };
+
+    std::vector<RVec> x      = { { 0.0, 0.1, 0.0 }, { 0.1, 0.0, 0.0 } };
+    std::vector<RVec> xPrime = { { 0.01, 0.08, 0.01 }, { 0.06, 0.01, -0.01 } };
+    std::vector<RVec> v      = { { 1.0, 2.0, 3.0 }, { 3.0, 2.0, 1.0 } };
+
+    tensor virialScaledRef = { { 0 } };
+
+    std::unique_ptr<ConstraintsTestData> testData = std::make_unique<ConstraintsTestData>(
+            title, numAtoms, masses, constraints, constraintsR0, false, virialScaledRef, false, 0,
+            real(0.0), real(0.001), x, xPrime, v, real(0.0001), false, 1, 4, real(30.0));
+    // LINCS is set up for the constraint in the topology, but gets none to apply
+    testData->idef_.il[F_CONSTR].nr = 0;
+
+    SettleTestData settleTestData(1);
+    settledata*    settled = settle_init(settleTestData.mtop_);
+    settle_set_constraints(settled, &settleTestData.ilist_, settleTestData.mdatoms_);
+
+    int  numTasksRun         = 0;
+    bool settleErrorOccurred = false;
+    auto settleTask          = [&](int th) {
+        numTasksRun++;
+        csettle(settled, 1, th, nullptr,
+                reinterpret_cast<real*>(as_rvec_array(settleTestData.x_.data())),
+                reinterpret_cast<real*>(as_rvec_array(settleTestData.xPrime_.data())),
+                settleTestData.reciprocalTimeStep_, nullptr, false, settleTestData.virial_,
+                &settleErrorOccurred);
+    };
+
+    t_pbc  pbc;
+    matrix boxNone = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+    set_pbc(&pbc, epbcNONE, boxNone);
+    applyLincsWithConcurrentTask(testData.get(), pbc, settleTask);
+    settle_free(settled);
+
+    EXPECT_EQ(1, numTasksRun) << "SETTLE was not run within LINCS";
+    EXPECT_FALSE(settleErrorOccurred);
+
+    const RVec&            positionO  = settleTestData.xPrime_[0];
+    const RVec&            positionH1 = settleTestData.xPrime_[1];
+    const RVec&            positionH2 = settleTestData.xPrime_[2];
+    const real             dOH        = settleTestData.dOH_;
+    const real             dHH        = settleTestData.dHH_;
+    FloatingPointTolerance tolerance  = relativeToleranceAsPrecisionDependentUlp(dOH * dOH, 80, 380);
+    EXPECT_REAL_EQ_TOL(dOH * dOH, distance2(positionO, positionH1), tolerance);
+    EXPECT_REAL_EQ_TOL(dOH * dOH, distance2(positionO, positionH2), tolerance);
+    EXPECT_REAL_EQ_TOL(dHH * dHH, distance2(positionH1, positionH2), tolerance);
+
+    // The atoms with the constraint in the topology should not have been moved
+    for (int i = 0; i < numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(testData->xPrime0_[i][d], testData->xPrime_[i][d]);
+        }
+    }
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
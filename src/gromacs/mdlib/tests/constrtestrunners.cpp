@@ -107,6 +107,20 @@ void applyShake(ConstraintsTestData* testData, t_pbc gmx_unused pbc)
  * \param[in] pbc             Periodic boundary data.
  */
 void applyLincs(ConstraintsTestData* testData, t_pbc pbc)
+{
+    applyLincsWithConcurrentTask(testData, pbc, nullptr);
+}
+
+/*! \brief
+ * Initialize and apply LINCS constraints, running a task within the LINCS parallel region.
+ *
+ * \param[in] testData        Test data structure.
+ * \param[in] pbc             Periodic boundary data.
+ * \param[in] concurrentTask  Task to pass to constrain_lincs().
+ */
+void applyLincsWithConcurrentTask(ConstraintsTestData*            testData,
+                                  t_pbc                           pbc,
+                                  const std::function<void(int)>& concurrentTask)
 {
 
     Lincs* lincsd;
@@ -135,7 +149,7 @@ void applyLincs(ConstraintsTestData* testData, t_pbc pbc)
             as_rvec_array(testData->xPrime2_.data()), pbc.box, &pbc, testData->md_.lambda,
             &testData->dHdLambda_, testData->invdt_, as_rvec_array(testData->v_.data()),
             testData->computeVirial_, testData->virialScaled_, gmx::ConstraintVariable::Positions,
-            &testData->nrnb_, maxwarn, &warncount_lincs);
+            &testData->nrnb_, maxwarn, &warncount_lincs, concurrentTask);
     EXPECT_TRUE(success) << "Test failed with a false return value in LINCS.";
     EXPECT_EQ(warncount_lincs, 0) << "There were warnings in LINCS.";
     for (auto& moltype : at2con_mt)
@@ -46,6 +46,8 @@
 #ifndef GMX_MDLIB_TESTS_CONSTRTESTRUNNERS_H
 #define GMX_MDLIB_TESTS_CONSTRTESTRUNNERS_H
 
+#include <functional>
+
 #include "constrtestdata.h"
 
 struct t_pbc;
@@ -61,6 +63,12 @@ void applyShake(ConstraintsTestData* testData, t_pbc pbc);
 /*! \brief Apply LINCS constraints to the test data.
  */
 void applyLincs(ConstraintsTestData* testData, t_pbc pbc);
+/*! \brief Apply LINCS constraints to the test data, running \p concurrentTask
+ * within the LINCS parallel region.
+ */
+void applyLincsWithConcurrentTask(ConstraintsTestData*            testData,
+                                  t_pbc                           pbc,
+                                  const std::function<void(int)>& concurrentTask);
 /*! \brief Apply CUDA version of LINCS constraints to the test data.
  *
  * All the data is copied to the GPU device, then LINCS is applied and
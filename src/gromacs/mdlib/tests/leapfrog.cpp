@@ -153,6 +153,7 @@ public:
         // All runners should be registered here under appropriate conditions
         //
         s_runners_["LeapFrogSimple"] = integrateLeapFrogSimple;
+        s_runners_["LeapFrogFused"]  = integrateLeapFrogFused;
         if (GMX_GPU == GMX_GPU_CUDA && canComputeOnGpu())
         {
             s_runners_["LeapFrogGpu"] = integrateLeapFrogGpu;
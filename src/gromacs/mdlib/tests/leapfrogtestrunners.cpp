@@ -103,6 +103,37 @@ void integrateLeapFrogSimple(LeapFrogTestData* testData, int numSteps)
     }
 }
 
+void integrateLeapFrogFused(LeapFrogTestData* testData, int numSteps)
+{
+    testData->state_.x.resizeWithPadding(testData->numAtoms_);
+    testData->state_.v.resizeWithPadding(testData->numAtoms_);
+    for (int i = 0; i < testData->numAtoms_; i++)
+    {
+        testData->state_.x[i] = testData->x_[i];
+        testData->state_.v[i] = testData->v_[i];
+    }
+
+    gmx_omp_nthreads_set(emntUpdate, 1);
+
+    for (int step = 0; step < numSteps; step++)
+    {
+        update_coords_fused(step, &testData->inputRecord_, &testData->mdAtoms_, &testData->state_,
+                            testData->f_, &testData->forceCalculationData_,
+                            &testData->kineticEnergyData_, testData->velocityScalingMatrix_,
+                            testData->update_.get());
+    }
+    auto xp = makeArrayRef(*testData->update_->xp()).subArray(0, testData->numAtoms_);
+    for (int i = 0; i < testData->numAtoms_; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            testData->x_[i][d]      = testData->state_.x[i][d];
+            testData->v_[i][d]      = testData->state_.v[i][d];
+            testData->xPrime_[i][d] = xp[i][d];
+        }
+    }
+}
+
 #if GMX_GPU != GMX_GPU_CUDA
 
 void integrateLeapFrogGpu(gmx_unused LeapFrogTestData* testData, gmx_unused int numSteps)
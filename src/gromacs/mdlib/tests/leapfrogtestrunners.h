@@ -58,6 +58,13 @@ namespace test
  */
 void integrateLeapFrogSimple(LeapFrogTestData* testData, int numSteps);
 
+/*! \brief Integrate using the CPU version of Leap-Frog fused with the final coordinate copy
+ *
+ * \param[in]     testData  Data needed for the integrator
+ * \param[in]     numSteps  Total number of steps to run integration for.
+ */
+void integrateLeapFrogFused(LeapFrogTestData* testData, int numSteps);
+
 /*! \brief Integrate using CUDA version of Leap-Frog
  *
  * Copies data from CPU to GPU, integrates the equation of motion
@@ -0,0 +1,247 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the multi-threaded construction of virtual sites.
+ *
+ * \ingroup module_mdlib
+ */
+#include "gmxpre.h"
+
+#include "gromacs/mdlib/vsite.h"
+
+#include "config.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/topology/idef.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/topology.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! The number of normal particles in the test system
+constexpr int c_numParticles = 60;
+
+//! The parameter type indices of the vsite types used
+enum
+{
+    c_typeVsite2,
+    c_typeVsite3,
+    c_numTypes
+};
+
+/*! \brief Returns a molecule type with virtual sites constructed from virtual sites
+ *
+ * The vsites that depend on other vsites are listed both after (as grompp
+ * orders them) and before (out of order) the vsites they depend on,
+ * within the same vsite type and across types. In the out-of-order case
+ * the positions of the constructing vsites before construction are used.
+ * The constructing atoms are spread over the whole atom range, so the vsites
+ * end up in all kinds of thread tasks.
+ */
+gmx_moltype_t moltypeWithVsitesFromVsites()
+{
+    gmx_moltype_t moltype = {};
+
+    const int v = c_numParticles;
+
+    /* Two vsites constructed from normal particles far apart */
+    const int r0 = v + 0;
+    const int r1 = v + 1;
+    /* Vsites constructed from a vsite that comes later in the same type */
+    const int c0 = v + 2;
+    const int d0 = v + 3;
+    const int c1 = v + 4;
+    const int d1 = v + 5;
+    /* A vsite constructed from two earlier vsites */
+    const int b = v + 6;
+    /* Vsites constructed from a vsite of a later type */
+    const int e = v + 7;
+    const int h = v + 8;
+    /* A vsite constructed from nearby normal particles */
+    const int l = v + 9;
+    /* The vsites of the later type */
+    const int f = v + 10;
+    const int g = v + 11;
+    const int k = v + 12;
+
+    moltype.atoms.nr = v + 13;
+
+    moltype.ilist[F_VSITE2].iatoms = {
+        c_typeVsite2, r0, 0,  59, c_typeVsite2, r1, 10, 45, c_typeVsite2, c0, d0, 1,
+        c_typeVsite2, d0, r0, 2,  c_typeVsite2, c1, d1, 3,  c_typeVsite2, d1, r1, 4,
+        c_typeVsite2, b,  r0, r1, c_typeVsite2, e,  f,  5,  c_typeVsite2, h,  g,  6,
+        c_typeVsite2, l,  20, 21
+    };
+    moltype.ilist[F_VSITE3].iatoms = { c_typeVsite3, f, r0, 7,  50,
+                                       c_typeVsite3, g, b,  c0, e,
+                                       c_typeVsite3, k, 30, 31, 32 };
+
+    return moltype;
+}
+
+//! Returns the vsite interaction parameters
+std::vector<t_iparams> vsiteParameters()
+{
+    std::vector<t_iparams> iparams(c_numTypes);
+    iparams[c_typeVsite2].vsite.a = 0.3;
+    iparams[c_typeVsite3].vsite.a = 0.2;
+    iparams[c_typeVsite3].vsite.b = 0.35;
+
+    return iparams;
+}
+
+//! Returns the initial coordinates, vsites get positions that differ from their constructed ones
+std::vector<RVec> initialCoordinates(int numAtoms)
+{
+    std::vector<RVec> x(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        if (i < c_numParticles)
+        {
+            x[i] = RVec(std::sin(0.7 * i), std::cos(1.3 * i), 0.01 * i);
+        }
+        else
+        {
+            x[i] = RVec(-1.0 - i, 2.0, 3.0 + 0.5 * i);
+        }
+    }
+
+    return x;
+}
+
+//! Test fixture for the construction of vsites, parametrized by the number of threads
+class VsiteConstructionTest : public ::testing::TestWithParam<int>
+{
+public:
+    VsiteConstructionTest() : numThreadsBackup_(gmx_omp_nthreads_get(emntVSITE)) {}
+
+    ~VsiteConstructionTest() override { gmx_omp_nthreads_set(emntVSITE, numThreadsBackup_); }
+
+private:
+    //! The number of vsite threads to restore after the test
+    int numThreadsBackup_;
+};
+
+TEST_P(VsiteConstructionTest, ThreadedConstructionMatchesSerial)
+{
+    const int numThreads = GetParam();
+
+    gmx_mtop_t mtop;
+    mtop.moltype.push_back(moltypeWithVsitesFromVsites());
+    mtop.molblock.resize(1);
+    mtop.molblock[0].type = 0;
+    mtop.molblock[0].nmol = 1;
+    mtop.natoms           = mtop.moltype[0].atoms.nr;
+    const int numAtoms    = mtop.natoms;
+
+    const std::vector<t_iparams> iparams = vsiteParameters();
+
+    /* Set up the local interaction lists as used without domain decomposition */
+    t_ilist ilist[F_NRE];
+    for (int ftype = 0; ftype < F_NRE; ftype++)
+    {
+        std::vector<int>& iatoms = mtop.moltype[0].ilist[ftype].iatoms;
+        ilist[ftype]             = { static_cast<int>(iatoms.size()), 0, iatoms.data(), 0 };
+    }
+
+    std::vector<unsigned short> ptype(numAtoms, eptAtom);
+    for (int i = c_numParticles; i < numAtoms; i++)
+    {
+        ptype[i] = eptVSite;
+    }
+    t_mdatoms mdatoms;
+    mdatoms.nr     = numAtoms;
+    mdatoms.homenr = numAtoms;
+    mdatoms.ptype  = ptype.data();
+
+    t_commrec cr;
+    cr.nnodes = 1;
+    cr.dd     = nullptr;
+
+    matrix box = { { 0 } };
+
+    /* Serial reference */
+    std::vector<RVec> xSerial = initialCoordinates(numAtoms);
+    construct_vsites(nullptr, as_rvec_array(xSerial.data()), 0, nullptr, iparams.data(), ilist,
+                     epbcNONE, FALSE, nullptr, box);
+
+    gmx_omp_nthreads_set(emntVSITE, numThreads);
+    std::unique_ptr<gmx_vsite_t> vsite = initVsite(mtop, &cr);
+    ASSERT_NE(vsite, nullptr);
+    ASSERT_EQ(vsite->nthreads, numThreads);
+    split_vsites_over_threads(ilist, iparams.data(), &mdatoms, vsite.get());
+
+    /* Repeat the construction, so a race has more chances to show up */
+    for (int repeat = 0; repeat < 10; repeat++)
+    {
+        std::vector<RVec> x = initialCoordinates(numAtoms);
+        construct_vsites(vsite.get(), as_rvec_array(x.data()), 0, nullptr, iparams.data(), ilist,
+                         epbcNONE, FALSE, &cr, box);
+
+        /* The same operations are performed on the same values, so we expect identical results */
+        for (int i = c_numParticles; i < numAtoms; i++)
+        {
+            for (int d = 0; d < DIM; d++)
+            {
+                EXPECT_EQ(x[i][d], xSerial[i][d]) << "for vsite " << i << " dimension " << d;
+            }
+        }
+    }
+}
+
+#if GMX_OPENMP
+INSTANTIATE_TEST_CASE_P(WithSeveralThreads, VsiteConstructionTest, ::testing::Values(2, 3, 4));
+#endif
+
+} // namespace
+
+} // namespace gmx
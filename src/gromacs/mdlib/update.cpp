@@ -1588,17 +1588,15 @@ void finish_update(const t_inputrec*       inputrec, /* input record and box stu
     {
         wallcycle_start_nocount(wcycle, ewcUPDATE);
 
+        /* If we have atoms that are frozen along some, but not all
+         * dimensions, then any constraints will have moved them also along
+         * the frozen dimensions. To freeze such degrees of freedom
+         * we should not copy the frozen dimensions back to x.
+         */
+        const ivec* nFreeze                     = inputrec->opts.nFreeze;
+        bool        partialFreezeAndConstraints = false;
         if (md->cFREEZE != nullptr && constr != nullptr)
         {
-            /* If we have atoms that are frozen along some, but not all
-             * dimensions, then any constraints will have moved them also along
-             * the frozen dimensions. To freeze such degrees of freedom
-             * we copy them back here to later copy them forward. It would
-             * be more elegant and slightly more efficient to copies zero
-             * times instead of twice, but the graph case below prevents this.
-             */
-            const ivec* nFreeze                     = inputrec->opts.nFreeze;
-            bool        partialFreezeAndConstraints = false;
             for (int g = 0; g < inputrec->opts.ngfrz; g++)
             {
                 int numFreezeDim = nFreeze[g][XX] + nFreeze[g][YY] + nFreeze[g][ZZ];
@@ -1607,8 +1605,15 @@ void finish_update(const t_inputrec*       inputrec, /* input record and box stu
                     partialFreezeAndConstraints = true;
                 }
             }
+        }
+
+        if (graph && (graph->nnodes > 0))
+        {
             if (partialFreezeAndConstraints)
             {
+                /* With the graph we need to copy the frozen dimensions back
+                 * to xp, since unshift_x() copies all dimensions.
+                 */
                 auto xp = makeArrayRef(*upd->xp()).subArray(0, homenr);
                 auto x  = makeConstArrayRef(state->x).subArray(0, homenr);
                 for (int i = 0; i < homenr; i++)
@@ -1624,10 +1629,7 @@ void finish_update(const t_inputrec*       inputrec, /* input record and box stu
                     }
                 }
             }
-        }
 
-        if (graph && (graph->nnodes > 0))
-        {
             unshift_x(graph, state->box, state->x.rvec_array(), upd->xp()->rvec_array());
             if (TRICLINIC(state->box))
             {
@@ -1643,13 +1645,33 @@ void finish_update(const t_inputrec*       inputrec, /* input record and box stu
             auto xp = makeConstArrayRef(*upd->xp()).subArray(0, homenr);
             auto x  = makeArrayRef(state->x).subArray(0, homenr);
 
-
             int gmx_unused nth = gmx_omp_nthreads_get(emntUpdate);
+            if (partialFreezeAndConstraints)
+            {
+                /* Copy only the non-frozen dimensions, in the same pass */
+                const unsigned short* cFREEZE = md->cFREEZE;
 #pragma omp parallel for num_threads(nth) schedule(static)
-            for (int i = 0; i < homenr; i++)
+                for (int i = 0; i < homenr; i++)
+                {
+                    // Trivial statements, do not throw
+                    const int g = cFREEZE[i];
+                    for (int d = 0; d < DIM; d++)
+                    {
+                        if (!nFreeze[g][d])
+                        {
+                            x[i][d] = xp[i][d];
+                        }
+                    }
+                }
+            }
+            else
             {
-                // Trivial statement, does not throw
-                x[i] = xp[i];
+#pragma omp parallel for num_threads(nth) schedule(static)
+                for (int i = 0; i < homenr; i++)
+                {
+                    // Trivial statement, does not throw
+                    x[i] = xp[i];
+                }
             }
         }
         wallcycle_stop(wcycle, ewcUPDATE);
@@ -1753,6 +1775,19 @@ void update_pcouple_after_coordinates(FILE*             fplog,
     }
 }
 
+/*! \brief Updates the NMR restraint history, needed when time averaging is used */
+static void updateRestraintHistory(const t_fcdata* fcd, t_state* state)
+{
+    if (state->flags & (1 << estDISRE_RM3TAV))
+    {
+        update_disres_history(fcd, &state->hist);
+    }
+    if (state->flags & (1 << estORIRE_DTAV))
+    {
+        update_orires_history(fcd, &state->hist);
+    }
+}
+
 void update_coords(int64_t           step,
                    const t_inputrec* inputrec, /* input record and box stuff	*/
                    const t_mdatoms*  md,
@@ -1779,15 +1814,7 @@ void update_coords(int64_t           step,
     /* Cast to real for faster code, no loss in precision (see comment above) */
     real dt = inputrec->delta_t;
 
-    /* We need to update the NMR restraint history when time averaging is used */
-    if (state->flags & (1 << estDISRE_RM3TAV))
-    {
-        update_disres_history(fcd, &state->hist);
-    }
-    if (state->flags & (1 << estORIRE_DTAV))
-    {
-        update_orires_history(fcd, &state->hist);
-    }
+    updateRestraintHistory(fcd, state);
 
     /* ############# START The update of velocities and positions ######### */
     int nth = gmx_omp_nthreads_get(emntUpdate);
@@ -1865,6 +1892,61 @@ void update_coords(int64_t           step,
     }
 }
 
+void update_coords_fused(int64_t                                   step,
+                         const t_inputrec*                         inputrec,
+                         const t_mdatoms*                          md,
+                         t_state*                                  state,
+                         gmx::ArrayRefWithPadding<const gmx::RVec> f,
+                         const t_fcdata*                           fcd,
+                         const gmx_ekindata_t*                     ekind,
+                         const matrix                              M,
+                         Update*                                   upd)
+{
+    GMX_ASSERT(inputrec->eI == eiMD, "The fused update only supports the leap-frog integrator");
+
+    /* Blocks of this many atoms keep x, xprime, v and f in the L1 cache
+     * between the update and the copy. A multiple of the SIMD width.
+     */
+    constexpr int c_blockSize = 256;
+
+    updateRestraintHistory(fcd, state);
+
+    const int  homenr = md->homenr;
+    const real dt     = inputrec->delta_t;
+
+    int nth = gmx_omp_nthreads_get(emntUpdate);
+
+#pragma omp parallel for num_threads(nth) schedule(static)
+    for (int th = 0; th < nth; th++)
+    {
+        try
+        {
+            int start_th, end_th;
+            getThreadAtomRange(nth, th, homenr, &start_th, &end_th);
+
+            rvec*       x_rvec  = state->x.rvec_array();
+            rvec*       xp_rvec = upd->xp()->rvec_array();
+            rvec*       v_rvec  = state->v.rvec_array();
+            const rvec* f_rvec  = as_rvec_array(f.unpaddedArrayRef().data());
+
+            for (int blockStart = start_th; blockStart < end_th; blockStart += c_blockSize)
+            {
+                const int blockEnd = std::min(blockStart + c_blockSize, end_th);
+
+                do_update_md(blockStart, blockEnd, step, dt, inputrec, md, ekind, state->box,
+                             x_rvec, xp_rvec, v_rvec, f_rvec, state->nosehoover_vxi.data(), M);
+
+                /* The copy of finish_update(), while the block is in cache */
+                for (int i = blockStart; i < blockEnd; i++)
+                {
+                    copy_rvec(xp_rvec[i], x_rvec[i]);
+                }
+            }
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+}
+
 extern gmx_bool update_randomize_velocities(const t_inputrec*        ir,
                                             int64_t                  step,
                                             const t_commrec*         cr,
@@ -150,6 +150,23 @@ void update_coords(int64_t           step,
                    const t_commrec* cr, /* these shouldn't be here -- need to think about it */
                    const gmx::Constraints* constr);
 
+/* Leap-frog update of the home atoms fused with the copy to state->x of finish_update().
+ * Processes each thread's atoms in blocks that stay in cache, instead of
+ * streaming all coordinates through memory twice. Gives the same result
+ * as update_coords() followed by finish_update(). Only for integrator md
+ * without constraints and without a graph, since constraints need
+ * the unconstrained coordinates and the graph requires unshifting.
+ */
+void update_coords_fused(int64_t                                   step,
+                         const t_inputrec*                         inputrec,
+                         const t_mdatoms*                          md,
+                         t_state*                                  state,
+                         gmx::ArrayRefWithPadding<const gmx::RVec> f,
+                         const t_fcdata*                           fcd,
+                         const gmx_ekindata_t*                     ekind,
+                         const matrix                              M,
+                         gmx::Update*                              upd);
+
 /* Return TRUE if OK, FALSE in case of Shake Error */
 
 extern gmx_bool update_randomize_velocities(const t_inputrec*        ir,
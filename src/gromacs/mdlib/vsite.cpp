@@ -41,6 +41,7 @@
 #include <cstdio>
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -83,6 +84,10 @@
  * to avoid high memory usage.
  *
  * Any remaining vsites are assigned to a separate master thread task.
+ * For construction, the vsites of this last task are ordered in levels
+ * of mutual dependence: vsites in level 0 only depend on atoms and vsites
+ * of the other tasks, vsites in level l depend on vsites in level l-1.
+ * All vsites within one level can then be constructed by all threads.
  */
 
 using gmx::RVec;
@@ -131,6 +136,13 @@ struct InterdependentTask
     }
 };
 
+/*! \brief Vsite interactions of one dependency level, see VsiteThread::levels */
+struct VsiteLevel
+{
+    //! The vsite interaction atoms per function type, only vsite entries are used
+    std::array<std::vector<t_iatom>, F_NRE> iatoms;
+};
+
 /*! \brief Vsite thread task data structure */
 struct VsiteThread
 {
@@ -148,6 +160,8 @@ struct VsiteThread
     bool useInterdependentTask;
     //! Data for vsites that involve constructing atoms in the atom range of other threads/tasks
     InterdependentTask idTask;
+    //! The vsites of ilist grouped by dependency level, only used for the last, serial task
+    std::vector<VsiteLevel> levels;
 
     /*! \brief Constructor */
     VsiteThread()
@@ -608,6 +622,47 @@ static void construct_vsites_thread(rvec            x[],
     }
 }
 
+/*! \brief Construct this thread's part of the vsites in one dependency level
+ *
+ * The entries of each vsite type are divided uniformly over the threads.
+ * The variable-size F_VSITEN entries are all constructed by thread 0.
+ */
+static void construct_vsites_level_thread(rvec              x[],
+                                          real              dt,
+                                          rvec*             v,
+                                          const t_iparams   ip[],
+                                          const VsiteLevel& level,
+                                          const t_pbc*      pbc_null,
+                                          int               thread,
+                                          int               numThreads)
+{
+    t_ilist ilist[F_NRE];
+    init_ilist(ilist);
+    for (int ftype = c_ftypeVsiteStart; ftype < c_ftypeVsiteEnd; ftype++)
+    {
+        const std::vector<t_iatom>& iatoms     = level.iatoms[ftype];
+        const int                   nral1      = 1 + NRAL(ftype);
+        const int                   numEntries = iatoms.size() / nral1;
+
+        int start, end;
+        if (ftype == F_VSITEN)
+        {
+            start = 0;
+            end   = (thread == 0 ? iatoms.size() : 0);
+        }
+        else
+        {
+            start = nral1 * ((numEntries * thread) / numThreads);
+            end   = nral1 * ((numEntries * (thread + 1)) / numThreads);
+        }
+        ilist[ftype].nr = end - start;
+        /* We only read the atom indices, so we can cast away the const */
+        ilist[ftype].iatoms = const_cast<t_iatom*>(iatoms.data()) + start;
+    }
+
+    construct_vsites_thread(x, dt, v, ip, ilist, pbc_null);
+}
+
 void construct_vsites(const gmx_vsite_t* vsite,
                       rvec               x[],
                       real               dt,
@@ -677,11 +732,20 @@ void construct_vsites(const gmx_vsite_t* vsite,
                      */
                     construct_vsites_thread(x, dt, v, ip, tData.idTask.ilist, pbc_null);
                 }
+
+                /* Now we can construct the vsites that might depend on other vsites.
+                 * Each level only depends on the tasks above and lower levels,
+                 * so we need a barrier before each level.
+                 */
+                for (const VsiteLevel& level : vsite->tData[vsite->nthreads]->levels)
+                {
+#pragma omp barrier
+                    construct_vsites_level_thread(x, dt, v, ip, level, pbc_null, th,
+                                                  vsite->nthreads);
+                }
             }
             GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
         }
-        /* Now we can construct the vsites that might depend on other vsites */
-        construct_vsites_thread(x, dt, v, ip, vsite->tData[vsite->nthreads]->ilist, pbc_null);
     }
 }
 
@@ -2286,6 +2350,95 @@ static void assignVsitesToSingleTask(VsiteThread*             tData,
     }
 }
 
+/*! \brief Group the vsites of the serial task tData by dependency level
+ *
+ * The vsites are processed in the order of the serial construction.
+ * A vsite gets one level higher than the highest level of the vsites
+ * in tData it is constructed from. A vsite can also be constructed from
+ * a vsite that comes later in the serial order, it then uses the position
+ * of that vsite before its construction. To reproduce this, and to avoid
+ * a data race, a vsite also gets one level higher than the highest level
+ * of the earlier vsites that are constructed from it. Thus no atom is
+ * read and written within the same level and the result is identical
+ * to serial construction.
+ */
+static void assignVsitesToLevels(VsiteThread* tData, int numAtoms, const t_iparams* ip)
+{
+    for (VsiteLevel& level : tData->levels)
+    {
+        for (int ftype = c_ftypeVsiteStart; ftype < c_ftypeVsiteEnd; ftype++)
+        {
+            level.iatoms[ftype].clear();
+        }
+    }
+    if (vsiteIlistNrCount(tData->ilist) == 0)
+    {
+        tData->levels.clear();
+        return;
+    }
+
+    /* The level of each vsite in our task, -1 for all other atoms */
+    std::vector<int> atomLevel(numAtoms, -1);
+    /* The highest level of the vsites in our task that read each atom, -1 when not read */
+    std::vector<int> atomReadLevel(numAtoms, -1);
+    int              numLevels = 0;
+    for (int ftype = c_ftypeVsiteStart; ftype < c_ftypeVsiteEnd; ftype++)
+    {
+        const t_ilist& il    = tData->ilist[ftype];
+        const int      nral1 = 1 + NRAL(ftype);
+        int            inc   = nral1;
+        for (int i = 0; i < il.nr; i += inc)
+        {
+            const t_iatom* ia    = il.iatoms + i;
+            int            level = 0;
+            if (ftype == F_VSITEN)
+            {
+                /* The 3 below is from 1+NRAL(ftype)=3 */
+                inc = ip[ia[0]].vsiten.n * 3;
+                for (int j = 0; j < inc; j += 3)
+                {
+                    level = std::max(level, atomLevel[ia[j + 2]] + 1);
+                }
+            }
+            else
+            {
+                for (int j = 2; j < nral1; j++)
+                {
+                    level = std::max(level, atomLevel[ia[j]] + 1);
+                }
+            }
+            level            = std::max(level, atomReadLevel[ia[1]] + 1);
+            atomLevel[ia[1]] = level;
+            if (ftype == F_VSITEN)
+            {
+                for (int j = 0; j < inc; j += 3)
+                {
+                    atomReadLevel[ia[j + 2]] = std::max(atomReadLevel[ia[j + 2]], level);
+                }
+            }
+            else
+            {
+                for (int j = 2; j < nral1; j++)
+                {
+                    atomReadLevel[ia[j]] = std::max(atomReadLevel[ia[j]], level);
+                }
+            }
+
+            if (level >= numLevels)
+            {
+                numLevels = level + 1;
+                if (static_cast<int>(tData->levels.size()) < numLevels)
+                {
+                    tData->levels.resize(numLevels);
+                }
+            }
+            std::vector<t_iatom>& levelIatoms = tData->levels[level].iatoms[ftype];
+            levelIatoms.insert(levelIatoms.end(), ia, ia + inc);
+        }
+    }
+    tData->levels.resize(numLevels);
+}
+
 void split_vsites_over_threads(const t_ilist* ilist, const t_iparams* ip, const t_mdatoms* mdatoms, gmx_vsite_t* vsite)
 {
     int vsite_atom_range, natperthread;
@@ -2504,6 +2657,7 @@ void split_vsites_over_threads(const t_ilist* ilist, const t_iparams* ip, const
      */
     assignVsitesToSingleTask(vsite->tData[vsite->nthreads].get(), 2 * vsite->nthreads, taskIndex,
                              ilist, ip);
+    assignVsitesToLevels(vsite->tData[vsite->nthreads].get(), mdatoms->nr, ip);
 
     if (debug && vsite->nthreads > 1)
     {
@@ -2514,6 +2668,8 @@ void split_vsites_over_threads(const t_ilist* ilist, const t_iparams* ip, const
             fprintf(debug, " %4d", vsite->tData[th]->idTask.nuse);
         }
         fprintf(debug, "\n");
+        fprintf(debug, "virtual site dependency levels of the last task: %zu\n",
+                vsite->tData[vsite->nthreads]->levels.size());
 
         for (int ftype = c_ftypeVsiteStart; ftype < c_ftypeVsiteEnd; ftype++)
         {
@@ -163,7 +163,7 @@ void gmx::LegacySimulator::do_md()
     int64_t      step, step_rel;
     double       t, t0 = ir->init_t, lam0[efptNR];
     gmx_bool     bGStatEveryStep, bGStat, bCalcVir, bCalcEnerStep, bCalcEner;
-    gmx_bool     bNS, bNStList, bStopCM, bFirstStep, bInitStep, bLastStep = FALSE;
+    gmx_bool     bNS, bNStList, bSearchSkipped, bStopCM, bFirstStep, bInitStep, bLastStep = FALSE;
     gmx_bool     bDoDHDL = FALSE, bDoFEP = FALSE, bDoExpanded = FALSE;
     gmx_bool     do_ene, do_log, do_verbose;
     gmx_bool     bMasterState;
@@ -796,6 +796,19 @@ void gmx::LegacySimulator::do_md()
         /* Stop Center of Mass motion */
         bStopCM = (ir->comm_mode != ecmNO && do_per_step(step, ir->nstcomm));
 
+        /* With incremental search the pairlist is checked every step and
+         * we search as soon as it might miss pairs, instead of every nstlist
+         * steps. The list is then valid for all steps it is used at.
+         */
+        bSearchSkipped = FALSE;
+        if (fr->nbv->useIncrementalSearch() && !bFirstStep && !bExchanged && !bNeedRepartition
+            && !bPMETune && !useGpuForUpdate)
+        {
+            const bool pairlistIsValid = fr->nbv->pairlistIsValid(state->x);
+            bSearchSkipped             = (bNStList && pairlistIsValid);
+            bNStList                   = !pairlistIsValid;
+        }
+
         /* Determine whether or not to do Neighbour Searching */
         bNS = (bFirstStep || bNStList || bExchanged || bNeedRepartition);
 
@@ -804,7 +817,7 @@ void gmx::LegacySimulator::do_md()
          * nstpcouple steps, we have computed the half-step kinetic energy
          * of the previous step and can always output energies at the last step.
          */
-        bLastStep = bLastStep || stopHandler->stoppingAfterCurrentStep(bNS);
+        bLastStep = bLastStep || stopHandler->stoppingAfterCurrentStep(bNS || bSearchSkipped);
 
         /* do_log triggers energy and virial calculation. Because this leads
          * to different code paths, forces can be different. Thus for exact
@@ -890,7 +903,8 @@ void gmx::LegacySimulator::do_md()
         }
         clear_mat(force_vir);
 
-        checkpointHandler->decideIfCheckpointingThisStep(bNS, bFirstStep, bLastStep);
+        checkpointHandler->decideIfCheckpointingThisStep(bNS || bSearchSkipped, bFirstStep,
+                                                         bLastStep);
 
         /* Determine the energy and pressure:
          * at nstcalcenergy steps and at energy output steps (set below).
@@ -1304,6 +1318,16 @@ void gmx::LegacySimulator::do_md()
                 stateGpu->waitVelocitiesReadyOnHost(AtomLocality::Local);
             }
         }
+        else if (ir->eI == eiMD && constr == nullptr && !(graph && graph->nnodes > 0))
+        {
+            /* Without constraints we can copy the updated coordinates back
+             * to state->x block by block, while they are still in cache.
+             */
+            update_coords_fused(step, ir, mdatoms, state, f.arrayRefWithPadding(), fcd, ekind, M,
+                                &upd);
+
+            wallcycle_stop(wcycle, ewcUPDATE);
+        }
         else
         {
             update_coords(step, ir, mdatoms, state, f.arrayRefWithPadding(), fcd, ekind, M, &upd,
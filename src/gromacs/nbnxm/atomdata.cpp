@@ -1172,9 +1172,14 @@ gmx_unused static void nbnxn_atomdata_reduce_reals_simd(real gmx_unused* gmx_res
 }
 
 /* Add part of the force array(s) from nbnxn_atomdata_t to f
+ *
+ * With useBlockBuffers=true, the forces for each flag block are read
+ * from the output buffer set in nbat.forceBufferOfFlagBlock,
+ * otherwise all forces are read from \p out.
  *
  * Note: Adding restrict to f makes this function 50% slower with gcc 7.3
  */
+template<bool useBlockBuffers>
 static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          gridSet,
                                                 const nbnxn_atomdata_t&        nbat,
                                                 const nbnxn_atomdata_output_t& out,
@@ -1184,7 +1189,8 @@ static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          g
 {
     gmx::ArrayRef<const int> cell = gridSet.cells();
     // Note: Using ArrayRef instead makes this code 25% slower with gcc 7.3
-    const real* fnb = out.f.data();
+    const real*        fnbOut     = out.f.data();
+    const real* const* fnbOfBlock = nbat.forceBufferOfFlagBlock.data();
 
     /* Loop over all columns and copy and fill */
     switch (nbat.FFormat)
@@ -1193,6 +1199,9 @@ static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          g
         case nbatXYZQ:
             for (int a = a0; a < a1; a++)
             {
+                const real* fnb =
+                        useBlockBuffers ? fnbOfBlock[cell[a] / NBNXN_BUFFERFLAG_SIZE] : fnbOut;
+
                 int i = cell[a] * nbat.fstride;
 
                 f[a][XX] += fnb[i];
@@ -1203,6 +1212,9 @@ static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          g
         case nbatX4:
             for (int a = a0; a < a1; a++)
             {
+                const real* fnb =
+                        useBlockBuffers ? fnbOfBlock[cell[a] / NBNXN_BUFFERFLAG_SIZE] : fnbOut;
+
                 int i = atom_to_x_index<c_packX4>(cell[a]);
 
                 f[a][XX] += fnb[i + XX * c_packX4];
@@ -1213,6 +1225,9 @@ static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          g
         case nbatX8:
             for (int a = a0; a < a1; a++)
             {
+                const real* fnb =
+                        useBlockBuffers ? fnbOfBlock[cell[a] / NBNXN_BUFFERFLAG_SIZE] : fnbOut;
+
                 int i = atom_to_x_index<c_packX8>(cell[a]);
 
                 f[a][XX] += fnb[i + XX * c_packX8];
@@ -1359,8 +1374,19 @@ static void nbnxn_atomdata_add_nbat_f_to_f_treereduce(nbnxn_atomdata_t* nbat, in
 }
 
 
+/* Reduces the flagged blocks of the thread output buffers into buffer 0.
+ *
+ * Blocks that only got force contributions from a single thread other than
+ * thread 0 are not copied. Instead nbat->forceBufferOfFlagBlock is set to
+ * point to the buffer of that thread, so the final reduction into the force
+ * buffer reads it directly. With many threads and large systems, most blocks
+ * are only touched by the thread that owns the i-clusters in the block and
+ * this avoids a write and read of these blocks in buffer 0.
+ */
 static void nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbnxn_atomdata_t* nbat, int nth)
 {
+    nbat->forceBufferOfFlagBlock.resize(nbat->buffer_flags.nflag);
+
 #pragma omp parallel for num_threads(nth) schedule(static)
     for (int th = 0; th < nth; th++)
     {
@@ -1389,6 +1415,13 @@ static void nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbnxn_atomdata_t* nbat, int
                         fptr[nfptr++] = nbat->out[out].f.data();
                     }
                 }
+                if (nfptr == 1 && !bitmask_is_set(flags->flag[b], 0))
+                {
+                    /* Only one thread contributed, use its buffer directly */
+                    nbat->forceBufferOfFlagBlock[b] = fptr[0];
+                    continue;
+                }
+
                 if (nfptr > 0)
                 {
 #if GMX_SIMD
@@ -1402,6 +1435,7 @@ static void nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbnxn_atomdata_t* nbat, int
                 {
                     nbnxn_atomdata_clear_reals(nbat->out[0].f, i0, i1);
                 }
+                nbat->forceBufferOfFlagBlock[b] = nbat->out[0].f.data();
             }
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
@@ -1444,13 +1478,25 @@ void reduceForces(nbnxn_atomdata_t* nbat, const gmx::AtomLocality locality, cons
             nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbat, nth);
         }
     }
+    /* The standard reduction leaves single-thread blocks in their own buffers */
+    const bool useBlockBuffers = (nbat->out.size() > 1 && !nbat->bUseTreeReduce);
 #pragma omp parallel for num_threads(nth) schedule(static)
     for (int th = 0; th < nth; th++)
     {
         try
         {
-            nbnxn_atomdata_add_nbat_f_to_f_part(gridSet, *nbat, nbat->out[0], a0 + ((th + 0) * na) / nth,
-                                                a0 + ((th + 1) * na) / nth, f);
+            const int aStart = a0 + ((th + 0) * na) / nth;
+            const int aEnd   = a0 + ((th + 1) * na) / nth;
+            if (useBlockBuffers)
+            {
+                nbnxn_atomdata_add_nbat_f_to_f_part<true>(gridSet, *nbat, nbat->out[0], aStart,
+                                                           aEnd, f);
+            }
+            else
+            {
+                nbnxn_atomdata_add_nbat_f_to_f_part<false>(gridSet, *nbat, nbat->out[0], aStart,
+                                                            aEnd, f);
+            }
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
@@ -38,6 +38,8 @@
 
 #include <cstdio>
 
+#include <vector>
+
 #include "gromacs/gpu_utils/devicebuffer_datatype.h"
 #include "gromacs/gpu_utils/hostallocator.h"
 #include "gromacs/math/vectypes.h"
@@ -267,6 +269,8 @@ public:
     nbnxn_buffer_flags_t buffer_flags;    /* Flags for buffer zeroing+reduc.  */
     gmx_bool             bUseTreeReduce;  /* Use tree for force reduction */
     tMPI_Atomic*         syncStep;        /* Synchronization step for tree reduce */
+    /* For each flag block, the output buffer with the reduced forces, set by the standard reduction */
+    std::vector<const real*> forceBufferOfFlagBlock;
 };
 
 /* Copy na rvec elements from x to xnb using nbatFormat, start dest a0,
@@ -47,6 +47,7 @@
 
 #include "gromacs/compat/optional.h"
 #include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/hardware/identifyavx512fmaunits.h"
 #include "gromacs/mdlib/dispersioncorrection.h"
 #include "gromacs/mdlib/force_flags.h"
 #include "gromacs/mdlib/forcerec.h"
@@ -398,6 +399,10 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
     if (options.nbnxmSimd != BenchMarkKernels::SimdNo)
     {
         fprintf(stdout, "SIMD width:           %d\n", GMX_SIMD_REAL_WIDTH);
+#    if GMX_SIMD_X86_AVX_512
+        /* The relative performance of the 4xM and 2xMM layouts depends on this */
+        fprintf(stdout, "AVX-512 FMA units:    %d\n", gmx::identifyAvx512FmaUnits());
+#    endif
     }
 #endif
     fprintf(stdout, "System size:          %zu atoms\n", system.coordinates.size());
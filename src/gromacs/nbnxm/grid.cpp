@@ -47,6 +47,8 @@
 #include "grid.h"
 
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 
 #include <algorithm>
@@ -79,6 +81,7 @@ Grid::Geometry::Geometry(const PairlistType pairlistType) :
 
 Grid::Grid(const PairlistType pairlistType, const bool& haveFep) :
     geometry_(pairlistType),
+    useHilbertSearchOrder_(getenv("GMX_NBNXN_HILBERT_SEARCH_ORDER") != nullptr),
     haveFep_(haveFep)
 {
 }
@@ -1283,6 +1286,82 @@ static void resizeForNumberOfCells(const int         numNbnxnAtoms,
     nbat->resizeCoordinateBuffer(numNbnxnAtoms);
 }
 
+/*! \brief Returns the index of point (x,y) along a Hilbert curve filling an n x n square
+ *
+ * \p n should be a power of 2.
+ */
+static int64_t hilbertCurveIndex(const int n, int x, int y)
+{
+    int64_t index = 0;
+    for (int s = n / 2; s > 0; s /= 2)
+    {
+        const int rx = ((x & s) > 0) ? 1 : 0;
+        const int ry = ((y & s) > 0) ? 1 : 0;
+        index += static_cast<int64_t>(s) * s * ((3 * rx) ^ ry);
+        /* Rotate the quadrant so the lower levels have the right orientation */
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+
+    return index;
+}
+
+void Grid::setSearchOrder()
+{
+    const int numCellsX = dimensions_.numCells[XX];
+    const int numCellsY = dimensions_.numCells[YY];
+
+    /* The column order only changes when the grid dimensions change */
+    if (numCellsX != hilbertNumCells_[XX] || numCellsY != hilbertNumCells_[YY])
+    {
+        int n = 1;
+        while (n < std::max(numCellsX, numCellsY))
+        {
+            n *= 2;
+        }
+
+        std::vector<std::pair<int64_t, int>> curveIndexAndColumn;
+        curveIndexAndColumn.reserve(numColumns());
+        for (int cx = 0; cx < numCellsX; cx++)
+        {
+            for (int cy = 0; cy < numCellsY; cy++)
+            {
+                curveIndexAndColumn.emplace_back(hilbertCurveIndex(n, cx, cy), cx * numCellsY + cy);
+            }
+        }
+        std::sort(curveIndexAndColumn.begin(), curveIndexAndColumn.end());
+
+        hilbertColumnOrder_.resize(numColumns());
+        for (int i = 0; i < numColumns(); i++)
+        {
+            hilbertColumnOrder_[i] = curveIndexAndColumn[i].second;
+        }
+        hilbertNumCells_[XX] = numCellsX;
+        hilbertNumCells_[YY] = numCellsY;
+    }
+
+    cellsInSearchOrder_.resize(numCellsTotal_);
+    columnsInSearchOrder_.resize(numCellsTotal_);
+    int index = 0;
+    for (const int cxy : hilbertColumnOrder_)
+    {
+        for (int cell = firstCellInColumn(cxy); cell < firstCellInColumn(cxy + 1); cell++)
+        {
+            cellsInSearchOrder_[index]   = cell;
+            columnsInSearchOrder_[index] = cxy;
+            index++;
+        }
+    }
+    GMX_ASSERT(index == numCellsTotal_, "All cells should be in the search order");
+}
+
 void Grid::setCellIndices(int                            ddZone,
                           int                            cellOffset,
                           GridSetData*                   gridSetData,
@@ -1427,6 +1506,11 @@ void Grid::setCellIndices(int                            ddZone,
         }
     }
 
+    if (useHilbertSearchOrder_)
+    {
+        setSearchOrder();
+    }
+
     if (debug)
     {
         if (geometry_.isSimple)
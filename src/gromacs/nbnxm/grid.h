@@ -267,6 +267,18 @@ public:
     //! Returns the number of real atoms in the column
     int numAtomsPerCell() const { return geometry_.numAtomsPerCell; }
 
+    /*! \brief Returns the cells in the order in which they are used as i-cells in the search
+     *
+     * Empty when the cells are searched in index order. With the environment
+     * variable GMX_NBNXN_HILBERT_SEARCH_ORDER set, the columns are traversed
+     * along a Hilbert curve in the x/y-plane, which improves the cache reuse
+     * of j-cluster data between consecutive i-cells.
+     */
+    gmx::ArrayRef<const int> cellsInSearchOrder() const { return cellsInSearchOrder_; }
+
+    //! Returns the column index for each entry in cellsInSearchOrder()
+    gmx::ArrayRef<const int> columnsInSearchOrder() const { return columnsInSearchOrder_; }
+
     //! Returns the number of atoms in the column including padding
     int paddedNumAtomsInColumn(int columnIndex) const
     {
@@ -356,6 +368,9 @@ public:
                                   gmx::ArrayRef<int>             cxy_na);
 
 private:
+    //! Sets up the i-cell search order, called at the end of setCellIndices()
+    void setSearchOrder();
+
     /*! \brief Fill a pair search cell with atoms
      *
      * Potentially sorts atoms and sets the interaction flags.
@@ -414,6 +429,17 @@ private:
      * \todo Needs a useful name. */
     gmx::HostVector<int> cxy_ind_;
 
+    //! Whether to search the i-cells in Hilbert curve order of the columns
+    bool useHilbertSearchOrder_;
+    //! The number of columns along x and y for which hilbertColumnOrder_ was set up
+    int hilbertNumCells_[DIM - 1] = { 0, 0 };
+    //! The column indices in Hilbert curve order
+    std::vector<int> hilbertColumnOrder_;
+    //! The cells in search order, empty when searching in index order
+    std::vector<int> cellsInSearchOrder_;
+    //! The column index for each entry in cellsInSearchOrder_
+    std::vector<int> columnsInSearchOrder_;
+
     //! The number of cluster for each cell
     std::vector<int> numClusters_;
 
@@ -35,6 +35,9 @@
 
 #include "gmxpre.h"
 
+#include <array>
+#include <vector>
+
 #include "gromacs/gmxlib/nrnb.h"
 #include "gromacs/gmxlib/nonbonded/nb_free_energy.h"
 #include "gromacs/gmxlib/nonbonded/nb_kernel.h"
@@ -527,32 +530,56 @@ void nonbonded_verlet_t::dispatchFreeEnergyKernel(gmx::InteractionLocality   iLo
      */
     if (fepvals->n_lambda > 0 && stepWork.computeDhdl && fepvals->sc_alpha != 0)
     {
-        real lam_i[efptNR];
-        kernel_data.flags = (donb_flags & ~(GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE))
-                            | GMX_NONBONDED_DO_FOREIGNLAMBDA;
-        kernel_data.lambda         = lam_i;
-        kernel_data.energygrp_elec = enerd->foreign_grpp.ener[egCOULSR].data();
-        kernel_data.energygrp_vdw  = enerd->foreign_grpp.ener[egLJSR].data();
-        /* Note that we add to kernel_data.dvdl, but ignore the result */
-
-        for (size_t i = 0; i < enerd->enerpart_lambda.size(); i++)
+        /* We compute the energies for all lambda values in one parallel
+         * region. Each thread processes its own list for all lambda values,
+         * which keeps the list and coordinates in cache and avoids a thread
+         * synchronization per lambda value.
+         */
+        const int numLambdas          = enerd->enerpart_lambda.size();
+        const int numEnergyGroupPairs = enerd->foreign_grpp.nener;
+
+        std::vector<std::array<real, efptNR>> lambdas(numLambdas);
+        std::vector<real>                     energiesCoulomb(numLambdas * numEnergyGroupPairs, 0);
+        std::vector<real>                     energiesVdw(numLambdas * numEnergyGroupPairs, 0);
+        std::vector<nb_kernel_data_t>         foreignKernelData(numLambdas, kernel_data);
+        for (int i = 0; i < numLambdas; i++)
         {
             for (int j = 0; j < efptNR; j++)
             {
-                lam_i[j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
+                lambdas[i][j] = (i == 0 ? lambda[j] : fepvals->all_lambda[j][i - 1]);
             }
-            reset_foreign_enerdata(enerd);
+            foreignKernelData[i].flags =
+                    (donb_flags & ~(GMX_NONBONDED_DO_FORCE | GMX_NONBONDED_DO_SHIFTFORCE))
+                    | GMX_NONBONDED_DO_FOREIGNLAMBDA;
+            foreignKernelData[i].lambda         = lambdas[i].data();
+            foreignKernelData[i].energygrp_elec = energiesCoulomb.data() + i * numEnergyGroupPairs;
+            foreignKernelData[i].energygrp_vdw  = energiesVdw.data() + i * numEnergyGroupPairs;
+            /* Note that we add to kernel_data.dvdl, but ignore the result */
+        }
+
 #pragma omp parallel for schedule(static) num_threads(nbl_fep.ssize())
-            for (gmx::index th = 0; th < nbl_fep.ssize(); th++)
+        for (gmx::index th = 0; th < nbl_fep.ssize(); th++)
+        {
+            try
             {
-                try
+                for (int i = 0; i < numLambdas; i++)
                 {
                     gmx_nb_free_energy_kernel(nbl_fep[th].get(), x, forceWithShiftForces, fr,
-                                              &mdatoms, &kernel_data, nrnb);
+                                              &mdatoms, &foreignKernelData[i], nrnb);
                 }
-                GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
             }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
 
+        for (int i = 0; i < numLambdas; i++)
+        {
+            reset_foreign_enerdata(enerd);
+            const int offset = i * numEnergyGroupPairs;
+            for (int gp = 0; gp < numEnergyGroupPairs; gp++)
+            {
+                enerd->foreign_grpp.ener[egCOULSR][gp] = energiesCoulomb[offset + gp];
+                enerd->foreign_grpp.ener[egLJSR][gp]   = energiesVdw[offset + gp];
+            }
             sum_epot(&(enerd->foreign_grpp), enerd->foreign_term);
             enerd->enerpart_lambda[i] += enerd->foreign_term[F_EPOT];
         }
@@ -300,8 +300,8 @@
     rsq_S2 = max(rsq_S2, minRsq_S);
 
     /* Calculate 1/r */
-    rinv_S0 = invsqrt(rsq_S0);
-    rinv_S2 = invsqrt(rsq_S2);
+    rinv_S0 = Nbnxm::kernelInvsqrt(rsq_S0);
+    rinv_S2 = Nbnxm::kernelInvsqrt(rsq_S2);
 
 #ifdef CALC_COULOMB
     /* Load parameters for j atom */
@@ -388,14 +388,14 @@
      */
     brsq_S0   = beta2_S * selectByMask(rsq_S0, wco_S0);
     brsq_S2   = beta2_S * selectByMask(rsq_S2, wco_S2);
-    ewcorr_S0 = beta_S * pmeForceCorrection(brsq_S0);
-    ewcorr_S2 = beta_S * pmeForceCorrection(brsq_S2);
+    ewcorr_S0 = beta_S * Nbnxm::kernelPmeForceCorrection(brsq_S0);
+    ewcorr_S2 = beta_S * Nbnxm::kernelPmeForceCorrection(brsq_S2);
     frcoul_S0 = qq_S0 * fma(ewcorr_S0, brsq_S0, rinv_ex_S0);
     frcoul_S2 = qq_S2 * fma(ewcorr_S2, brsq_S2, rinv_ex_S2);
 
 #        ifdef CALC_ENERGIES
-    vc_sub_S0 = beta_S * pmePotentialCorrection(brsq_S0);
-    vc_sub_S2 = beta_S * pmePotentialCorrection(brsq_S2);
+    vc_sub_S0 = beta_S * Nbnxm::kernelPmePotentialCorrection(brsq_S0);
+    vc_sub_S2 = beta_S * Nbnxm::kernelPmePotentialCorrection(brsq_S2);
 #        endif
 
 #    endif /* CALC_COUL_EWALD */
@@ -738,11 +738,9 @@
 #        ifndef HALF_LJ
         cr2_S2 = lje_c2_S * selectByMask(rsq_S2, wco_vdw_S2);
 #        endif
-        // Unsafe version of our exp() should be fine, since these arguments should never
-        // be smaller than -127 for any reasonable choice of cutoff or ewald coefficients.
-        expmcr2_S0 = exp<MathOptimization::Unsafe>(-cr2_S0);
+        expmcr2_S0 = Nbnxm::kernelExp(-cr2_S0);
 #        ifndef HALF_LJ
-        expmcr2_S2 = exp<MathOptimization::Unsafe>(-cr2_S2);
+        expmcr2_S2 = Nbnxm::kernelExp(-cr2_S2);
 #        endif
 
         /* 1 + cr2 + 1/2*cr2^2 */
@@ -385,13 +385,13 @@
 
     /* Calculate 1/r */
 #    if !GMX_DOUBLE
-    rinv_S0 = invsqrt(rsq_S0);
-    rinv_S1 = invsqrt(rsq_S1);
-    rinv_S2 = invsqrt(rsq_S2);
-    rinv_S3 = invsqrt(rsq_S3);
+    rinv_S0 = Nbnxm::kernelInvsqrt(rsq_S0);
+    rinv_S1 = Nbnxm::kernelInvsqrt(rsq_S1);
+    rinv_S2 = Nbnxm::kernelInvsqrt(rsq_S2);
+    rinv_S3 = Nbnxm::kernelInvsqrt(rsq_S3);
 #    else
-    invsqrtPair(rsq_S0, rsq_S1, &rinv_S0, &rinv_S1);
-    invsqrtPair(rsq_S2, rsq_S3, &rinv_S2, &rinv_S3);
+    Nbnxm::kernelInvsqrtPair(rsq_S0, rsq_S1, &rinv_S0, &rinv_S1);
+    Nbnxm::kernelInvsqrtPair(rsq_S2, rsq_S3, &rinv_S2, &rinv_S3);
 #    endif
 
 #    ifdef CALC_COULOMB
@@ -505,20 +505,20 @@
     brsq_S1   = beta2_S * selectByMask(rsq_S1, wco_S1);
     brsq_S2   = beta2_S * selectByMask(rsq_S2, wco_S2);
     brsq_S3   = beta2_S * selectByMask(rsq_S3, wco_S3);
-    ewcorr_S0 = beta_S * pmeForceCorrection(brsq_S0);
-    ewcorr_S1 = beta_S * pmeForceCorrection(brsq_S1);
-    ewcorr_S2 = beta_S * pmeForceCorrection(brsq_S2);
-    ewcorr_S3 = beta_S * pmeForceCorrection(brsq_S3);
+    ewcorr_S0 = beta_S * Nbnxm::kernelPmeForceCorrection(brsq_S0);
+    ewcorr_S1 = beta_S * Nbnxm::kernelPmeForceCorrection(brsq_S1);
+    ewcorr_S2 = beta_S * Nbnxm::kernelPmeForceCorrection(brsq_S2);
+    ewcorr_S3 = beta_S * Nbnxm::kernelPmeForceCorrection(brsq_S3);
     frcoul_S0 = qq_S0 * fma(ewcorr_S0, brsq_S0, rinv_ex_S0);
     frcoul_S1 = qq_S1 * fma(ewcorr_S1, brsq_S1, rinv_ex_S1);
     frcoul_S2 = qq_S2 * fma(ewcorr_S2, brsq_S2, rinv_ex_S2);
     frcoul_S3 = qq_S3 * fma(ewcorr_S3, brsq_S3, rinv_ex_S3);
 
 #            ifdef CALC_ENERGIES
-    vc_sub_S0 = beta_S * pmePotentialCorrection(brsq_S0);
-    vc_sub_S1 = beta_S * pmePotentialCorrection(brsq_S1);
-    vc_sub_S2 = beta_S * pmePotentialCorrection(brsq_S2);
-    vc_sub_S3 = beta_S * pmePotentialCorrection(brsq_S3);
+    vc_sub_S0 = beta_S * Nbnxm::kernelPmePotentialCorrection(brsq_S0);
+    vc_sub_S1 = beta_S * Nbnxm::kernelPmePotentialCorrection(brsq_S1);
+    vc_sub_S2 = beta_S * Nbnxm::kernelPmePotentialCorrection(brsq_S2);
+    vc_sub_S3 = beta_S * Nbnxm::kernelPmePotentialCorrection(brsq_S3);
 #            endif
 
 #        endif /* CALC_COUL_EWALD */
@@ -991,13 +991,11 @@
         cr2_S2 = lje_c2_S * selectByMask(rsq_S2, wco_vdw_S2);
         cr2_S3 = lje_c2_S * selectByMask(rsq_S3, wco_vdw_S3);
 #            endif
-        // Unsafe version of our exp() should be fine, since these arguments should never
-        // be smaller than -127 for any reasonable choice of cutoff or ewald coefficients.
-        expmcr2_S0 = exp<MathOptimization::Unsafe>(-cr2_S0);
-        expmcr2_S1 = exp<MathOptimization::Unsafe>(-cr2_S1);
+        expmcr2_S0 = Nbnxm::kernelExp(-cr2_S0);
+        expmcr2_S1 = Nbnxm::kernelExp(-cr2_S1);
 #            ifndef HALF_LJ
-        expmcr2_S2 = exp<MathOptimization::Unsafe>(-cr2_S2);
-        expmcr2_S3 = exp<MathOptimization::Unsafe>(-cr2_S3);
+        expmcr2_S2 = Nbnxm::kernelExp(-cr2_S2);
+        expmcr2_S3 = Nbnxm::kernelExp(-cr2_S3);
 #            endif
 
         /* 1 + cr2 + 1/2*cr2^2 */
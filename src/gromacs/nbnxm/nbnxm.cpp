@@ -46,7 +46,9 @@
 #include "nbnxm.h"
 
 #include "gromacs/domdec/domdec_struct.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/timing/wallcycle.h"
+#include "gromacs/utility/gmxassert.h"
 
 #include "atomdata.h"
 #include "pairlistsets.h"
@@ -70,6 +72,11 @@ void nbnxn_put_on_grid(nonbonded_verlet_t*            nb_verlet,
     nb_verlet->pairSearch_->putOnGrid(box, gridIndex, lowerCorner, upperCorner, updateGroupsCog,
                                       atomRange, atomDensity, atomInfo, x, numAtomsMoved, move,
                                       nb_verlet->nbat.get());
+
+    if (gridIndex == 0 && nb_verlet->useIncrementalSearch())
+    {
+        nb_verlet->storeSearchCoordinates(x.subArray(*atomRange.begin(), atomRange.size()));
+    }
 }
 
 /* Calls nbnxn_put_on_grid for all non-local domains */
@@ -235,6 +242,59 @@ void nonbonded_verlet_t::changePairlistRadii(real rlistOuter, real rlistInner)
     pairlistSets_->changePairlistRadii(rlistOuter, rlistInner);
 }
 
+void nonbonded_verlet_t::enableIncrementalSearch(real interactionCutoff)
+{
+    GMX_RELEASE_ASSERT(pairlistIsSimple(), "Incremental search is only supported with CPU lists");
+
+    useIncrementalSearch_ = true;
+    interactionCutoff_    = interactionCutoff;
+}
+
+void nonbonded_verlet_t::storeSearchCoordinates(gmx::ArrayRef<const gmx::RVec> x)
+{
+    xAtLastSearch_.assign(x.begin(), x.end());
+}
+
+bool nonbonded_verlet_t::pairlistIsValid(gmx::ArrayRef<const gmx::RVec> x) const
+{
+    GMX_RELEASE_ASSERT(useIncrementalSearch_, "Can only check the list with incremental search");
+
+    if (x.ssize() < gmx::ssize(xAtLastSearch_))
+    {
+        return false;
+    }
+
+    /* A pair within a distance r now was within r plus twice the maximum
+     * displacement at the last search, so the list has all pairs within r
+     * when the displacement is less than half the buffer beyond r.
+     * With dynamic pruning the list is pruned to the inner radius, so it
+     * needs all pairs within the inner radius for the pruned list to be the
+     * same as after a fresh search; otherwise it needs those within the cut-off.
+     */
+    const real requiredRadius = pairlistSets().params().useDynamicPruning ? pairlistInnerRadius()
+                                                                          : interactionCutoff_;
+    const real maxDisplacement = 0.5 * (pairlistOuterRadius() - requiredRadius);
+    if (maxDisplacement <= 0)
+    {
+        return false;
+    }
+    const real maxDisplacement2 = maxDisplacement * maxDisplacement;
+
+    const int numAtoms  = gmx::ssize(xAtLastSearch_);
+    int       numMovers = 0;
+#pragma omp parallel for reduction(+ : numMovers) schedule(static) \
+        num_threads(gmx_omp_nthreads_get(emntDefault))
+    for (int a = 0; a < numAtoms; a++)
+    {
+        if (gmx::norm2(x[a] - xAtLastSearch_[a]) >= maxDisplacement2)
+        {
+            numMovers++;
+        }
+    }
+
+    return numMovers == 0;
+}
+
 void nonbonded_verlet_t::atomdata_init_copy_x_to_nbat_x_gpu()
 {
     Nbnxm::nbnxn_gpu_init_x_to_nbat_x(pairSearch_->gridSet(), gpu_nbv);
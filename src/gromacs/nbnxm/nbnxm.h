@@ -111,6 +111,7 @@
 #define GMX_NBNXM_NBNXM_H
 
 #include <memory>
+#include <vector>
 
 #include "gromacs/gpu_utils/devicebuffer_datatype.h"
 #include "gromacs/math/vectypes.h"
@@ -365,6 +366,29 @@ public:
     //! Changes the pair-list outer and inner radius
     void changePairlistRadii(real rlistOuter, real rlistInner);
 
+    /*! \brief Enables skipping of searches while the current pairlist is still exact
+     *
+     * \param[in] interactionCutoff  The maximum of the Van der Waals and Coulomb cut-off
+     */
+    void enableIncrementalSearch(real interactionCutoff);
+
+    //! Returns whether searches can be skipped, see pairlistIsValid()
+    bool useIncrementalSearch() const { return useIncrementalSearch_; }
+
+    //! Stores the coordinates \p x of the local atoms at a search step for pairlistIsValid()
+    void storeSearchCoordinates(gmx::ArrayRef<const gmx::RVec> x);
+
+    /*! \brief Returns whether the pairlist of the last search is exact for coordinates \p x
+     *
+     * The list contains all atom pairs within the interaction cut-off
+     * (or the inner radius with dynamic pruning) when no atom moved more
+     * than half the remaining pairlist buffer since the last search.
+     * The caller should check this at every step the list is used at and
+     * search when it returns false.
+     * Can only be called when useIncrementalSearch() returns true.
+     */
+    bool pairlistIsValid(gmx::ArrayRef<const gmx::RVec> x) const;
+
     //! Set up internal flags that indicate what type of short-range work there is.
     void setupGpuShortRangeWork(const gmx::GpuBonded* gpuBonded, const gmx::InteractionLocality iLocality)
     {
@@ -394,6 +418,12 @@ private:
     Nbnxm::KernelSetup kernelSetup_;
     //! \brief Pointer to wallcycle structure.
     gmx_wallcycle* wcycle_;
+    //! Whether we skip searches while the pairlist is still exact
+    bool useIncrementalSearch_ = false;
+    //! The maximum interaction cut-off, used with incremental search
+    real interactionCutoff_ = 0;
+    //! The local coordinates at the last search, used with incremental search
+    std::vector<gmx::RVec> xAtLastSearch_;
 
 public:
     //! GPU Nbnxm data, only used with a physical GPU (TODO: use unique_ptr)
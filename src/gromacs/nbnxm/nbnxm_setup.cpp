@@ -42,9 +42,12 @@
 
 #include "gmxpre.h"
 
+#include <algorithm>
+
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/hardware/hw_info.h"
+#include "gromacs/hardware/identifyavx512fmaunits.h"
 #include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/forcerec.h"
@@ -152,6 +155,19 @@ static KernelSetup pick_nbnxn_kernel_cpu(const t_inputrec gmx_unused* ir,
             /* One 256-bit FMA per cycle makes 2xNN faster */
             kernelSetup.kernelType = KernelType::Cpu4xN_Simd_2xNN;
         }
+
+#    if GMX_SIMD_X86_AVX_512
+        /* With AVX-512 we only get here in double precision, where 4xN
+         * uses a 4x8 and 2xNN a 2x(4+4) layout. The 4x8 layout computes
+         * more zero interactions, which might only pay off when both
+         * 512-bit FMA units can be kept busy. As this has not been
+         * benchmarked, choosing 2x(4+4) with a single FMA unit is opt-in.
+         */
+        if (getenv("GMX_NBNXN_SIMD_FMA_UNITS") != nullptr && gmx::identifyAvx512FmaUnits() == 1)
+        {
+            kernelSetup.kernelType = KernelType::Cpu4xN_Simd_2xNN;
+        }
+#    endif
 #endif /* GMX_NBNXN_SIMD_2XNN && GMX_NBNXN_SIMD_4XN */
 
 
@@ -460,8 +476,36 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger&     mdlo
             DOMAINDECOMP(cr) ? domdec_zones(cr->dd) : nullptr, pairlistParams.pairlistType,
             bFEP_NonBonded, gmx_omp_nthreads_get(emntPairsearch), pinPolicy);
 
-    return std::make_unique<nonbonded_verlet_t>(std::move(pairlistSets), std::move(pairSearch),
-                                                std::move(nbat), kernelSetup, gpu_nbv, wcycle);
+    auto nbv = std::make_unique<nonbonded_verlet_t>(std::move(pairlistSets), std::move(pairSearch),
+                                                    std::move(nbat), kernelSetup, gpu_nbv, wcycle);
+
+    /* Without domain decomposition and with a static box the pairlist
+     * can be reused as long as no atom moved too far since the last search.
+     */
+    if (getenv("GMX_NBNXN_INCREMENTAL_SEARCH") != nullptr)
+    {
+        if (EI_DYNAMICS(ir->eI) && !DOMAINDECOMP(cr) && nbv->pairlistIsSimple()
+            && !inputrecDynamicBox(ir) && ir->nstlist > 1)
+        {
+            nbv->enableIncrementalSearch(std::max(fr->ic->rvdw, fr->ic->rcoulomb));
+
+            GMX_LOG(mdlog.info)
+                    .asParagraph()
+                    .appendText(
+                            "Skipping pair searches while no atom moved more than half the "
+                            "pairlist buffer (GMX_NBNXN_INCREMENTAL_SEARCH)");
+        }
+        else
+        {
+            GMX_LOG(mdlog.info)
+                    .asParagraph()
+                    .appendText(
+                            "GMX_NBNXN_INCREMENTAL_SEARCH is ignored, it requires dynamics with "
+                            "a single rank, a static box and CPU non-bonded interactions");
+        }
+    }
+
+    return nbv;
 }
 
 } // namespace Nbnxm
@@ -38,8 +38,11 @@
 
 #include "gromacs/math/vectypes.h"
 #include "gromacs/simd/simd.h"
+#include "gromacs/simd/simd_math.h"
 #include "gromacs/utility/real.h"
 
+#include "config.h"
+
 #if GMX_SIMD
 /* The nbnxn SIMD 4xN and 2x(N+N) kernels can be added independently.
  * Currently the 2xNN SIMD kernels only make sense with:
@@ -57,6 +60,93 @@
 #        error "No SIMD kernel type defined"
 #    endif
 
+namespace Nbnxm
+{
+
+/* The math functions used in the inner loops of the SIMD kernels.
+ * With GMX_RELAXED_DOUBLE_PRECISION, double precision builds evaluate
+ * 1/sqrt(r^2), the Ewald corrections and the LJ-PME exponential
+ * to single precision accuracy only. Coordinates, parameters and
+ * the accumulation of forces and energies remain in double precision.
+ * This saves Newton-Raphson iterations and polynomial terms in
+ * the most expensive part of the kernels.
+ */
+#    if GMX_DOUBLE && GMX_RELAXED_DOUBLE_PRECISION
+
+//! Returns 1/sqrt(x) for the kernels
+static inline gmx::SimdReal gmx_simdcall kernelInvsqrt(gmx::SimdReal x)
+{
+    return gmx::invsqrtSingleAccuracy(x);
+}
+
+//! Returns 1/sqrt(x0) and 1/sqrt(x1) for the kernels
+static inline void gmx_simdcall kernelInvsqrtPair(gmx::SimdReal  x0,
+                                                  gmx::SimdReal  x1,
+                                                  gmx::SimdReal* out0,
+                                                  gmx::SimdReal* out1)
+{
+    gmx::invsqrtPairSingleAccuracy(x0, x1, out0, out1);
+}
+
+//! Returns the Ewald force correction for the kernels
+static inline gmx::SimdReal gmx_simdcall kernelPmeForceCorrection(gmx::SimdReal z2)
+{
+    return gmx::pmeForceCorrectionSingleAccuracy(z2);
+}
+
+//! Returns the Ewald potential correction for the kernels
+static inline gmx::SimdReal gmx_simdcall kernelPmePotentialCorrection(gmx::SimdReal z2)
+{
+    return gmx::pmePotentialCorrectionSingleAccuracy(z2);
+}
+
+//! Returns exp(x) for the LJ-PME grid correction in the kernels
+static inline gmx::SimdReal gmx_simdcall kernelExp(gmx::SimdReal x)
+{
+    return gmx::expSingleAccuracy<MathOptimization::Unsafe>(x);
+}
+
+#    else
+
+//! Returns 1/sqrt(x) for the kernels
+static inline gmx::SimdReal gmx_simdcall kernelInvsqrt(gmx::SimdReal x)
+{
+    return gmx::invsqrt(x);
+}
+
+//! Returns 1/sqrt(x0) and 1/sqrt(x1) for the kernels
+static inline void gmx_simdcall kernelInvsqrtPair(gmx::SimdReal  x0,
+                                                  gmx::SimdReal  x1,
+                                                  gmx::SimdReal* out0,
+                                                  gmx::SimdReal* out1)
+{
+    gmx::invsqrtPair(x0, x1, out0, out1);
+}
+
+//! Returns the Ewald force correction for the kernels
+static inline gmx::SimdReal gmx_simdcall kernelPmeForceCorrection(gmx::SimdReal z2)
+{
+    return gmx::pmeForceCorrection(z2);
+}
+
+//! Returns the Ewald potential correction for the kernels
+static inline gmx::SimdReal gmx_simdcall kernelPmePotentialCorrection(gmx::SimdReal z2)
+{
+    return gmx::pmePotentialCorrection(z2);
+}
+
+//! Returns exp(x) for the LJ-PME grid correction in the kernels
+static inline gmx::SimdReal gmx_simdcall kernelExp(gmx::SimdReal x)
+{
+    // Unsafe version of our exp() should be fine, since these arguments should never
+    // be smaller than -127 for any reasonable choice of cutoff or ewald coefficients.
+    return gmx::exp<MathOptimization::Unsafe>(x);
+}
+
+#    endif
+
+} // namespace Nbnxm
+
 #endif // GMX_SIMD
 
 #endif /* _nbnxn_simd_h */
@@ -2809,24 +2809,43 @@ static void balance_fep_lists(gmx::ArrayRef<std::unique_ptr<t_nblist>> fepLists,
     }
 }
 
-/* Returns the next ci to be processes by our thread */
-static gmx_bool next_ci(const Grid& grid, int nth, int ci_block, int* ci_x, int* ci_y, int* ci_b, int* ci)
+/* Returns the next ci to be processes by our thread.
+ * The blocks are assigned to tasks by the position ci_p in the search order,
+ * which is the cell index itself unless the grid has a search order set.
+ */
+static gmx_bool
+next_ci(const Grid& grid, int nth, int ci_block, int* ci_x, int* ci_y, int* ci_b, int* ci_p, int* ci)
 {
     (*ci_b)++;
-    (*ci)++;
+    (*ci_p)++;
 
     if (*ci_b == ci_block)
     {
         /* Jump to the next block assigned to this task */
-        *ci += (nth - 1) * ci_block;
+        *ci_p += (nth - 1) * ci_block;
         *ci_b = 0;
     }
 
-    if (*ci >= grid.numCells())
+    if (*ci_p >= grid.numCells())
     {
         return FALSE;
     }
 
+    gmx::ArrayRef<const int> cellsInSearchOrder = grid.cellsInSearchOrder();
+    if (!cellsInSearchOrder.empty())
+    {
+        const int numCellsY = grid.dimensions().numCells[YY];
+        const int cxy       = grid.columnsInSearchOrder()[*ci_p];
+
+        *ci   = cellsInSearchOrder[*ci_p];
+        *ci_x = cxy / numCellsY;
+        *ci_y = cxy - *ci_x * numCellsY;
+
+        return TRUE;
+    }
+
+    /* The cells are searched in index order, we only need to track the column */
+    *ci = *ci_p;
     while (*ci >= grid.firstCellInColumn(*ci_x * grid.dimensions().numCells[YY] + *ci_y + 1))
     {
         *ci_y += 1;
@@ -3100,7 +3119,7 @@ static void nbnxn_make_pairlist_part(const Nbnxm::GridSet&   gridSet,
     matrix         box;
     real           rl_fep2 = 0;
     float          rbb2;
-    int            ci_b, ci, ci_x, ci_y, ci_xy;
+    int            ci_b, ci_p, ci, ci_x, ci_y, ci_xy;
     ivec           shp;
     real           bx0, bx1, by0, by1, bz0, bz1;
     real           bz1_frac;
@@ -3229,14 +3248,15 @@ static void nbnxn_make_pairlist_part(const Nbnxm::GridSet&   gridSet,
     const real listRangeBBToJCell2 =
             gmx::square(listRangeForBoundingBoxToGridCell(rlist, jGrid.dimensions()));
 
-    /* Initially ci_b and ci to 1 before where we want them to start,
+    /* Initially ci_b and ci_p to 1 before where we want them to start,
      * as they will both be incremented in next_ci.
      */
     ci_b = -1;
-    ci   = th * ci_block - 1;
+    ci_p = th * ci_block - 1;
+    ci   = -1;
     ci_x = 0;
     ci_y = 0;
-    while (next_ci(iGrid, nth, ci_block, &ci_x, &ci_y, &ci_b, &ci))
+    while (next_ci(iGrid, nth, ci_block, &ci_x, &ci_y, &ci_b, &ci_p, &ci))
     {
         if (bSimple && flags_i[ci] == 0)
         {
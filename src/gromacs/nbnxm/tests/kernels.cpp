@@ -0,0 +1,307 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the SIMD non-bonded kernels
+ *
+ * The forces computed by the SIMD kernels for a box of water are
+ * compared with an exact double precision reference. With
+ * GMX_RELAXED_DOUBLE_PRECISION, double precision builds use
+ * single-accuracy math in the kernels, which is checked against
+ * the same single precision tolerance as mixed precision builds.
+ *
+ * \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include "config.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/ewald/ewald_utils.h"
+#include "gromacs/gmxlib/nrnb.h"
+#include "gromacs/math/units.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/mdlib/forcerec.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdtypes/enerdata.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/mdtypes/mdatom.h"
+#include "gromacs/mdtypes/simulation_workload.h"
+#include "gromacs/nbnxm/atomdata.h"
+#include "gromacs/nbnxm/gridset.h"
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/nbnxm/nbnxm_simd.h"
+#include "gromacs/nbnxm/pairlistset.h"
+#include "gromacs/nbnxm/pairlistsets.h"
+#include "gromacs/nbnxm/pairsearch.h"
+#include "gromacs/nbnxm/benchmark/bench_system.h"
+#include "gromacs/utility/logger.h"
+
+#include "testutils/testasserts.h"
+
+namespace Nbnxm
+{
+namespace test
+{
+namespace
+{
+
+//! The cut-off distance for all interactions
+constexpr real c_cutoff = 0.9;
+
+/*! \brief The relative force tolerance of the SIMD kernels
+ *
+ * Relative to the largest force component in the system. Kernels
+ * with single-accuracy math, i.e. mixed precision and relaxed double
+ * precision, are accurate to about 1e-6. Double precision kernels
+ * are limited by the analytical Ewald correction, to about 1e-10.
+ * The tolerances leave a margin for the summation order. */
+#if GMX_DOUBLE && !GMX_RELAXED_DOUBLE_PRECISION
+constexpr double c_relativeForceTolerance = 1e-9;
+#else
+constexpr double c_relativeForceTolerance = 1e-5;
+#endif
+
+//! Returns the interaction constants for \p coulombType with the cut-off \c c_cutoff
+interaction_const_t setupInteractionConst(int coulombType)
+{
+    interaction_const_t ic;
+
+    ic.vdwtype      = evdwCUT;
+    ic.vdw_modifier = eintmodPOTSHIFT;
+    ic.rvdw         = c_cutoff;
+
+    ic.eeltype          = coulombType;
+    ic.coulomb_modifier = eintmodPOTSHIFT;
+    ic.rcoulomb         = c_cutoff;
+    ic.epsfac           = ONE_4PI_EPS0;
+
+    // Reaction-field with epsilon_rf=inf
+    ic.k_rf = 0.5 * std::pow(ic.rcoulomb, -3);
+    ic.c_rf = 1 / ic.rcoulomb + ic.k_rf * ic.rcoulomb * ic.rcoulomb;
+
+    if (EEL_PME_EWALD(ic.eeltype))
+    {
+        ic.ewaldcoeff_q       = calc_ewaldcoeff_q(ic.rcoulomb, 1e-5);
+        ic.coulombEwaldTables = std::make_unique<EwaldCorrectionTables>();
+        init_interaction_const_tables(nullptr, &ic);
+    }
+
+    return ic;
+}
+
+//! Returns the forces computed by the non-bonded kernel of \p kernelType for \p system
+std::vector<gmx::RVec> computeKernelForces(const gmx::BenchmarkSystem& system,
+                                           KernelType                  kernelType,
+                                           const interaction_const_t&  ic)
+{
+    gmx_omp_nthreads_set(emntPairsearch, 1);
+    gmx_omp_nthreads_set(emntNonbonded, 1);
+
+    KernelSetup kernelSetup;
+    kernelSetup.kernelType         = kernelType;
+    kernelSetup.ewaldExclusionType = EwaldExclusionType::Analytical;
+
+    const auto     pinPolicy = gmx::PinningPolicy::CannotBePinned;
+    PairlistParams pairlistParams(kernelSetup.kernelType, false, c_cutoff, false);
+    auto           pairlistSets = std::make_unique<PairlistSets>(pairlistParams, false, 0);
+    auto pairSearch = std::make_unique<PairSearch>(epbcXYZ, false, nullptr, nullptr,
+                                                   pairlistParams.pairlistType, false, 1, pinPolicy);
+    auto atomData   = std::make_unique<nbnxn_atomdata_t>(pinPolicy);
+    auto nbv = std::make_unique<nonbonded_verlet_t>(std::move(pairlistSets), std::move(pairSearch),
+                                                    std::move(atomData), kernelSetup, nullptr, nullptr);
+
+    nbnxn_atomdata_init(gmx::MDLogger(), nbv->nbat.get(), kernelSetup.kernelType,
+                        enbnxninitcombruleDETECT, system.numAtomTypes,
+                        system.nonbondedParameters.data(), 1, 1);
+
+    const rvec lowerCorner = { 0, 0, 0 };
+    const rvec upperCorner = { system.box[XX][XX], system.box[YY][YY], system.box[ZZ][ZZ] };
+    const real atomDensity = system.coordinates.size() / det(system.box);
+    nbnxn_put_on_grid(nbv.get(), system.box, 0, lowerCorner, upperCorner, nullptr,
+                      { 0, int(system.coordinates.size()) }, atomDensity, system.atomInfoAllVdw,
+                      system.coordinates, 0, nullptr);
+
+    t_nrnb nrnb = { 0 };
+    nbv->constructPairlist(gmx::InteractionLocality::Local, &system.excls, 0, &nrnb);
+
+    t_mdatoms mdatoms;
+    // We only use (read) the atom type and charge from mdatoms
+    mdatoms.typeA   = const_cast<int*>(system.atomTypes.data());
+    mdatoms.chargeA = const_cast<real*>(system.charges.data());
+    nbv->setAtomProperties(mdatoms, system.atomInfoAllVdw);
+
+    gmx_enerdata_t    enerd(1, 0);
+    gmx::StepWorkload stepWork;
+    stepWork.computeForces = true;
+    nbv->dispatchNonbondedKernel(gmx::InteractionLocality::Local, ic, stepWork, enbvClearFYes,
+                                 system.forceRec, &enerd, &nrnb);
+
+    std::vector<gmx::RVec> forces(system.coordinates.size(), { 0, 0, 0 });
+    nbv->atomdata_add_nbat_f_to_f(gmx::AtomLocality::Local, forces);
+
+    return forces;
+}
+
+/*! \brief Returns the forces for \p system computed in double precision over all atom pairs
+ *
+ * Uses the exact forms of the interactions, as the kernels do, but with
+ * std::erfc for the Ewald real-space term. The atoms of each water
+ * molecule exclude each other. */
+std::vector<gmx::DVec> computeReferenceForces(const gmx::BenchmarkSystem& system,
+                                              const interaction_const_t&  ic)
+{
+    const int    numAtoms      = system.coordinates.size();
+    const int    numAtomTypes  = system.numAtomTypes;
+    const double cutoffSquared = c_cutoff * c_cutoff;
+    const double beta          = ic.ewaldcoeff_q;
+
+    std::vector<gmx::DVec> forces(numAtoms, { 0, 0, 0 });
+    for (int i = 0; i < numAtoms; i++)
+    {
+        for (int j = i + 1; j < numAtoms; j++)
+        {
+            gmx::DVec dx;
+            for (int d = 0; d < DIM; d++)
+            {
+                dx[d] = double(system.coordinates[i][d]) - double(system.coordinates[j][d]);
+                dx[d] -= system.box[d][d] * std::round(dx[d] / system.box[d][d]);
+            }
+            const double rSquared = dx.norm2();
+            if (rSquared >= cutoffSquared)
+            {
+                continue;
+            }
+            const bool   isExcluded     = (i / 3 == j / 3);
+            const double r              = std::sqrt(rSquared);
+            const double rInverse       = 1 / r;
+            const double rInverseSquare = rInverse * rInverse;
+            const double qq = ic.epsfac * double(system.charges[i]) * double(system.charges[j]);
+
+            // The scalar force divided by r
+            double fScalar = 0;
+            if (EEL_PME_EWALD(ic.eeltype))
+            {
+                const double ewaldForce =
+                        std::erfc(beta * r) * rInverse
+                        + M_2_SQRTPI * beta * std::exp(-beta * beta * rSquared);
+                fScalar += qq * (ewaldForce - (isExcluded ? rInverse : 0)) * rInverseSquare;
+            }
+            else
+            {
+                fScalar += qq * ((isExcluded ? 0 : rInverse * rInverseSquare) - 2 * ic.k_rf);
+            }
+            if (!isExcluded)
+            {
+                const int    pairIndex = 2 * (system.atomTypes[i] * numAtomTypes + system.atomTypes[j]);
+                const double c6        = system.nonbondedParameters[pairIndex];
+                const double c12       = system.nonbondedParameters[pairIndex + 1];
+                const double rInverseSix = rInverseSquare * rInverseSquare * rInverseSquare;
+                fScalar += (c12 * rInverseSix - c6) * rInverseSix * rInverseSquare;
+            }
+            for (int d = 0; d < DIM; d++)
+            {
+                forces[i][d] += fScalar * dx[d];
+                forces[j][d] -= fScalar * dx[d];
+            }
+        }
+    }
+
+    return forces;
+}
+
+//! Test fixture for the SIMD kernels, parametrized by the kernel type and the Coulomb type
+class NbnxmKernelTest : public ::testing::TestWithParam<std::tuple<KernelType, int>>
+{
+};
+
+TEST_P(NbnxmKernelTest, ForcesMatchExactReference)
+{
+    const KernelType kernelType  = std::get<0>(GetParam());
+    const int        coulombType = std::get<1>(GetParam());
+
+    const gmx::BenchmarkSystem system(1);
+    const interaction_const_t  ic = setupInteractionConst(coulombType);
+
+    const std::vector<gmx::RVec> forces          = computeKernelForces(system, kernelType, ic);
+    const std::vector<gmx::DVec> referenceForces = computeReferenceForces(system, ic);
+
+    double maxForce = 0;
+    for (const gmx::DVec& force : referenceForces)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            maxForce = std::max(maxForce, std::abs(force[d]));
+        }
+    }
+    const auto tolerance = gmx::test::relativeToleranceAsFloatingPoint(maxForce, c_relativeForceTolerance);
+    for (size_t a = 0; a < forces.size(); a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(referenceForces[a][d], forces[a][d], tolerance)
+                    << "for atom " << a << " component " << d;
+        }
+    }
+}
+
+#if GMX_SIMD
+//! The SIMD kernel types compiled into this build
+const std::vector<KernelType> c_simdKernelTypes = {
+#    ifdef GMX_NBNXN_SIMD_4XN
+    KernelType::Cpu4xN_Simd_4xN,
+#    endif
+#    ifdef GMX_NBNXN_SIMD_2XNN
+    KernelType::Cpu4xN_Simd_2xNN,
+#    endif
+};
+
+INSTANTIATE_TEST_CASE_P(SimdKernels,
+                        NbnxmKernelTest,
+                        ::testing::Combine(::testing::ValuesIn(c_simdKernelTypes),
+                                           ::testing::Values(eelPME, eelRF)));
+#endif
+
+} // namespace
+} // namespace test
+} // namespace Nbnxm
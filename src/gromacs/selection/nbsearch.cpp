@@ -62,10 +62,13 @@
 #include "gromacs/math/functions.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/pbc.h"
+#include "gromacs/simd/simd.h"
 #include "gromacs/topology/block.h"
+#include "gromacs/utility/alignedallocator.h"
 #include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/mutex.h"
 #include "gromacs/utility/stringutil.h"
 
@@ -77,6 +80,25 @@ namespace gmx
 namespace
 {
 
+#if GMX_SIMD_HAVE_REAL
+//! Number of reference positions checked at once in the batched search.
+constexpr int c_cellPadding = GMX_SIMD_REAL_WIDTH;
+#else
+//! Number of reference positions checked at once in the batched search.
+constexpr int c_cellPadding = 1;
+#endif
+
+/*! \brief
+ * Coordinate used for padding the cells in the batched search.
+ *
+ * Far enough from any real position to never be within the cutoff, but small
+ * enough that the squared distances do not overflow.
+ */
+constexpr real c_paddingCoordinate = 1e10;
+
+//! Minimum number of test positions per thread in the batched search.
+constexpr int c_minTestPositionsPerThread = 64;
+
 /*! \brief
  * Computes the bounding box for a set of positions.
  *
@@ -141,6 +163,19 @@ public:
                                const t_pbc*                         pbc,
                                const AnalysisNeighborhoodPositions& positions);
     PairSearchImplPointer getPairSearch();
+    /*! \brief
+     * Finds all pairs for the given test positions.
+     *
+     * \param[in]  positions Test positions, or NULL for a self search.
+     * \param[out] pairs     All pairs within the cutoff.
+     * \param[in]  contents  Data to store for each pair.
+     *
+     * Implements AnalysisNeighborhoodSearch::findAllPairs() and
+     * AnalysisNeighborhoodSearch::findAllSelfPairs().
+     */
+    void findAllPairs(const AnalysisNeighborhoodPositions*   positions,
+                      AnalysisNeighborhoodPairList*          pairs,
+                      AnalysisNeighborhoodPairList::Contents contents) const;
 
     real cutoffSquared() const { return cutoff2_; }
     bool usesGridSearch() const { return bGrid_; }
@@ -205,6 +240,13 @@ private:
      * produces.
      */
     void addToGridCell(const rvec cell, int i);
+    /*! \brief
+     * Stores the reference positions in each grid cell in flat arrays.
+     *
+     * Fills \p cellStart_ and \p cellX_ from the grid cell contents for use
+     * in the batched search.
+     */
+    void initCellCoordinates();
     /*! \brief
      * Initializes a cell pair loop for a dimension.
      *
@@ -317,6 +359,15 @@ private:
     ivec ncelldim_;
     //! Data structure to hold the grid cell contents.
     CellList cells_;
+    /*! \brief
+     * Start of each grid cell in \p cellX_.
+     *
+     * The starts are multiples of the SIMD width, and the last element is
+     * the total size.
+     */
+    std::vector<int> cellStart_;
+    //! Reference positions ordered by grid cell, padded far away to the SIMD width.
+    std::vector<real, AlignedAllocator<real>> cellX_[DIM];
 
     Mutex          createPairSearchMutex_;
     PairSearchList pairSearchList_;
@@ -357,8 +408,20 @@ public:
     void initFoundPair(AnalysisNeighborhoodPair* pair) const;
     //! Advances to the next test position, skipping any remaining pairs.
     void nextTestPosition();
+    //! Returns the number of test positions left in the search.
+    int remainingTestPositionCount() const { return std::max(testPosCount_ - testIndex_, 0); }
+    /*! \brief
+     * Finds all pairs for a block of the remaining test positions.
+     *
+     * \param[in]  block      Index of the block to search.
+     * \param[in]  blockCount Number of blocks the test positions are divided into.
+     * \param[out] pairs      Pairs are appended here.
+     */
+    void findAllPairs(int block, int blockCount, AnalysisNeighborhoodPairList* pairs);
 
 private:
+    //! Checks a reference position found with the grid and adds it to \p pairs if within the cutoff.
+    void addGridPair(int ci, int cai, const rvec shift, AnalysisNeighborhoodPairList* pairs);
     //! Clears the loop indices.
     void reset(int testIndex);
     //! Checks whether a reference positiong should be excluded.
@@ -860,6 +923,91 @@ int AnalysisNeighborhoodSearchImpl::shiftCell(const ivec cell, rvec shift) const
     return getGridCellIndex(shiftedCell);
 }
 
+void AnalysisNeighborhoodSearchImpl::initCellCoordinates()
+{
+    const int cellCount = ssize(cells_);
+    cellStart_.resize(cellCount + 1);
+    int size = 0;
+    for (int ci = 0; ci < cellCount; ++ci)
+    {
+        cellStart_[ci] = size;
+        size += (ssize(cells_[ci]) + c_cellPadding - 1) / c_cellPadding * c_cellPadding;
+    }
+    cellStart_[cellCount] = size;
+    for (int d = 0; d < DIM; ++d)
+    {
+        cellX_[d].assign(size, c_paddingCoordinate);
+    }
+    for (int ci = 0; ci < cellCount; ++ci)
+    {
+        const int start = cellStart_[ci];
+        for (int cai = 0; cai < ssize(cells_[ci]); ++cai)
+        {
+            const int i = cells_[ci][cai];
+            for (int d = 0; d < DIM; ++d)
+            {
+                cellX_[d][start + cai] = xref_[i][d];
+            }
+        }
+    }
+}
+
+void AnalysisNeighborhoodSearchImpl::findAllPairs(const AnalysisNeighborhoodPositions* positions,
+                                                  AnalysisNeighborhoodPairList*        pairs,
+                                                  AnalysisNeighborhoodPairList::Contents contents) const
+{
+    pairs->clear(contents);
+
+    // The search objects are only used to determine the test positions here.
+    AnalysisNeighborhoodPairSearchImpl pairSearch(*this);
+    if (positions != nullptr)
+    {
+        pairSearch.startSearch(*positions);
+    }
+    else
+    {
+        pairSearch.startSelfSearch();
+    }
+    const int threadCount =
+            std::max(1, std::min(gmx_omp_get_max_threads(),
+                                 pairSearch.remainingTestPositionCount() / c_minTestPositionsPerThread));
+    if (threadCount == 1)
+    {
+        pairSearch.findAllPairs(0, 1, pairs);
+        return;
+    }
+
+    // Each thread collects the pairs for a contiguous block of test
+    // positions, such that concatenating the blocks keeps the pair order.
+    std::vector<AnalysisNeighborhoodPairList> threadPairs(threadCount - 1);
+    for (AnalysisNeighborhoodPairList& blockPairs : threadPairs)
+    {
+        blockPairs.clear(contents);
+    }
+#pragma omp parallel for num_threads(threadCount) schedule(static)
+    for (int t = 0; t < threadCount; ++t)
+    {
+        try
+        {
+            AnalysisNeighborhoodPairSearchImpl threadSearch(*this);
+            if (positions != nullptr)
+            {
+                threadSearch.startSearch(*positions);
+            }
+            else
+            {
+                threadSearch.startSelfSearch();
+            }
+            threadSearch.findAllPairs(t, threadCount, t == 0 ? pairs : &threadPairs[t - 1]);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    for (const AnalysisNeighborhoodPairList& blockPairs : threadPairs)
+    {
+        pairs->append(blockPairs);
+    }
+}
+
 void AnalysisNeighborhoodSearchImpl::init(AnalysisNeighborhood::SearchMode     mode,
                                           bool                                 bXY,
                                           const t_blocka*                      excls,
@@ -924,6 +1072,7 @@ void AnalysisNeighborhoodSearchImpl::init(AnalysisNeighborhood::SearchMode     m
             mapPointToGridCell(positions.x_[ii], refcell, xrefAlloc_[i]);
             addToGridCell(refcell, i);
         }
+        initCellCoordinates();
     }
     else if (refIndices_ != nullptr)
     {
@@ -1149,6 +1298,115 @@ bool AnalysisNeighborhoodPairSearchImpl::searchNext(Action action)
     return false;
 }
 
+void AnalysisNeighborhoodPairSearchImpl::addGridPair(int                           ci,
+                                                     int                           cai,
+                                                     const rvec                    shift,
+                                                     AnalysisNeighborhoodPairList* pairs)
+{
+    const int i = search_.cells_[ci][cai];
+    if (selfSearchMode_ && ci == testCellIndex_ && i >= testIndex_)
+    {
+        return;
+    }
+    if (isExcluded(i))
+    {
+        return;
+    }
+    rvec dx;
+    rvec_sub(search_.xref_[i], xtest_, dx);
+    rvec_sub(dx, shift, dx);
+    const real r2 = search_.bXY_ ? dx[XX] * dx[XX] + dx[YY] * dx[YY] : norm2(dx);
+    if (r2 <= search_.cutoff2_)
+    {
+        pairs->addPair(i, testIndex_, r2, dx);
+    }
+}
+
+void AnalysisNeighborhoodPairSearchImpl::findAllPairs(int                           block,
+                                                      int                           blockCount,
+                                                      AnalysisNeighborhoodPairList* pairs)
+{
+    const int first = testIndex_;
+    const int count = remainingTestPositionCount();
+    testPosCount_   = first + static_cast<int>((static_cast<int64_t>(count) * (block + 1)) / blockCount);
+    reset(first + static_cast<int>((static_cast<int64_t>(count) * block) / blockCount));
+
+    if (!search_.bGrid_)
+    {
+        // The simple search needs full PBC handling for each pair, so it
+        // loops as findNextPair() does.
+        auto addPair = [this, pairs](int i, real r2, const rvec dx) {
+            pairs->addPair(i, testIndex_, r2, dx);
+            return false;
+        };
+        (void)searchNext(addPair);
+        return;
+    }
+
+    // Only preselects the candidates; the margin covers rounding differences
+    // from the scalar check in addGridPair(), which is the same as in
+    // searchNext().
+    const real cutoff2Margin = search_.cutoff2_ * (1 + 8 * GMX_REAL_EPS);
+    while (testIndex_ < testPosCount_)
+    {
+        do
+        {
+            rvec      shift;
+            const int ci = search_.shiftCell(currCell_, shift);
+            if (selfSearchMode_ && ci > testCellIndex_)
+            {
+                continue;
+            }
+            const int   cellSize = ssize(search_.cells_[ci]);
+            const int   start    = search_.cellStart_[ci];
+            const real* cellX    = search_.cellX_[XX].data() + start;
+            const real* cellY    = search_.cellX_[YY].data() + start;
+            const real* cellZ    = search_.cellX_[ZZ].data() + start;
+#if GMX_SIMD_HAVE_REAL
+            const SimdReal testX(xtest_[XX]);
+            const SimdReal testY(xtest_[YY]);
+            const SimdReal testZ(xtest_[ZZ]);
+            const SimdReal shiftX(shift[XX]);
+            const SimdReal shiftY(shift[YY]);
+            const SimdReal shiftZ(shift[ZZ]);
+            const SimdReal cutoff2(cutoff2Margin);
+            for (int base = 0; base < cellSize; base += GMX_SIMD_REAL_WIDTH)
+            {
+                const SimdReal dx = load<SimdReal>(cellX + base) - testX - shiftX;
+                const SimdReal dy = load<SimdReal>(cellY + base) - testY - shiftY;
+                SimdReal       r2 = dx * dx + dy * dy;
+                if (!search_.bXY_)
+                {
+                    const SimdReal dz = load<SimdReal>(cellZ + base) - testZ - shiftZ;
+                    r2                = r2 + dz * dz;
+                }
+                if (anyTrue(r2 <= cutoff2))
+                {
+                    const int end = std::min(base + GMX_SIMD_REAL_WIDTH, cellSize);
+                    for (int cai = base; cai < end; ++cai)
+                    {
+                        addGridPair(ci, cai, shift, pairs);
+                    }
+                }
+            }
+#else
+            for (int cai = 0; cai < cellSize; ++cai)
+            {
+                const real dx = cellX[cai] - xtest_[XX] - shift[XX];
+                const real dy = cellY[cai] - xtest_[YY] - shift[YY];
+                const real dz = search_.bXY_ ? 0 : cellZ[cai] - xtest_[ZZ] - shift[ZZ];
+                if (dx * dx + dy * dy + dz * dz <= cutoff2Margin)
+                {
+                    addGridPair(ci, cai, shift, pairs);
+                }
+            }
+#endif
+            exclind_ = 0;
+        } while (search_.nextCell(testcell_, currCell_, cellBound_));
+        nextTestPosition();
+    }
+}
+
 void AnalysisNeighborhoodPairSearchImpl::initFoundPair(AnalysisNeighborhoodPair* pair) const
 {
     if (previ_ < 0)
@@ -1236,6 +1494,42 @@ private:
 
 } // namespace
 
+/********************************************************************
+ * AnalysisNeighborhoodPairList
+ */
+
+void AnalysisNeighborhoodPairList::clear(Contents contents)
+{
+    contents_ = contents;
+    refIndices_.clear();
+    testIndices_.clear();
+    distance2_.clear();
+    dx_.clear();
+}
+
+void AnalysisNeighborhoodPairList::addPair(int refIndex, int testIndex, real distance2, const rvec dx)
+{
+    distance2_.push_back(distance2);
+    if (contents_ == Contents::DistancesOnly)
+    {
+        return;
+    }
+    refIndices_.push_back(refIndex);
+    testIndices_.push_back(testIndex);
+    if (contents_ == Contents::All)
+    {
+        dx_.emplace_back(dx);
+    }
+}
+
+void AnalysisNeighborhoodPairList::append(const AnalysisNeighborhoodPairList& pairs)
+{
+    refIndices_.insert(refIndices_.end(), pairs.refIndices_.begin(), pairs.refIndices_.end());
+    testIndices_.insert(testIndices_.end(), pairs.testIndices_.begin(), pairs.testIndices_.end());
+    distance2_.insert(distance2_.end(), pairs.distance2_.begin(), pairs.distance2_.end());
+    dx_.insert(dx_.end(), pairs.dx_.begin(), pairs.dx_.end());
+}
+
 /********************************************************************
  * AnalysisNeighborhood::Impl
  */
@@ -1400,6 +1694,21 @@ AnalysisNeighborhoodSearch::startPairSearch(const AnalysisNeighborhoodPositions&
     return AnalysisNeighborhoodPairSearch(pairSearch);
 }
 
+void AnalysisNeighborhoodSearch::findAllPairs(const AnalysisNeighborhoodPositions&   positions,
+                                              AnalysisNeighborhoodPairList*          pairs,
+                                              AnalysisNeighborhoodPairList::Contents contents) const
+{
+    GMX_RELEASE_ASSERT(impl_, "Accessing an invalid search object");
+    impl_->findAllPairs(&positions, pairs, contents);
+}
+
+void AnalysisNeighborhoodSearch::findAllSelfPairs(AnalysisNeighborhoodPairList* pairs,
+                                                  AnalysisNeighborhoodPairList::Contents contents) const
+{
+    GMX_RELEASE_ASSERT(impl_, "Accessing an invalid search object");
+    impl_->findAllPairs(nullptr, pairs, contents);
+}
+
 /********************************************************************
  * AnalysisNeighborhoodPairSearch
  */
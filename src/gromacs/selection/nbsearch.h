@@ -398,6 +398,68 @@ private:
     rvec dx_;
 };
 
+/*! \brief
+ * All pairs of positions found in a neighborhood search.
+ *
+ * Filled by AnalysisNeighborhoodSearch::findAllPairs() and
+ * AnalysisNeighborhoodSearch::findAllSelfPairs().  The data for the pairs is
+ * stored in separate flat arrays, with the same semantics as the
+ * corresponding methods in AnalysisNeighborhoodPair.  The same list can be
+ * reused for multiple searches to avoid repeated memory allocation.
+ *
+ * The search can be asked to store only part of the data (see Contents);
+ * the arrays that are not requested are left empty.  This saves memory
+ * bandwidth for analyses such as RDF that only need the distances.
+ *
+ * \inpublicapi
+ * \ingroup module_selection
+ */
+class AnalysisNeighborhoodPairList
+{
+public:
+    //! Data stored for each pair.
+    enum class Contents
+    {
+        //! Indices, distances and distance vectors.
+        All,
+        //! Indices and distances, without distance vectors.
+        IndicesAndDistances,
+        //! Only the distances.
+        DistancesOnly
+    };
+
+    //! Returns the number of pairs.
+    int size() const { return ssize(distance2_); }
+    //! Whether there are no pairs.
+    bool empty() const { return distance2_.empty(); }
+
+    //! Returns the reference position index for each pair.
+    ArrayRef<const int> refIndices() const { return refIndices_; }
+    //! Returns the test position index for each pair.
+    ArrayRef<const int> testIndices() const { return testIndices_; }
+    //! Returns the squared distance for each pair.
+    ArrayRef<const real> distance2() const { return distance2_; }
+    //! Returns the shortest vector from the test to the reference position for each pair.
+    ArrayRef<const RVec> dx() const { return dx_; }
+
+private:
+    //! Removes all pairs, and sets the data stored for subsequent pairs.
+    void clear(Contents contents);
+    //! Adds a pair to the list.
+    void addPair(int refIndex, int testIndex, real distance2, const rvec dx);
+    //! Appends all pairs in \p pairs to the list.
+    void append(const AnalysisNeighborhoodPairList& pairs);
+
+    Contents          contents_ = Contents::All;
+    std::vector<int>  refIndices_;
+    std::vector<int>  testIndices_;
+    std::vector<real> distance2_;
+    std::vector<RVec> dx_;
+
+    friend class internal::AnalysisNeighborhoodSearchImpl;
+    friend class internal::AnalysisNeighborhoodPairSearchImpl;
+};
+
 /*! \brief
  * Initialized neighborhood search with a fixed set of reference positions.
  *
@@ -533,6 +595,40 @@ public:
      */
     AnalysisNeighborhoodPairSearch startPairSearch(const AnalysisNeighborhoodPositions& positions) const;
 
+    /*! \brief
+     * Finds all reference positions within the cutoff from a set of test
+     * positions.
+     *
+     * \param[in]  positions  Set of test positions to use.
+     * \param[out] pairs      All pairs within the cutoff, in the same order
+     *     as startPairSearch() would return them.
+     * \param[in]  contents   Data to store for each pair.
+     * \throws     std::bad_alloc if out of memory.
+     *
+     * The test positions are divided over OpenMP threads, and with grid
+     * searching, the distances to the reference positions in each cell are
+     * checked with SIMD instructions.  For analyses that process all pairs,
+     * this is considerably faster than looping over
+     * AnalysisNeighborhoodPairSearch::findNextPair().
+     */
+    void findAllPairs(const AnalysisNeighborhoodPositions& positions,
+                      AnalysisNeighborhoodPairList*        pairs,
+                      AnalysisNeighborhoodPairList::Contents contents =
+                              AnalysisNeighborhoodPairList::Contents::All) const;
+    /*! \brief
+     * Finds all reference position pairs within the cutoff.
+     *
+     * \param[out] pairs     All pairs within the cutoff, in the same order as
+     *     startSelfPairSearch() would return them.
+     * \param[in]  contents  Data to store for each pair.
+     * \throws     std::bad_alloc if out of memory.
+     *
+     * Works as findAllPairs(), with the semantics of startSelfPairSearch().
+     */
+    void findAllSelfPairs(AnalysisNeighborhoodPairList*          pairs,
+                          AnalysisNeighborhoodPairList::Contents contents =
+                                  AnalysisNeighborhoodPairList::Contents::All) const;
+
 private:
     typedef internal::AnalysisNeighborhoodSearchImpl Impl;
 
@@ -43,6 +43,9 @@
 
 #include "selection.h"
 
+#include <cstring>
+
+#include <algorithm>
 #include <string>
 
 #include "gromacs/selection/nbsearch.h"
@@ -50,6 +53,7 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
 #include "gromacs/utility/textwriter.h"
 
@@ -124,6 +128,21 @@ SelectionData::SelectionData(SelectionTreeElement* elem, const char* selstr) :
 }
 
 
+SelectionData::SelectionData(const SelectionData* source) :
+    name_(source->name_),
+    selectionText_(source->selectionText_),
+    flags_(source->flags_),
+    rootElement_(source->rootElement_),
+    coveredFractionType_(source->coveredFractionType_),
+    coveredFraction_(source->coveredFraction_),
+    averageCoveredFraction_(source->averageCoveredFraction_),
+    bDynamic_(source->bDynamic_),
+    bDynamicCoveredFraction_(source->bDynamicCoveredFraction_)
+{
+    copyFrameState(*source);
+}
+
+
 SelectionData::~SelectionData() {}
 
 
@@ -257,6 +276,61 @@ void SelectionData::restoreOriginalPositions(const gmx_mtop_t* top)
     }
 }
 
+void SelectionData::copyFrameState(const SelectionData& source)
+{
+    const gmx_ana_pos_t& src  = source.rawPositions_;
+    gmx_ana_pos_t&       dest = rawPositions_;
+    const int            n    = src.count();
+
+    // The static part of the mapping determines the maximum size, so
+    // reserving for it makes further frames not need any allocation.
+    gmx_ana_pos_reserve(&dest, std::max(n, src.m.b.nr), src.m.b.nra);
+    if (src.v != nullptr)
+    {
+        gmx_ana_pos_reserve_velocities(&dest);
+    }
+    if (src.f != nullptr)
+    {
+        gmx_ana_pos_reserve_forces(&dest);
+    }
+    std::memcpy(dest.x, src.x, n * sizeof(*dest.x));
+    if (src.v != nullptr)
+    {
+        std::memcpy(dest.v, src.v, n * sizeof(*dest.v));
+    }
+    if (src.f != nullptr)
+    {
+        std::memcpy(dest.f, src.f, n * sizeof(*dest.f));
+    }
+
+    gmx_ana_indexmap_t&       dm = dest.m;
+    const gmx_ana_indexmap_t& sm = src.m;
+    dm.type    = sm.type;
+    dm.bStatic = sm.bStatic;
+    dm.b.nr    = sm.b.nr;
+    dm.b.nra   = sm.b.nra;
+    std::memcpy(dm.orgid, sm.orgid, sm.b.nr * sizeof(*dm.orgid));
+    std::memcpy(dm.b.index, sm.b.index, (sm.b.nr + 1) * sizeof(*dm.b.index));
+    std::memcpy(dm.b.a, sm.b.a, sm.b.nra * sizeof(*dm.b.a));
+    // Unlike gmx_ana_indexmap_copy(), always make a deep copy of the atoms,
+    // since the source may point to memory that changes during evaluation.
+    if (dm.mapb.nalloc_a < sm.mapb.nra)
+    {
+        srenew(dm.mapb.a, sm.mapb.nra);
+        dm.mapb.nalloc_a = sm.mapb.nra;
+    }
+    dm.mapb.nr  = sm.mapb.nr;
+    dm.mapb.nra = sm.mapb.nra;
+    std::memcpy(dm.mapb.a, sm.mapb.a, sm.mapb.nra * sizeof(*dm.mapb.a));
+    std::memcpy(dm.mapb.index, sm.mapb.index, (n + 1) * sizeof(*dm.mapb.index));
+    std::memcpy(dm.refid, sm.refid, n * sizeof(*dm.refid));
+    std::memcpy(dm.mapid, sm.mapid, n * sizeof(*dm.mapid));
+
+    posMass_         = source.posMass_;
+    posCharge_       = source.posCharge_;
+    coveredFraction_ = source.coveredFraction_;
+}
+
 } // namespace internal
 
 /********************************************************************
@@ -58,6 +58,7 @@ struct gmx_mtop_t;
 namespace gmx
 {
 
+class FrameLocalSelections;
 class SelectionOptionStorage;
 class SelectionTreeElement;
 
@@ -94,6 +95,17 @@ public:
      * \throws    std::bad_alloc if out of memory.
      */
     SelectionData(SelectionTreeElement* elem, const char* selstr);
+    /*! \brief
+     * Creates a frame-local copy of another selection.
+     *
+     * \param[in] source Selection to copy.
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * The copy shares the evaluation tree with \p source, and cannot be
+     * evaluated on its own.  Its contents are updated from \p source with
+     * copyFrameState().
+     */
+    explicit SelectionData(const SelectionData* source);
     ~SelectionData();
 
     //! Returns the name for this selection.
@@ -187,6 +199,18 @@ public:
      * Called by SelectionEvaluator::evaluateFinal().
      */
     void restoreOriginalPositions(const gmx_mtop_t* top);
+    /*! \brief
+     * Copies the per-frame state of another selection into this one.
+     *
+     * \param[in] source  Selection to copy the state from.
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * Copies the evaluated positions, the atoms and mapping for them,
+     * masses, charges and the covered fraction, such that this object can
+     * be accessed while \p source is evaluated for another frame.
+     * Called by FrameLocalSelections.
+     */
+    void copyFrameState(const SelectionData& source);
 
 private:
     //! Name of the selection.
@@ -564,6 +588,10 @@ private:
      * Needed to access the data to adjust flags.
      */
     friend class SelectionOptionStorage;
+    /*! \brief
+     * Needed to map selections to their frame-local copies.
+     */
+    friend class FrameLocalSelections;
 };
 
 /*! \brief
@@ -49,6 +49,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gromacs/onlinehelp/helpmanager.h"
@@ -899,4 +900,65 @@ void SelectionCollection::printXvgrInfo(FILE* out) const
     std::fprintf(out, "#\n");
 }
 
+
+/********************************************************************
+ * FrameLocalSelections
+ */
+
+/*! \internal \brief
+ * Private implementation class for FrameLocalSelections.
+ *
+ * \ingroup module_selection
+ */
+class FrameLocalSelections::Impl
+{
+public:
+    //! Pair of a selection in the collection and its local copy.
+    typedef std::pair<internal::SelectionData*, SelectionDataPointer> SelectionCopy;
+
+    //! Creates local copies of selections in \p source.
+    explicit Impl(const SelectionDataList& source)
+    {
+        copies_.reserve(source.size());
+        for (const auto& sel : source)
+        {
+            copies_.emplace_back(sel.get(), std::make_unique<internal::SelectionData>(sel.get()));
+        }
+    }
+
+    //! Selections in the collection and their local copies.
+    std::vector<SelectionCopy> copies_;
+};
+
+FrameLocalSelections::FrameLocalSelections(const SelectionCollection& selections) :
+    impl_(new Impl(selections.impl_->sc_.sel))
+{
+}
+
+
+FrameLocalSelections::~FrameLocalSelections() {}
+
+
+void FrameLocalSelections::copyFrameState()
+{
+    for (const auto& copy : impl_->copies_)
+    {
+        copy.second->copyFrameState(*copy.first);
+    }
+}
+
+
+Selection FrameLocalSelections::localSelection(const Selection& selection) const
+{
+    for (const auto& copy : impl_->copies_)
+    {
+        if (copy.first == selection.sel_)
+        {
+            return Selection(copy.second.get());
+        }
+    }
+    GMX_RELEASE_ASSERT(false, "Local copy requested for an unknown selection");
+    return selection;
+}
+
 } // namespace gmx
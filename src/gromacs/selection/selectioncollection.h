@@ -423,6 +423,65 @@ private:
      * Needed for the evaluator to freely modify the collection.
      */
     friend class SelectionEvaluator;
+    /*! \brief
+     * Needed for accessing the selections in the collection.
+     */
+    friend class FrameLocalSelections;
+};
+
+/*! \libinternal \brief
+ * Frame-local copy of the evaluated selections in a collection.
+ *
+ * This class makes it possible to evaluate the selections in a
+ * SelectionCollection for a frame, copy the results, and continue evaluating
+ * the collection for the next frames while the copy is being used for
+ * analyzing the earlier frame, e.g., in another thread.
+ *
+ * The copy is initialized from the current state of the selections when
+ * the object is constructed, and copyFrameState() updates it after the
+ * collection has been evaluated for a frame.  Selections in the collection
+ * are mapped to their local counterparts with localSelection().
+ *
+ * The collection must have been compiled before this object is created,
+ * and must outlive it.
+ *
+ * \inlibraryapi
+ * \ingroup module_selection
+ */
+class FrameLocalSelections
+{
+public:
+    /*! \brief
+     * Creates local copies of all selections in a collection.
+     *
+     * \param[in] selections  Compiled selection collection to copy.
+     * \throws    std::bad_alloc if out of memory.
+     */
+    explicit FrameLocalSelections(const SelectionCollection& selections);
+    ~FrameLocalSelections();
+
+    /*! \brief
+     * Copies the current state of all selections into the local copies.
+     *
+     * \throws    std::bad_alloc if out of memory.
+     *
+     * Should be called after SelectionCollection::evaluate().
+     */
+    void copyFrameState();
+    /*! \brief
+     * Returns the local copy of a selection.
+     *
+     * \param[in] selection  Selection from the collection passed to the
+     *      constructor.
+     *
+     * Does not throw.
+     */
+    Selection localSelection(const Selection& selection) const;
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
 };
 
 } // namespace gmx
@@ -502,6 +502,72 @@ void checkAllPairsFound(const RefPairList&            refPairs,
     }
 }
 
+/*! \brief
+ * Helper function to check that the batched search finds the same pairs as
+ * the pair search, in the same order.
+ */
+void checkFindAllPairs(const gmx::AnalysisNeighborhoodSearch&    search,
+                       const gmx::AnalysisNeighborhoodPositions& pos,
+                       bool                                      selfPairs)
+{
+    gmx::AnalysisNeighborhoodPairList pairs;
+    if (selfPairs)
+    {
+        search.findAllSelfPairs(&pairs);
+    }
+    else
+    {
+        search.findAllPairs(pos, &pairs);
+    }
+    gmx::AnalysisNeighborhoodPairSearch pairSearch =
+            selfPairs ? search.startSelfPairSearch() : search.startPairSearch(pos);
+    gmx::AnalysisNeighborhoodPair pair;
+    int                           index = 0;
+    while (pairSearch.findNextPair(&pair))
+    {
+        ASSERT_LT(index, pairs.size()) << "Batched search returned fewer pairs";
+        EXPECT_EQ(pair.refIndex(), pairs.refIndices()[index]);
+        EXPECT_EQ(pair.testIndex(), pairs.testIndices()[index]);
+        EXPECT_EQ(pair.distance2(), pairs.distance2()[index]);
+        for (int d = 0; d < DIM; ++d)
+        {
+            EXPECT_EQ(pair.dx()[d], pairs.dx()[index][d]);
+        }
+        ++index;
+    }
+    EXPECT_EQ(index, pairs.size()) << "Batched search returned more pairs";
+
+    // The reduced lists should contain the same data, without the arrays
+    // that were not requested.
+    using Contents = gmx::AnalysisNeighborhoodPairList::Contents;
+    for (Contents contents : { Contents::IndicesAndDistances, Contents::DistancesOnly })
+    {
+        gmx::AnalysisNeighborhoodPairList reducedPairs;
+        if (selfPairs)
+        {
+            search.findAllSelfPairs(&reducedPairs, contents);
+        }
+        else
+        {
+            search.findAllPairs(pos, &reducedPairs, contents);
+        }
+        ASSERT_EQ(pairs.size(), reducedPairs.size());
+        EXPECT_TRUE(reducedPairs.dx().empty());
+        const bool hasIndices = (contents != Contents::DistancesOnly);
+        ASSERT_EQ(hasIndices ? pairs.size() : 0, reducedPairs.refIndices().ssize());
+        ASSERT_EQ(hasIndices ? pairs.size() : 0, reducedPairs.testIndices().ssize());
+        for (int i = 0; i < pairs.size(); ++i)
+        {
+            if (hasIndices)
+            {
+                EXPECT_EQ(pairs.refIndices()[i], reducedPairs.refIndices()[i]);
+                EXPECT_EQ(pairs.testIndices()[i], reducedPairs.testIndices()[i]);
+            }
+            EXPECT_EQ(pairs.distance2()[i], reducedPairs.distance2()[i]);
+        }
+    }
+}
+
 void NeighborhoodSearchTest::testPairSearch(gmx::AnalysisNeighborhoodSearch*  search,
                                             const NeighborhoodSearchTestData& data)
 {
@@ -651,6 +717,8 @@ void NeighborhoodSearchTest::testPairSearchFull(gmx::AnalysisNeighborhoodSearch*
         const int testIndex = entry.first;
         checkAllPairsFound(entry.second, data.refPos_, testIndex, data.testPositions_[testIndex].x);
     }
+
+    checkFindAllPairs(*search, posCopy, selfPairs);
 }
 
 /********************************************************************
@@ -44,8 +44,11 @@
 
 #include "gromacs/selection/selectioncollection.h"
 
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "gromacs/math/vectypes.h"
 #include "gromacs/options/basicoptions.h"
 #include "gromacs/options/ioptionscontainer.h"
 #include "gromacs/selection/indexutil.h"
@@ -433,6 +436,37 @@ TEST_F(SelectionCollectionTest, HandlesForceRequestForCenterOfGeometry)
     EXPECT_TRUE(sel_[0].hasForces());
 }
 
+TEST_F(SelectionCollectionTest, FrameLocalCopiesKeepEvaluatedState)
+{
+    ASSERT_NO_THROW_GMX(sel_ = sc_.parseFromString("y < 2.5"));
+    ASSERT_NO_FATAL_FAILURE(loadTopology("simple.gro"));
+    ASSERT_NO_THROW_GMX(sc_.compile());
+    gmx::FrameLocalSelections localSelections(sc_);
+    const gmx::Selection      localSel = localSelections.localSelection(sel_[0]);
+
+    t_trxframe* frame = topManager_.frame();
+    ASSERT_NO_THROW_GMX(sc_.evaluate(frame, nullptr));
+    const int count = sel_[0].posCount();
+    ASSERT_GT(count, 0);
+    const std::vector<int> atoms(sel_[0].atomIndices().begin(), sel_[0].atomIndices().end());
+    ASSERT_NO_THROW_GMX(localSelections.copyFrameState());
+
+    // Move all atoms out of the selection, such that evaluating it again
+    // would overwrite all the values if the copy was not independent.
+    for (int i = 0; i < frame->natoms; ++i)
+    {
+        frame->x[i][YY] += 5.0;
+    }
+    ASSERT_NO_THROW_GMX(sc_.evaluate(frame, nullptr));
+    EXPECT_EQ(0, sel_[0].posCount());
+    ASSERT_EQ(count, localSel.posCount());
+    for (int i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(atoms[i], localSel.position(i).atomIndices()[0]);
+        EXPECT_LT(localSel.position(i).x()[YY], 2.5);
+    }
+}
+
 TEST_F(SelectionCollectionTest, ParsesSelectionsFromFile)
 {
     ASSERT_NO_THROW_GMX(
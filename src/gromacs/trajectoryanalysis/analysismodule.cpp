@@ -45,10 +45,13 @@
 #include "analysismodule.h"
 
 #include <map>
+#include <memory>
 #include <utility>
 
 #include "gromacs/analysisdata/analysisdata.h"
+#include "gromacs/analysisdata/paralleloptions.h"
 #include "gromacs/selection/selection.h"
+#include "gromacs/selection/selectioncollection.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
 
@@ -111,6 +114,8 @@ public:
     HandleContainer handles_;
     //! Stores thread-local selections.
     const SelectionCollection& selections_;
+    //! Frame-local copies of \a selections_ for parallel analysis (can be NULL).
+    std::unique_ptr<FrameLocalSelections> localSelections_;
 };
 
 TrajectoryAnalysisModuleData::Impl::Impl(TrajectoryAnalysisModule*          module,
@@ -128,6 +133,10 @@ TrajectoryAnalysisModuleData::Impl::Impl(TrajectoryAnalysisModule*          modu
         }
         handles_.insert(std::make_pair(i->second, handle));
     }
+    if (opt.parallelizationFactor() > 1)
+    {
+        localSelections_ = std::make_unique<FrameLocalSelections>(selections);
+    }
 }
 
 bool TrajectoryAnalysisModuleData::Impl::isInitialized(const AnalysisData& data) const
@@ -185,7 +194,10 @@ AnalysisDataHandle TrajectoryAnalysisModuleData::dataHandle(const AnalysisData&
 
 Selection TrajectoryAnalysisModuleData::parallelSelection(const Selection& selection)
 {
-    // TODO: Implement properly.
+    if (impl_->localSelections_ != nullptr)
+    {
+        return impl_->localSelections_->localSelection(selection);
+    }
     return selection;
 }
 
@@ -204,6 +216,15 @@ SelectionList TrajectoryAnalysisModuleData::parallelSelections(const SelectionLi
 }
 
 
+void TrajectoryAnalysisModuleData::copySelectionsForFrame()
+{
+    if (impl_->localSelections_ != nullptr)
+    {
+        impl_->localSelections_->copyFrameState();
+    }
+}
+
+
 /********************************************************************
  * TrajectoryAnalysisModuleDataBasic
  */
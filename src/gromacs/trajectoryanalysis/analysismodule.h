@@ -126,6 +126,8 @@ public:
      * SelectionOption.  The return value is the corresponding selection
      * in the selection collection with which this data object was
      * constructed with.
+     * For parallel analysis, the returned selection is a thread-local
+     * copy that holds the state stored with copySelectionsForFrame().
      *
      * Does not throw.
      */
@@ -140,6 +142,21 @@ public:
      * \see parallelSelection()
      */
     SelectionList parallelSelections(const SelectionList& selections);
+    /*! \brief
+     * Stores the current state of the selections in this thread-local data.
+     *
+     * \throws std::bad_alloc if out of memory.
+     *
+     * For parallel analysis, the runner calls this after the selections
+     * have been evaluated for a frame, before passing this object to
+     * TrajectoryAnalysisModule::analyzeFrame() for that frame.
+     * The selections returned by parallelSelection() then keep the values
+     * for that frame while the global selections are evaluated for later
+     * frames.  For serial analysis, this method does nothing.
+     *
+     * Analysis modules do not need to call this method.
+     */
+    void copySelectionsForFrame();
 
 protected:
     /*! \brief
@@ -128,6 +128,19 @@ public:
          * \see setRmPBC()
          */
         efNoUserRmPBC = 1 << 5,
+        /*! \brief
+         * Declares that the module supports analyzing frames in parallel.
+         *
+         * If this flag is specified, the module guarantees that
+         * TrajectoryAnalysisModule::analyzeFrame() only modifies
+         * data in the TrajectoryAnalysisModuleData object passed to it,
+         * and accesses selections through
+         * TrajectoryAnalysisModuleData::parallelSelection(), such that it
+         * can be called concurrently for different frames.
+         * A command-line option is then provided for the user to set the
+         * number of frames analyzed in parallel.
+         */
+        efFrameParallel = 1 << 6,
     };
 
     //! Initializes default settings.
@@ -44,9 +44,13 @@
 
 #include "cmdlinerunner.h"
 
+#include <exception>
+#include <vector>
+
 #include "gromacs/analysisdata/paralleloptions.h"
 #include "gromacs/commandline/cmdlinemodulemanager.h"
 #include "gromacs/commandline/cmdlineoptionsmodule.h"
+#include "gromacs/math/vectypes.h"
 #include "gromacs/options/ioptionscontainer.h"
 #include "gromacs/options/timeunitmanager.h"
 #include "gromacs/pbcutil/pbc.h"
@@ -68,6 +72,74 @@ namespace gmx
 namespace
 {
 
+/********************************************************************
+ * ParallelFrame
+ */
+
+/*! \brief
+ * Local copy of a frame that is analyzed in parallel with other frames.
+ *
+ * Holds copies of the coordinate arrays of a frame read by
+ * TrajectoryAnalysisRunnerCommon, such that the next frames can be read
+ * while this one is being analyzed, as well as the thread-local module data
+ * used for analyzing it.
+ *
+ * \ingroup module_trajectoryanalysis
+ */
+class ParallelFrame
+{
+public:
+    ParallelFrame() : frame_(), pbc_(), bPBC_(false) {}
+
+    /*! \brief
+     * Copies a frame into this object.
+     *
+     * \param[in] frame  Frame to copy.
+     * \param[in] ePBC   Type of PBC for the frame, or -1 if PBC are not used.
+     */
+    void setFrame(const t_trxframe& frame, int ePBC)
+    {
+        frame_ = frame;
+        copyArray(frame.x, frame.natoms, &x_, &frame_.x);
+        copyArray(frame.v, frame.natoms, &v_, &frame_.v);
+        copyArray(frame.f, frame.natoms, &f_, &frame_.f);
+        bPBC_ = (ePBC >= 0);
+        if (bPBC_)
+        {
+            set_pbc(&pbc_, ePBC, frame_.box);
+        }
+    }
+
+    //! Returns the local frame.
+    t_trxframe* frame() { return &frame_; }
+    //! Returns the PBC for the local frame, or NULL if PBC are not used.
+    t_pbc* pbc() { return bPBC_ ? &pbc_ : nullptr; }
+
+    //! Thread-local module data used for analyzing this frame.
+    TrajectoryAnalysisModuleDataPointer pdata_;
+    //! Exception thrown during the analysis of the frame, if any.
+    std::exception_ptr exception_;
+
+private:
+    //! Copies a coordinate array to \p storage and points \p dest to it.
+    static void copyArray(const rvec* source, int natoms, std::vector<RVec>* storage, rvec** dest)
+    {
+        if (source == nullptr)
+        {
+            return;
+        }
+        storage->assign(source, source + natoms);
+        *dest = as_rvec_array(storage->data());
+    }
+
+    t_trxframe        frame_;
+    std::vector<RVec> x_;
+    std::vector<RVec> v_;
+    std::vector<RVec> f_;
+    t_pbc             pbc_;
+    bool              bPBC_;
+};
+
 /********************************************************************
  * RunnerModule
  */
@@ -86,6 +158,19 @@ public:
     void optionsFinished() override;
     int  run() override;
 
+    /*! \brief
+     * Analyzes all frames, several frames in parallel.
+     *
+     * \param[in] threadCount  Number of frames to analyze concurrently.
+     * \returns   Number of frames analyzed.
+     *
+     * Frames are read and selections are evaluated serially for a batch of
+     * \p threadCount frames, after which the frames in the batch are
+     * analyzed in parallel, each with its own thread-local module data.
+     * The frames are then passed on to the data modules in order.
+     */
+    int analyzeFramesInParallel(int threadCount);
+
     TrajectoryAnalysisModulePointer module_;
     TrajectoryAnalysisSettings      settings_;
     TrajectoryAnalysisRunnerCommon  common_;
@@ -126,33 +211,41 @@ int RunnerModule::run()
     common_.initFrameIndexGroup();
     module_->initAfterFirstFrame(settings_, common_.frame());
 
-    t_pbc  pbc;
-    t_pbc* ppbc = settings_.hasPBC() ? &pbc : nullptr;
-
-    int                                 nframes = 0;
-    AnalysisDataParallelOptions         dataOptions;
-    TrajectoryAnalysisModuleDataPointer pdata(module_->startFrames(dataOptions, selections_));
-    do
+    int       nframes     = 0;
+    const int threadCount = common_.threadCount();
+    if (threadCount > 1)
     {
-        common_.initFrame();
-        t_trxframe& frame = common_.frame();
-        if (ppbc != nullptr)
+        nframes = analyzeFramesInParallel(threadCount);
+    }
+    else
+    {
+        t_pbc  pbc;
+        t_pbc* ppbc = settings_.hasPBC() ? &pbc : nullptr;
+
+        AnalysisDataParallelOptions         dataOptions;
+        TrajectoryAnalysisModuleDataPointer pdata(module_->startFrames(dataOptions, selections_));
+        do
         {
-            set_pbc(ppbc, topology.ePBC(), frame.box);
-        }
+            common_.initFrame();
+            t_trxframe& frame = common_.frame();
+            if (ppbc != nullptr)
+            {
+                set_pbc(ppbc, topology.ePBC(), frame.box);
+            }
 
-        selections_.evaluate(&frame, ppbc);
-        module_->analyzeFrame(nframes, frame, ppbc, pdata.get());
-        module_->finishFrameSerial(nframes);
+            selections_.evaluate(&frame, ppbc);
+            module_->analyzeFrame(nframes, frame, ppbc, pdata.get());
+            module_->finishFrameSerial(nframes);
 
-        ++nframes;
-    } while (common_.readNextFrame());
-    module_->finishFrames(pdata.get());
-    if (pdata.get() != nullptr)
-    {
-        pdata->finish();
+            ++nframes;
+        } while (common_.readNextFrame());
+        module_->finishFrames(pdata.get());
+        if (pdata.get() != nullptr)
+        {
+            pdata->finish();
+        }
+        pdata.reset();
     }
-    pdata.reset();
 
     if (common_.hasTrajectory())
     {
@@ -172,6 +265,75 @@ int RunnerModule::run()
     return 0;
 }
 
+int RunnerModule::analyzeFramesInParallel(int threadCount)
+{
+    const int ePBC = settings_.hasPBC() ? common_.topologyInformation().ePBC() : -1;
+
+    AnalysisDataParallelOptions dataOptions(threadCount);
+    std::vector<ParallelFrame>  frames(threadCount);
+    for (ParallelFrame& frame : frames)
+    {
+        frame.pdata_ = module_->startFrames(dataOptions, selections_);
+    }
+
+    int  nframes = 0;
+    bool bMore   = true;
+    while (bMore)
+    {
+        // Reading the frames and evaluating the selections is serial.
+        int count = 0;
+        while (count < threadCount && bMore)
+        {
+            common_.initFrame();
+            ParallelFrame& frame = frames[count];
+            frame.setFrame(common_.frame(), ePBC);
+            selections_.evaluate(frame.frame(), frame.pbc());
+            if (frame.pdata_ != nullptr)
+            {
+                frame.pdata_->copySelectionsForFrame();
+            }
+            ++count;
+            bMore = common_.readNextFrame();
+        }
+
+#pragma omp parallel for num_threads(count) schedule(static)
+        for (int i = 0; i < count; ++i)
+        {
+            ParallelFrame& frame = frames[i];
+            try
+            {
+                module_->analyzeFrame(nframes + i, *frame.frame(), frame.pbc(), frame.pdata_.get());
+            }
+            catch (...)
+            {
+                frame.exception_ = std::current_exception();
+            }
+        }
+
+        // Pass the frames to the data modules in order.
+        for (int i = 0; i < count; ++i)
+        {
+            if (frames[i].exception_)
+            {
+                std::rethrow_exception(frames[i].exception_);
+            }
+            module_->finishFrameSerial(nframes + i);
+        }
+        nframes += count;
+    }
+
+    for (ParallelFrame& frame : frames)
+    {
+        module_->finishFrames(frame.pdata_.get());
+        if (frame.pdata_ != nullptr)
+        {
+            frame.pdata_->finish();
+        }
+        frame.pdata_.reset();
+    }
+    return nframes;
+}
+
 } // namespace
 
 /********************************************************************
@@ -215,6 +215,7 @@ void PairDistance::initOptions(IOptionsContainer* options, TrajectoryAnalysisSet
     };
 
     settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efFrameParallel);
 
     options->addOption(FileNameOption("o")
                                .filetype(eftPlot)
@@ -424,7 +425,8 @@ void PairDistance::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, Traj
     }
     const std::vector<int>& refCountArray = frameData.refCountArray_;
 
-    AnalysisNeighborhoodSearch nbsearch = nb_.initSearch(pbc, refSel);
+    AnalysisNeighborhoodSearch   nbsearch = nb_.initSearch(pbc, refSel);
+    AnalysisNeighborhoodPairList pairs;
     dh.startFrame(frnr, fr.time);
     for (size_t g = 0; g < sel.size(); ++g)
     {
@@ -434,16 +436,16 @@ void PairDistance::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, Traj
 
         // Accumulate the number of position pairs within the cutoff and the
         // min/max distance for each group pair.
-        AnalysisNeighborhoodPairSearch pairSearch = nbsearch.startPairSearch(sel[g]);
-        AnalysisNeighborhoodPair       pair;
-        while (pairSearch.findNextPair(&pair))
+        nbsearch.findAllPairs(sel[g], &pairs,
+                              AnalysisNeighborhoodPairList::Contents::IndicesAndDistances);
+        for (int p = 0; p < pairs.size(); ++p)
         {
-            const SelectionPosition& refPos   = refSel.position(pair.refIndex());
-            const SelectionPosition& selPos   = sel[g].position(pair.testIndex());
+            const SelectionPosition& refPos   = refSel.position(pairs.refIndices()[p]);
+            const SelectionPosition& selPos   = sel[g].position(pairs.testIndices()[p]);
             const int                refIndex = refPos.mappedId();
             const int                selIndex = selPos.mappedId();
             const int                index    = selIndex * refGroupCount_ + refIndex;
-            const real               r2       = pair.distance2();
+            const real               r2       = pairs.distance2()[p];
             if (distanceType_ == eDistanceType_Min)
             {
                 if (distArray[index] > r2)
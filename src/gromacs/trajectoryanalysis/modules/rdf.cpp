@@ -279,6 +279,7 @@ void Rdf::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings* se
     };
 
     settings->setHelpText(desc);
+    settings->setFlag(TrajectoryAnalysisSettings::efFrameParallel);
 
     options->addOption(FileNameOption("o")
                                .filetype(eftPlot)
@@ -521,7 +522,8 @@ void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAna
     }
 
     dh.startFrame(frnr, fr.time);
-    AnalysisNeighborhoodSearch nbsearch = nb_.initSearch(pbc, refSel);
+    AnalysisNeighborhoodSearch   nbsearch = nb_.initSearch(pbc, refSel);
+    AnalysisNeighborhoodPairList pairs;
     for (size_t g = 0; g < sel.size(); ++g)
     {
         dh.selectDataSet(g);
@@ -565,11 +567,10 @@ void Rdf::analyzeFrame(int frnr, const t_trxframe& fr, t_pbc* pbc, TrajectoryAna
         {
             // Standard neighborhood search over all pairs within the cutoff
             // for the -surf no case.
-            AnalysisNeighborhoodPairSearch pairSearch = nbsearch.startPairSearch(sel[g]);
-            AnalysisNeighborhoodPair       pair;
-            while (pairSearch.findNextPair(&pair))
+            nbsearch.findAllPairs(sel[g], &pairs,
+                                  AnalysisNeighborhoodPairList::Contents::DistancesOnly);
+            for (const real r2 : pairs.distance2())
             {
-                const real r2 = pair.distance2();
                 if (r2 > cut2_)
                 {
                     // TODO: Consider whether the histogramming could be done with
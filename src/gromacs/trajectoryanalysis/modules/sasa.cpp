@@ -524,6 +524,7 @@ void Sasa::initOptions(IOptionsContainer* options, TrajectoryAnalysisSettings* s
 
     // Atom names etc. are required for the VdW radii lookup.
     settings->setFlag(TrajectoryAnalysisSettings::efRequireTop);
+    settings->setFlag(TrajectoryAnalysisSettings::efFrameParallel);
 }
 
 void Sasa::initAnalysis(const TrajectoryAnalysisSettings& settings, const TopologyInformation& top)
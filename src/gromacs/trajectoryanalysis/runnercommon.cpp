@@ -68,6 +68,7 @@
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/programcontext.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/stringutil.h"
@@ -127,6 +128,8 @@ public:
     bool        bStartTimeSet_;
     bool        bEndTimeSet_;
     bool        bDeltaTimeSet_;
+    //! Number of frames to analyze in parallel (0 = use all threads).
+    int threadCount_;
 
     bool bTrajOpen_;
     //! The current frame, or \p NULL if no frame loaded yet.
@@ -146,6 +149,7 @@ TrajectoryAnalysisRunnerCommon::Impl::Impl(TrajectoryAnalysisSettings* settings)
     bStartTimeSet_(false),
     bEndTimeSet_(false),
     bDeltaTimeSet_(false),
+    threadCount_(1),
     bTrajOpen_(false),
     fr(nullptr),
     gpbc_(nullptr),
@@ -385,6 +389,13 @@ void TrajectoryAnalysisRunnerCommon::initOptions(IOptionsContainer* options, Tim
                         .store(&settings.impl_->bPBC)
                         .description("Use periodic boundary conditions for distance calculation"));
     }
+    if (settings.hasFlag(TrajectoryAnalysisSettings::efFrameParallel))
+    {
+        options->addOption(IntegerOption("nt")
+                                   .store(&impl_->threadCount_)
+                                   .description("Number of frames to analyze in parallel "
+                                                "(0 is guess)"));
+    }
 }
 
 
@@ -415,6 +426,19 @@ void TrajectoryAnalysisRunnerCommon::optionsFinished()
     {
         setTimeValue(TDELTA, impl_->deltaTime_);
     }
+
+    if (impl_->threadCount_ < 0)
+    {
+        GMX_THROW(InvalidInputError("Number of threads (-nt) cannot be negative"));
+    }
+    if (impl_->threadCount_ == 0)
+    {
+        impl_->threadCount_ = gmx_omp_get_max_threads();
+    }
+    if (!impl_->settings_.hasFlag(TrajectoryAnalysisSettings::efFrameParallel))
+    {
+        impl_->threadCount_ = 1;
+    }
 }
 
 
@@ -461,6 +485,12 @@ void TrajectoryAnalysisRunnerCommon::initFrame()
 }
 
 
+int TrajectoryAnalysisRunnerCommon::threadCount() const
+{
+    return impl_->hasTrajectory() ? impl_->threadCount_ : 1;
+}
+
+
 bool TrajectoryAnalysisRunnerCommon::hasTrajectory() const
 {
     return impl_->hasTrajectory();
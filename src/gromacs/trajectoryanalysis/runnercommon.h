@@ -118,6 +118,14 @@ public:
      */
     void initFrame();
 
+    /*! \brief
+     * Returns the number of frames to analyze in parallel.
+     *
+     * Always one if the module does not support parallel analysis
+     * (see TrajectoryAnalysisSettings::efFrameParallel), or if there is
+     * no trajectory.
+     */
+    int threadCount() const;
     //! Returns true if input data comes from a trajectory.
     bool hasTrajectory() const;
     //! Returns the topology information object.
@@ -0,0 +1,192 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for mdrun continuations with GMX_BACKGROUND_CHECKPOINT
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <cstdlib>
+
+#include <memory>
+#include <string>
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/trajectory/energyframe.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+#include "testutils/simulationdatabase.h"
+
+#include "energycomparison.h"
+#include "energyreader.h"
+#include "mdruncomparison.h"
+#include "moduletest.h"
+#include "trajectorycomparison.h"
+#include "trajectoryreader.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for mdrun continuations with a background checkpoint writer
+using BackgroundCheckpointTest = MdrunTestFixture;
+
+/*! \brief Run the first part of a simulation writing a checkpoint
+ * every step, then continue it with appending from that checkpoint.
+ *
+ * The energy, trajectory and final checkpoint files from both parts
+ * are written to files whose names start with \c prefix. */
+void runWithContinuation(TestFileManager*   fileManager,
+                         SimulationRunner*  runner,
+                         const std::string& firstPartTprFileName,
+                         const std::string& fullTprFileName,
+                         const std::string& prefix)
+{
+    const std::string checkpointFileName =
+            fileManager->getTemporaryFilePath(prefix + "-firstpart.cpt");
+    runner->logFileName_                     = fileManager->getTemporaryFilePath(prefix + ".log");
+    runner->edrFileName_                     = fileManager->getTemporaryFilePath(prefix + ".edr");
+    runner->fullPrecisionTrajectoryFileName_ = fileManager->getTemporaryFilePath(prefix + ".trr");
+    {
+        runner->tprFileName_ = firstPartTprFileName;
+        CommandLine firstPartCaller;
+        firstPartCaller.append("mdrun");
+        firstPartCaller.addOption("-cpo", checkpointFileName);
+        firstPartCaller.addOption("-cpt", 0);
+        ASSERT_EQ(0, runner->callMdrun(firstPartCaller));
+    }
+    {
+        runner->tprFileName_ = fullTprFileName;
+        CommandLine secondPartCaller;
+        secondPartCaller.append("mdrun");
+        secondPartCaller.append("-append");
+        secondPartCaller.addOption("-cpi", checkpointFileName);
+        secondPartCaller.addOption("-cpo", fileManager->getTemporaryFilePath(prefix + ".cpt"));
+        ASSERT_EQ(0, runner->callMdrun(secondPartCaller));
+    }
+}
+
+TEST_F(BackgroundCheckpointTest, AppendingContinuationMatchesForegroundCheckpointing)
+{
+    const std::string simulationName = "argon12";
+    if (!isNumberOfPpRanksSupported(simulationName, getNumberOfTestMpiRanks()))
+    {
+        return;
+    }
+
+    auto        mdpFieldValues       = prepareMdpFieldValues(simulationName.c_str(), "md", "no", "no");
+    std::string fullTprFileName      = fileManager_.getTemporaryFilePath("full.tpr");
+    std::string firstPartTprFileName = fileManager_.getTemporaryFilePath("firstpart.tpr");
+
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    runner_.tprFileName_ = fullTprFileName;
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    mdpFieldValues["nsteps"] = "8";
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    runner_.tprFileName_ = firstPartTprFileName;
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    runWithContinuation(&fileManager_, &runner_, firstPartTprFileName, fullTprFileName,
+                        "foreground");
+
+    const char* const environmentVariable       = "GMX_BACKGROUND_CHECKPOINT";
+    const char*       environmentVariableBackup = getenv(environmentVariable);
+    std::string       environmentValueBackup =
+            (environmentVariableBackup != nullptr) ? environmentVariableBackup : "";
+    gmxSetenv(environmentVariable, "1", true);
+    runWithContinuation(&fileManager_, &runner_, firstPartTprFileName, fullTprFileName,
+                        "background");
+    if (environmentVariableBackup != nullptr)
+    {
+        gmxSetenv(environmentVariable, environmentValueBackup.c_str(), true);
+    }
+    else
+    {
+        gmxUnsetenv(environmentVariable);
+    }
+
+    // The background writer must not change what was simulated, so
+    // the appended energy files must match frame by frame.
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname, relativeToleranceAsPrecisionDependentUlp(10.0, 4, 4) },
+            { interaction_function[F_EKIN].longname, relativeToleranceAsPrecisionDependentUlp(10.0, 4, 4) },
+            { interaction_function[F_PRES].longname, relativeToleranceAsPrecisionDependentUlp(10.0, 4, 4) },
+    } };
+    EnergyComparison energyComparison(energyTermsToCompare);
+    auto             namesOfEnergiesToMatch = energyComparison.getEnergyNames();
+    FramePairManager<EnergyFrameReader> energyManager(
+            openEnergyFileToReadTerms(fileManager_.getTemporaryFilePath("foreground.edr"),
+                                      namesOfEnergiesToMatch),
+            openEnergyFileToReadTerms(fileManager_.getTemporaryFilePath("background.edr"),
+                                      namesOfEnergiesToMatch));
+    energyManager.compareAllFramePairs<EnergyFrame>(energyComparison);
+
+    // The appended trajectories, the checkpoints the continuations
+    // started from and the final checkpoints must all match.
+    // Checkpoints contain no forces.
+    const TrajectoryTolerances trajectoryTolerances{ ulpTolerance(4), ulpTolerance(4),
+                                                     ulpTolerance(4), ulpTolerance(4) };
+    for (const std::string suffix : { ".trr", "-firstpart.cpt", ".cpt" })
+    {
+        SCOPED_TRACE("Comparing " + suffix + " files");
+        const TrajectoryFrameMatchSettings trajectoryMatchSettings = {
+            true,
+            false,
+            false,
+            ComparisonConditions::MustCompare,
+            ComparisonConditions::MustCompare,
+            suffix == ".trr" ? ComparisonConditions::MustCompare : ComparisonConditions::NoComparison
+        };
+        TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings, trajectoryTolerances };
+        FramePairManager<TrajectoryFrameReader> trajectoryManager(
+                std::make_unique<TrajectoryFrameReader>(
+                        fileManager_.getTemporaryFilePath("foreground" + suffix)),
+                std::make_unique<TrajectoryFrameReader>(
+                        fileManager_.getTemporaryFilePath("background" + suffix)));
+        trajectoryManager.compareAllFramePairs<TrajectoryFrame>(trajectoryComparison);
+    }
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
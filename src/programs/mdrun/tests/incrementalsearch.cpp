@@ -0,0 +1,170 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for mdrun with GMX_NBNXN_INCREMENTAL_SEARCH
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <cstdlib>
+
+#include <memory>
+#include <string>
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/trajectory/energyframe.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+
+#include "energycomparison.h"
+#include "energyreader.h"
+#include "mdruncomparison.h"
+#include "moduletest.h"
+#include "trajectorycomparison.h"
+#include "trajectoryreader.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Test fixture for mdrun with incremental pair search
+using IncrementalSearchTest = MdrunTestFixture;
+
+/* The pairlist buffer of 0.05 nm is far too small for the hot argon
+ * atoms to move in nstlist = 100 steps, so a list that is only rebuilt
+ * every nstlist steps would miss many pairs. With incremental search
+ * the forces should instead be the same as those of a rerun, which
+ * searches every frame. */
+TEST_F(IncrementalSearchTest, ForcesMatchRerunWithLargeDisplacements)
+{
+    if (getNumberOfTestMpiRanks() > 1)
+    {
+        // Incremental search is only used with a single rank
+        return;
+    }
+
+    const std::string mdpContents = R"(integrator              = md
+                                       dt                      = 0.004
+                                       nsteps                  = 30
+                                       cutoff-scheme           = Verlet
+                                       verlet-buffer-tolerance = -1
+                                       nstlist                 = 100
+                                       rlist                   = 0.75
+                                       rvdw                    = 0.7
+                                       coulombtype             = Cut-off
+                                       rcoulomb                = 0.7
+                                       nstcalcenergy           = 1
+                                       nstenergy               = 1
+                                       nstxout                 = 1
+                                       nstfout                 = 1
+                                       gen-vel                 = yes
+                                       gen-temp                = 1000
+                                       gen-seed                = 1993
+                                       tcoupl                  = no
+                                       pcoupl                  = no)";
+
+    auto simulationTrajectoryFileName = fileManager_.getTemporaryFilePath("sim.trr");
+    auto simulationEdrFileName        = fileManager_.getTemporaryFilePath("sim.edr");
+    auto rerunTrajectoryFileName      = fileManager_.getTemporaryFilePath("rerun.trr");
+    auto rerunEdrFileName             = fileManager_.getTemporaryFilePath("rerun.edr");
+
+    runner_.useTopGroAndNdxFromDatabase("argon5832");
+    runner_.useStringAsMdpFile(mdpContents);
+    ASSERT_EQ(0, runner_.callGrompp());
+
+    const char* const environmentVariable       = "GMX_NBNXN_INCREMENTAL_SEARCH";
+    const char*       environmentVariableBackup = getenv(environmentVariable);
+    std::string       environmentValueBackup =
+            (environmentVariableBackup != nullptr) ? environmentVariableBackup : "";
+    {
+        runner_.fullPrecisionTrajectoryFileName_ = simulationTrajectoryFileName;
+        runner_.edrFileName_                     = simulationEdrFileName;
+        gmxSetenv(environmentVariable, "ON", true);
+        ASSERT_EQ(0, runner_.callMdrun());
+    }
+    if (environmentVariableBackup != nullptr)
+    {
+        gmxSetenv(environmentVariable, environmentValueBackup.c_str(), true);
+    }
+    else
+    {
+        gmxUnsetenv(environmentVariable);
+    }
+    {
+        runner_.fullPrecisionTrajectoryFileName_ = rerunTrajectoryFileName;
+        runner_.edrFileName_                     = rerunEdrFileName;
+        CommandLine rerunCaller;
+        rerunCaller.append("mdrun");
+        rerunCaller.addOption("-rerun", simulationTrajectoryFileName);
+        ASSERT_EQ(0, runner_.callMdrun(rerunCaller));
+    }
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname, relativeToleranceAsPrecisionDependentUlp(10.0, 24, 40) },
+    } };
+    EnergyComparison energyComparison(energyTermsToCompare);
+    auto             namesOfEnergiesToMatch = energyComparison.getEnergyNames();
+    FramePairManager<EnergyFrameReader> energyManager(
+            openEnergyFileToReadTerms(simulationEdrFileName, namesOfEnergiesToMatch),
+            openEnergyFileToReadTerms(rerunEdrFileName, namesOfEnergiesToMatch));
+    energyManager.compareAllFramePairs<EnergyFrame>(energyComparison);
+
+    // Compare box, positions and forces, but not velocities
+    // (velocities are ignored in reruns)
+    const TrajectoryFrameMatchSettings trajectoryMatchSettings = {
+        true,
+        true,
+        true,
+        ComparisonConditions::MustCompare,
+        ComparisonConditions::NoComparison,
+        ComparisonConditions::MustCompare
+    };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+    FramePairManager<TrajectoryFrameReader> trajectoryManager(
+            std::make_unique<TrajectoryFrameReader>(simulationTrajectoryFileName),
+            std::make_unique<TrajectoryFrameReader>(rerunTrajectoryFileName));
+    trajectoryManager.compareAllFramePairs<TrajectoryFrame>(trajectoryComparison);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx